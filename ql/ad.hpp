@@ -31,6 +31,24 @@ namespace QuantLib {}
 // Define QL_REAL as double replacement variable
 #define QL_REAL cl::tdouble
 
+// Tags the recording of the enclosing scope, see cl::tape_tag, marks
+// passive scopes, see cl::tape_passive_scope, tells whether a tape is
+// recording, see cl::tape_recording, records the roots of
+// 1-D solvers by the implicit function theorem, see cl::implicit_root,
+// and computes Jacobians and Hessians on a tape of their own, see
+// cl::tape_jacobian and cl::tape_hessian; QL_TAPE_ENABLED marks builds
+// in which these hooks are available
+#if defined CL_TAPE_CPPAD && !defined CL_USE_NATIVE_FORWARD
+#   define QL_TAPE_ENABLED
+#   define QL_TAPE_TAG(name) cl::tape_tag ql_tape_tag_(name)
+#   define QL_TAPE_PASSIVE() cl::tape_passive_scope ql_tape_passive_
+#   define QL_TAPE_RECORDING() cl::tape_recording()
+#   define QL_TAPE_ACTIVE() (cl::tape_recording() && !cl::tape_passive_scope::active())
+#   define QL_TAPE_IMPLICIT_ROOT(root, f, derivative) cl::implicit_root(root, f, derivative)
+#   define QL_TAPE_JACOBIAN(jac, x, f) cl::tape_jacobian(jac, x, f)
+#   define QL_TAPE_HESSIAN(hes, x, f, columns) cl::tape_hessian(hes, x, f, columns)
+#endif
+
 namespace QuantLib
 {
     template <typename > class Null;
@@ -445,6 +445,7 @@ namespace QuantLib {
                         bool includeSettlementDateFlows,
                         Date settlementDate,
                         Date npvDate) {
+        QL_TAPE_TAG("CashFlows::npv");
 
         if (leg.empty())
             return 0.0;
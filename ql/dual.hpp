@@ -0,0 +1,92 @@
+﻿/* -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ Copyright (C) 2015 CompatibL
+
+ This file is part of QuantLib, a free-software/open-source library
+ for financial quantitative analysts and developers - http://quantlib.org/
+
+ QuantLib is free software: you can redistribute it and/or modify it
+ under the terms of the QuantLib license.  You should have received a
+ copy of the license along with this program; if not, please email
+ <quantlib-dev@lists.sf.net>. The license is also available online at
+ <http://quantlib.org/license.shtml>.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef quantlib_dual_hpp
+#define quantlib_dual_hpp
+
+// Number of tangent directions carried by Real is fixed at compile time
+// by CL_DUAL_DIRECTIONS, 4 if it is not defined
+#include <cl/tape/dual.hpp>
+#include <type_traits>
+
+// Define QL_REAL as forward mode dual number, no tape is recorded
+#define QL_REAL cl::dual_double
+
+namespace QuantLib
+{
+    template <typename > class Null;
+
+    // Specialization of Null template to make it work with dual numbers
+    template <typename Scalar, size_t N>
+    class Null<cl::dual<Scalar, N>>
+    {
+    public:
+        Null() {}
+        cl::dual<Scalar, N> operator -() const
+        {
+            return -std::numeric_limits<Scalar>::max();
+        }
+
+        inline operator cl::dual<Scalar, N>() const
+        {
+            return cl::dual<Scalar, N>(std::numeric_limits<Scalar>::max());
+        }
+    };
+
+    namespace detail
+    {
+        // True for a pair of operands where neither is Real but one is a class
+        // converting to it, e.g. InterestRate. The operators of dual are not found
+        // for these by argument dependent lookup and native double ones do not
+        // apply because the conversion from dual to double is explicit.
+        template <typename Left, typename Right>
+        struct is_dual_convertible_pair
+            : std::integral_constant<bool
+                , (std::is_class<Left>::value || std::is_class<Right>::value)
+                    && std::is_convertible<Left, QL_REAL>::value
+                    && std::is_convertible<Right, QL_REAL>::value
+                    && !std::is_same<Left, QL_REAL>::value
+                    && !std::is_same<Right, QL_REAL>::value>
+        {};
+    }
+
+    // Operators for classes convertible to Real, evaluated in Real.
+#define QL_DUAL_CONVERTIBLE_OPERATOR(Op, Result)                                                \
+    template <typename Left, typename Right>                                                    \
+    inline typename std::enable_if<detail::is_dual_convertible_pair<Left, Right>::value, Result>::type \
+    operator Op(Left const& lhs, Right const& rhs)                                              \
+    {                                                                                           \
+        return QL_REAL(lhs) Op QL_REAL(rhs);                                                    \
+    }
+
+    QL_DUAL_CONVERTIBLE_OPERATOR(+, QL_REAL)
+    QL_DUAL_CONVERTIBLE_OPERATOR(-, QL_REAL)
+    QL_DUAL_CONVERTIBLE_OPERATOR(*, QL_REAL)
+    QL_DUAL_CONVERTIBLE_OPERATOR(/, QL_REAL)
+    QL_DUAL_CONVERTIBLE_OPERATOR(==, bool)
+    QL_DUAL_CONVERTIBLE_OPERATOR(!=, bool)
+    QL_DUAL_CONVERTIBLE_OPERATOR(<, bool)
+    QL_DUAL_CONVERTIBLE_OPERATOR(<=, bool)
+    QL_DUAL_CONVERTIBLE_OPERATOR(>, bool)
+    QL_DUAL_CONVERTIBLE_OPERATOR(>=, bool)
+
+#undef QL_DUAL_CONVERTIBLE_OPERATOR
+}
+
+#endif
@@ -55,7 +55,7 @@ namespace QuantLib {
                     std::bind2nd(std::divides<Real>(),
                                  std::sqrt(std::inner_product(
                                      tmpSqrtCorr[i],tmpSqrtCorr[i]+factors_,
-                                     tmpSqrtCorr[i], 0.0))));
+                                     tmpSqrtCorr[i], Real(0.0)))));
             }
         }
 
@@ -130,7 +130,7 @@ namespace QuantLib {
             if (w[i] > threshold) {
                 const Real u = std::inner_product(U.column_begin(i),
                     U.column_end(i),
-                    yBegin, 0.0)/w[i];
+                    yBegin, Real(0.0))/w[i];
 
                 for (Size j=0; j<m; ++j) {
                     a_[j]  +=u*V[j][i];
@@ -145,7 +145,7 @@ namespace QuantLib {
 
         const Real chiSq
             = std::inner_product(residuals_.begin(), residuals_.end(),
-            residuals_.begin(), 0.0);
+            residuals_.begin(), Real(0.0));
         std::transform(err_.begin(), err_.end(), standardErrors_.begin(),
             std::bind1st(std::multiplies<Real>(),
             std::sqrt(chiSq/(n-2))));
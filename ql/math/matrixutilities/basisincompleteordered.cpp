@@ -39,7 +39,7 @@ namespace QuantLib {
         for (Size j=0; j<currentBasis_.size(); ++j) {
             Real innerProd = std::inner_product(newVector_.begin(),
                 newVector_.end(),
-                currentBasis_[j].begin(), 0.0);
+                currentBasis_[j].begin(), Real(0.0));
 
             for (Size k=0; k<euclideanDimension_; ++k)
                 newVector_[k] -=innerProd*currentBasis_[j][k];
@@ -47,7 +47,7 @@ namespace QuantLib {
 
         Real norm = std::sqrt(std::inner_product(newVector_.begin(),
             newVector_.end(),
-            newVector_.begin(), 0.0));
+            newVector_.begin(), Real(0.0)));
 
         if (norm<1e-12) // maybe this should be a tolerance
             return false;
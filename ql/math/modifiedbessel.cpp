@@ -36,13 +36,13 @@ namespace QuantLib {
             std::complex<Real> value() { return std::complex<Real>(0.0,1.0);}
         };
         template <class T> struct Unweighted {
-            T weightSmallX(const T& x) { return 1.0; }
+            T weightSmallX(const T& x) { return T(1.0); }
             T weight1LargeX(const T& x) { return std::exp(x); }
             T weight2LargeX(const T& x) { return std::exp(-x); }
         };
         template <class T> struct ExponentiallyWeighted {
             T weightSmallX(const T& x) { return std::exp(-x); }
-            T weight1LargeX(const T& x) { return 1.0; }
+            T weight1LargeX(const T& x) { return T(1.0); }
             T weight2LargeX(const T& x) { return std::exp(-2.0*x); }
         };
 
@@ -28,12 +28,29 @@
 #include <ql/utilities/null.hpp>
 #include <ql/patterns/curiouslyrecurring.hpp>
 #include <ql/errors.hpp>
+#include <boost/type_traits/integral_constant.hpp>
 #include <iomanip>
 
 namespace QuantLib {
 
     #define MAX_FUNCTION_EVALUATIONS 100
 
+    namespace detail {
+
+        // true if F has the method Real derivative(Real) const
+        template <class F>
+        class HasDerivative {
+            typedef char yes;
+            typedef char (&no)[2];
+            template <class G, Real (G::*)(Real) const> struct check;
+            template <class G> static yes test(check<G, &G::derivative>*);
+            template <class G> static no test(...);
+          public:
+            static const bool value = sizeof(test<F>(0)) == sizeof(yes);
+        };
+
+    }
+
     //! Base class for 1-D solvers
     /*! The implementation of this class uses the so-called
         "Barton-Nackman trick", also known as "the curiously recurring
@@ -57,6 +74,18 @@ namespace QuantLib {
         The implementation of <tt>solveImpl</tt> can safely assume all
         of the above.
 
+        If enabled by setImplicitDifferentiation() and a tape is
+        recording, the iterations are evaluated on plain values and
+        only the function at the root is recorded; the derivatives of
+        the root are given by the implicit function theorem,
+        \f$ dx/dp = -(\partial f/\partial x)^{-1} \partial
+        f/\partial p \f$, with \f$ \partial f/\partial x \f$ taken
+        from <tt>f.derivative</tt> if available or else by central
+        differences, whose relative error of order
+        \f$ \epsilon^{2/3} \f$ carries over to the derivatives of
+        the root. The function is evaluated at the root last, so
+        functors which keep state are left at the root.
+
         \todo
         - clean up the interface so that it is clear whether the
           accuracy is specified for \f$ x \f$ or \f$ f(x) \f$.
@@ -67,7 +96,8 @@ namespace QuantLib {
       public:
         Solver1D()
         : maxEvaluations_(MAX_FUNCTION_EVALUATIONS),
-          lowerBoundEnforced_(false), upperBoundEnforced_(false) {}
+          lowerBoundEnforced_(false), upperBoundEnforced_(false),
+          implicitDifferentiation_(false) {}
         //! \name Modifiers
         //@{
         /*! This method returns the zero of the function \f$ f \f$,
@@ -87,6 +117,15 @@ namespace QuantLib {
                    Real guess,
                    Real step) const {
 
+            if (implicitDifferentiation_ && QL_TAPE_ACTIVE()) {
+                Real root;
+                {
+                    QL_TAPE_PASSIVE();
+                    root = solve(f, accuracy, guess, step);
+                }
+                return QL_TAPE_IMPLICIT_ROOT(root, f, Derivative<F>(*this, f));
+            }
+
             QL_REQUIRE(accuracy>0.0,
                        "accuracy (" << accuracy << ") must be positive");
             // check whether we really want to use epsilon
@@ -167,6 +206,15 @@ namespace QuantLib {
                    Real xMin,
                    Real xMax) const {
 
+            if (implicitDifferentiation_ && QL_TAPE_ACTIVE()) {
+                Real root;
+                {
+                    QL_TAPE_PASSIVE();
+                    root = solve(f, accuracy, guess, xMin, xMax);
+                }
+                return QL_TAPE_IMPLICIT_ROOT(root, f, Derivative<F>(*this, f));
+            }
+
             QL_REQUIRE(accuracy>0.0,
                        "accuracy (" << accuracy << ") must be positive");
             // check whether we really want to use epsilon
@@ -221,15 +269,57 @@ namespace QuantLib {
         void setLowerBound(Real lowerBound);
         //! sets the upper bound for the function domain
         void setUpperBound(Real upperBound);
+        /*! If true and a tape is recording, solve records the
+            function at the root only, with the derivatives of the
+            implicit function theorem. By default every iteration is
+            recorded. The function must not depend on the root through
+            anything but its argument.
+
+            \warning The recorded root is the linearization at the
+                     recorded inputs; the tape gives derivatives at that
+                     point only and cannot be re-evaluated at others.
+        */
+        void setImplicitDifferentiation(bool flag);
         //@}
       protected:
         mutable Real root_, xMin_, xMax_, fxMin_, fxMax_;
         Size maxEvaluations_;
         mutable Size evaluationNumber_;
       private:
+        // derivative of f at x, as used for the implicit root
+        template <class F>
+        class Derivative {
+          public:
+            Derivative(const Solver1D& solver, const F& f)
+            : solver_(solver), f_(f) {}
+            Real operator()(Real x) const {
+                return solver_.derivative_(f_, x,
+                    boost::integral_constant<bool,
+                                             detail::HasDerivative<F>::value>());
+            }
+          private:
+            const Solver1D& solver_;
+            const F& f_;
+        };
+        template <class F>
+        Real derivative_(const F& f, Real x, boost::true_type) const {
+            Real dfx = f.derivative(x);
+            if (dfx != Null<Real>())
+                return dfx;
+            return derivative_(f, x, boost::false_type());
+        }
+        template <class F>
+        Real derivative_(const F& f, Real x, boost::false_type) const {
+            // central differences, one-sided at the enforced bounds
+            Real h = std::pow(QL_EPSILON, 1.0/3.0)
+                   * std::max(std::fabs(x), Real(1.0));
+            Real xLow = enforceBounds_(x - h), xHigh = enforceBounds_(x + h);
+            return (f(xHigh) - f(xLow)) / (xHigh - xLow);
+        }
         Real enforceBounds_(Real x) const;
         Real lowerBound_, upperBound_;
         bool lowerBoundEnforced_, upperBoundEnforced_;
+        bool implicitDifferentiation_;
     };
 
 
@@ -252,6 +342,11 @@ namespace QuantLib {
         upperBoundEnforced_ = true;
     }
 
+    template <class T>
+    inline void Solver1D<T>::setImplicitDifferentiation(bool flag) {
+        implicitDifferentiation_ = flag;
+    }
+
     template <class T>
     inline Real Solver1D<T>::enforceBounds_(Real x) const {
         if (lowerBoundEnforced_ && x < lowerBound_)
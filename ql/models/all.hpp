@@ -1,6 +1,7 @@
 /* This file is automatically generated; do not edit.     */
 /* Add the files to be included into Makefile.am instead. */
 
+#include <ql/models/calibrationadjoint.hpp>
 #include <ql/models/calibrationhelper.hpp>
 #include <ql/models/model.hpp>
 #include <ql/models/parameter.hpp>
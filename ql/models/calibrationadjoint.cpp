@@ -0,0 +1,177 @@
+/* -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ Copyright (C) 2015 CompatibL
+
+ This file is part of QuantLib, a free-software/open-source library
+ for financial quantitative analysts and developers - http://quantlib.org/
+
+ QuantLib is free software: you can redistribute it and/or modify it
+ under the terms of the QuantLib license.  You should have received a
+ copy of the license along with this program; if not, please email
+ <quantlib-dev@lists.sf.net>. The license is also available online at
+ <http://quantlib.org/license.shtml>.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include <ql/models/calibrationadjoint.hpp>
+#include <ql/math/matrixutilities/qrdecomposition.hpp>
+#include <ql/instrument.hpp>
+
+#if defined(QL_TAPE_ENABLED)
+
+using std::vector;
+using boost::shared_ptr;
+
+namespace QuantLib {
+
+    // calibration cost as a function of the free parameters
+    // followed by the volatility quotes
+    class CalibrationAdjoint::Cost {
+      public:
+        Cost(const shared_ptr<CalibratedModel>& model,
+             const vector<shared_ptr<CalibrationHelper> >& helpers,
+             const vector<Real>& weights,
+             const Projection& projection,
+             Size freeParameters)
+        : model_(model), helpers_(helpers), weights_(weights),
+          projection_(projection), freeParameters_(freeParameters) {}
+
+        Real operator()(const Array& x) const {
+            Array params(x.begin(), x.begin() + freeParameters_);
+            model_->setParams(projection_.include(params));
+            Real value = 0.0;
+            for (Size i=0; i<helpers_.size(); i++) {
+                Real error =
+                    helpers_[i]->calibrationError(x[freeParameters_+i]);
+                value += 0.5*weights_[i]*error*error;
+            }
+            return value;
+        }
+
+      private:
+        shared_ptr<CalibratedModel> model_;
+        const vector<shared_ptr<CalibrationHelper> >& helpers_;
+        const vector<Real>& weights_;
+        const Projection& projection_;
+        Size freeParameters_;
+    };
+
+    // NPV of an instrument as a function of the free parameters
+    class CalibrationAdjoint::Value {
+      public:
+        Value(const shared_ptr<CalibratedModel>& model,
+              const Instrument& instrument,
+              const Projection& projection)
+        : model_(model), instrument_(instrument), projection_(projection) {}
+
+        Disposable<Array> operator()(const Array& params) const {
+            model_->setParams(projection_.include(params));
+            Array value(1, instrument_.NPV());
+            return value;
+        }
+
+      private:
+        shared_ptr<CalibratedModel> model_;
+        const Instrument& instrument_;
+        const Projection& projection_;
+    };
+
+    CalibrationAdjoint::CalibrationAdjoint(
+                        const shared_ptr<CalibratedModel>& model,
+                        const vector<shared_ptr<CalibrationHelper> >& helpers,
+                        const vector<Real>& weights,
+                        const vector<bool>& fixParameters)
+    : model_(model), params_(model->params()),
+      fixParameters_(fixParameters.empty()
+                         ? vector<bool>(params_.size(), false)
+                         : fixParameters),
+      projection_(params_, fixParameters_) {
+
+        QL_REQUIRE(!QL_TAPE_RECORDING(),
+                   "calibration sensitivities cannot be computed "
+                   "while a tape is recording");
+        QL_REQUIRE(weights.empty() || weights.size() == helpers.size(),
+                   "mismatch between number of helpers (" <<
+                   helpers.size() << ") and weights(" <<
+                   weights.size() << ")");
+        vector<Real> w =
+            weights.empty() ? vector<Real>(helpers.size(), 1.0) : weights;
+
+        Array free = projection_.project(params_);
+        Size n = free.size(), m = helpers.size();
+        Array x(n + m);
+        std::copy(free.begin(), free.end(), x.begin());
+        for (Size i=0; i<m; i++)
+            x[n+i] = helpers[i]->volatility()->value();
+
+        // columns of the free parameters, by symmetry the rows of the
+        // quotes are the mixed derivatives
+        Matrix hessian(n + m, n);
+        Cost cost(model_, helpers, w, projection_, n);
+        try {
+            QL_TAPE_HESSIAN(hessian, x, cost, n);
+        } catch (...) {
+            model_->setParams(params_);
+            throw;
+        }
+        model_->setParams(params_);
+
+        hessian_ = Matrix(n, n);
+        std::copy(hessian.row_begin(0), hessian.row_begin(n),
+                  hessian_.begin());
+        mixed_ = Matrix(m, n);
+        std::copy(hessian.row_begin(n), hessian.end(), mixed_.begin());
+
+        parameterSensitivities_ = Matrix(params_.size(), m, 0.0);
+        for (Size j=0; j<m; j++) {
+            Array dp = qrSolve(hessian_, -Array(mixed_.row_begin(j),
+                                                mixed_.row_end(j)));
+            for (Size i=0, k=0; i<params_.size(); i++) {
+                if (!fixParameters_[i])
+                    parameterSensitivities_[i][j] = dp[k++];
+            }
+        }
+    }
+
+    Disposable<Array> CalibrationAdjoint::quoteSensitivities(
+                                      const Array& parameterGradient) const {
+        QL_REQUIRE(parameterGradient.size() == params_.size(),
+                   "gradient size (" << parameterGradient.size() <<
+                   ") differs from the number of parameters (" <<
+                   params_.size() << ")");
+        // one solve for the adjoint of the optimality conditions
+        Array lambda = qrSolve(hessian_,
+                               projection_.project(parameterGradient));
+        Array result = -(mixed_ * lambda);
+        return result;
+    }
+
+    Disposable<Array> CalibrationAdjoint::quoteSensitivities(
+                                        const Instrument& instrument) const {
+        QL_REQUIRE(!QL_TAPE_RECORDING(),
+                   "quote sensitivities cannot be computed "
+                   "while a tape is recording");
+        Array free = projection_.project(params_);
+        Matrix gradient(1, free.size());
+        Value value(model_, instrument, projection_);
+        try {
+            QL_TAPE_JACOBIAN(gradient, free, value);
+        } catch (...) {
+            model_->setParams(params_);
+            throw;
+        }
+        model_->setParams(params_);
+
+        Array lambda = qrSolve(hessian_, Array(gradient.row_begin(0),
+                                               gradient.row_end(0)));
+        Array result = -(mixed_ * lambda);
+        return result;
+    }
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+/* -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ Copyright (C) 2015 CompatibL
+
+ This file is part of QuantLib, a free-software/open-source library
+ for financial quantitative analysts and developers - http://quantlib.org/
+
+ QuantLib is free software: you can redistribute it and/or modify it
+ under the terms of the QuantLib license.  You should have received a
+ copy of the license along with this program; if not, please email
+ <quantlib-dev@lists.sf.net>. The license is also available online at
+ <http://quantlib.org/license.shtml>.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+/*! \file calibrationadjoint.hpp
+    \brief Sensitivities of calibrated model parameters to market quotes
+*/
+
+#ifndef quantlib_calibration_adjoint_hpp
+#define quantlib_calibration_adjoint_hpp
+
+#include <ql/models/model.hpp>
+#include <ql/math/optimization/projection.hpp>
+#include <ql/math/matrix.hpp>
+
+#if defined(QL_TAPE_ENABLED)
+
+namespace QuantLib {
+
+    class Instrument;
+
+    //! Sensitivities of calibrated model parameters to market quotes
+    /*! At the calibrated parameters \f$ p \f$ the gradient of the
+        calibration cost
+        \f[
+            C(p, q) = \frac{1}{2} \sum_i w_i e_i(p, q_i)^2
+        \f]
+        with respect to the free parameters vanishes, \f$ e_i \f$ being
+        the calibration error of the i-th helper and \f$ q_i \f$ its
+        volatility quote. By the implicit function theorem the
+        parameters move with the quotes as
+        \f[
+            \frac{\partial p}{\partial q} = - H_{pp}^{-1} H_{pq}
+        \f]
+        where \f$ H \f$ is the Hessian of \f$ C \f$. Its columns for
+        the free parameters are computed on a tape, including the second
+        derivatives of the errors, so that no recalibration is needed.
+
+        The sensitivities of a value depending on the model, e.g. the
+        NPV of an exotic priced with it, follow from its gradient
+        \f$ v \f$ with respect to the parameters with a single linear
+        solve as \f$ - H_{qp} H_{pp}^{-1} v \f$.
+
+        \warning The parameters must be an unconstrained minimum of the
+                 calibration cost, i.e. no free parameter may be at the
+                 boundary of the constraints. No recording may be in
+                 progress on the calling thread.
+
+        The class is only available when Real is recorded on a tape,
+        i.e. when QL_TAPE_ENABLED is defined.
+    */
+    class CalibrationAdjoint {
+      public:
+        /*! The helpers, weights and fixed parameters are those passed to
+            CalibratedModel::calibrate, and the model must have been
+            calibrated to them.
+        */
+        CalibrationAdjoint(
+            const boost::shared_ptr<CalibratedModel>& model,
+            const std::vector<boost::shared_ptr<CalibrationHelper> >& helpers,
+            const std::vector<Real>& weights = std::vector<Real>(),
+            const std::vector<bool>& fixParameters = std::vector<bool>());
+        //! derivatives of the model parameters by the volatility quotes
+        /*! Element (i, j) is the derivative of the i-th model parameter
+            by the quote of the j-th helper; rows of fixed parameters
+            are zero.
+        */
+        const Matrix& parameterSensitivities() const;
+        //! derivatives of a value by the volatility quotes
+        /*! The gradient of the value with respect to all the model
+            parameters is given; the derivatives by the quotes through
+            the calibration are returned.
+        */
+        Disposable<Array> quoteSensitivities(
+                                     const Array& parameterGradient) const;
+        //! derivatives of the NPV of an instrument priced with the model
+        /*! The NPV is recorded on a tape against the free parameters to
+            obtain its gradient, which is then chained as above.
+        */
+        Disposable<Array> quoteSensitivities(
+                                         const Instrument& instrument) const;
+      private:
+        class Cost;
+        class Value;
+        boost::shared_ptr<CalibratedModel> model_;
+        Array params_;
+        std::vector<bool> fixParameters_;
+        Projection projection_;
+        Matrix hessian_, mixed_;
+        Matrix parameterSensitivities_;
+    };
+
+    // inline definitions
+
+    inline const Matrix& CalibrationAdjoint::parameterSensitivities() const {
+        return parameterSensitivities_;
+    }
+
+}
+
+#endif
+
+#endif
@@ -50,14 +50,23 @@ namespace QuantLib {
     }
 
     Real CalibrationHelper::calibrationError() {
+        return calibrationError(marketValue(), volatility_->value());
+    }
+
+    Real CalibrationHelper::calibrationError(Volatility volatility) {
+        return calibrationError(blackPrice(volatility), volatility);
+    }
+
+    Real CalibrationHelper::calibrationError(Real marketValue,
+                                             Volatility volatility) {
         Real error;
         
         switch (calibrationErrorType_) {
           case RelativePriceError:
-            error = std::fabs(marketValue() - modelValue())/marketValue();
+            error = std::fabs(marketValue - modelValue())/marketValue;
             break;
           case PriceError:
-            error = marketValue() - modelValue();
+            error = marketValue - modelValue();
             break;
           case ImpliedVolError: 
             {
@@ -75,7 +84,7 @@ namespace QuantLib {
               else
                   implied = this->impliedVolatility(
                                           modelPrice, 1e-12, 5000, minVol, maxVol);
-              error = implied - volatility_->value();
+              error = implied - volatility;
             }
             break;
           default:
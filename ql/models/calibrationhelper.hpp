@@ -69,6 +69,13 @@ namespace QuantLib {
         //! returns the error resulting from the model valuation
         virtual Real calibrationError();
 
+        //! returns the error of the model valuation at the given volatility
+        /*! The market value is the Black price at the given volatility
+            instead of the quoted one, e.g. to differentiate the error
+            with respect to the quote.
+        */
+        Real calibrationError(Volatility volatility);
+
         virtual void addTimesTo(std::list<Time>& times) const = 0;
 
         //! Black volatility implied by the model
@@ -95,6 +102,7 @@ namespace QuantLib {
 
       private:
         class ImpliedVolatilityHelper;
+        Real calibrationError(Real marketValue, Volatility volatility);
         const CalibrationErrorType calibrationErrorType_;
     };
 
@@ -69,7 +69,7 @@ namespace QuantLib {
             for (Size k=0; k<numberOfRates_; ++k) {
                 Real variance =
                     std::inner_product(A.row_begin(k), A.row_end(k),
-                                       A.row_begin(k), 0.0);
+                                       A.row_begin(k), Real(0.0));
                 fixed[k] = -0.5*variance;
             }
             fixedDrifts_.push_back(fixed);
@@ -127,7 +127,7 @@ namespace QuantLib {
             logSwapRates_[i] += drifts1_[i] + fixedDrift[i];
             logSwapRates_[i] +=
                 std::inner_product(A.row_begin(i), A.row_end(i),
-                                   brownians_.begin(), 0.0);
+                                   brownians_.begin(), Real(0.0));
             swapRates_[i] = std::exp(logSwapRates_[i]) - displacements_[i];
         }
 
@@ -132,7 +132,7 @@ namespace QuantLib {
                 drifts2 -= g_[j]*C[i][j];
             logForwards_[i] += drifts2 + fixedDrift[i];
             logForwards_[i] += std::inner_product( A.row_begin(i), A.row_end(i),
-                                                   brownians_.begin(), 0.0);
+                                                   brownians_.begin(), Real(0.0));
             forwards_[i] = std::exp(logForwards_[i]) - displacements_[i];
 
             blFwd = std::sqrt( marketModel_->initialRates()[i]*forwards_[i] );
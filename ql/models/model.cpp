@@ -42,9 +42,11 @@ namespace QuantLib {
         CalibrationFunction(CalibratedModel* model,
                             const vector<shared_ptr<CalibrationHelper> >& h,
                             const vector<Real>& weights,
-                            const Projection& projection)
+                            const Projection& projection,
+                            bool tapeJacobian = false)
         : model_(model, no_deletion), instruments_(h),
-          weights_(weights), projection_(projection) { }
+          weights_(weights), projection_(projection),
+          tapeJacobian_(tapeJacobian) { }
 
         virtual ~CalibrationFunction() {}
 
@@ -68,13 +70,36 @@ namespace QuantLib {
             return values;
         }
 
+        virtual void jacobian(Matrix& jac, const Array& params) const {
+            #if defined(QL_TAPE_ENABLED)
+            // one recording of the helpers instead of two repricings
+            // per parameter, unless the caller is recording already
+            if (tapeJacobian_ && !QL_TAPE_RECORDING()) {
+                QL_TAPE_JACOBIAN(jac, params, Values(this));
+                return;
+            }
+            #endif
+            CostFunction::jacobian(jac, params);
+        }
+
         virtual Real finiteDifferenceEpsilon() const { return 1e-6; }
 
       private:
+        class Values {
+          public:
+            explicit Values(const CalibrationFunction* f) : f_(f) {}
+            Disposable<Array> operator()(const Array& params) const {
+                return f_->values(params);
+            }
+          private:
+            const CalibrationFunction* f_;
+        };
+
         shared_ptr<CalibratedModel> model_;
         const vector<shared_ptr<CalibrationHelper> >& instruments_;
         vector<Real> weights_;
         const Projection projection_;
+        bool tapeJacobian_;
     };
 
     void CalibratedModel::calibrate(
@@ -83,7 +108,8 @@ namespace QuantLib {
                     const EndCriteria& endCriteria,
                     const Constraint& additionalConstraint,
                     const vector<Real>& weights,
-                    const vector<bool>& fixParameters) {
+                    const vector<bool>& fixParameters,
+                    bool tapeJacobian) {
 
         QL_REQUIRE(weights.empty() || weights.size() == instruments.size(),
                    "mismatch between number of instruments (" <<
@@ -101,7 +127,7 @@ namespace QuantLib {
         Array prms = params();
         vector<bool> all(prms.size(), false);
         Projection proj(prms,fixParameters.size()>0 ? fixParameters : all);
-        CalibrationFunction f(this,instruments,w,proj);
+        CalibrationFunction f(this,instruments,w,proj,tapeJacobian);
         ProjectedConstraint pc(c,proj);
         Problem prob(f, pc, proj.project(prms));
         shortRateEndCriteria_ = method.minimize(prob, endCriteria);
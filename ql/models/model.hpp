@@ -95,6 +95,17 @@ namespace QuantLib {
         //! Calibrate to a set of market instruments (usually caps/swaptions)
         /*! An additional constraint can be passed which must be
             satisfied in addition to the constraints of the model.
+
+            If tapeJacobian is true and Real is recorded on a tape, the
+            Jacobian of the calibration errors with respect to the free
+            parameters is computed exactly by recording the helper values
+            on a tape of their own, instead of by finite differences.
+            It is only used by methods which ask the cost function for
+            it, e.g. LevenbergMarquardt with useCostFunctionsJacobian.
+
+            If a tape is already recording on the calling thread, the
+            Jacobian falls back to finite differences, since a tape of
+            its own cannot be recorded then.
         */
         virtual void calibrate(
                 const std::vector<boost::shared_ptr<CalibrationHelper> >&,
@@ -102,7 +113,8 @@ namespace QuantLib {
                 const EndCriteria& endCriteria,
                 const Constraint& constraint = Constraint(),
                 const std::vector<Real>& weights = std::vector<Real>(),
-                const std::vector<bool>& fixParameters = std::vector<bool>());
+                const std::vector<bool>& fixParameters = std::vector<bool>(),
+                bool tapeJacobian = false);
 
         Real value(const Array& params,
                    const std::vector<boost::shared_ptr<CalibrationHelper> >&);
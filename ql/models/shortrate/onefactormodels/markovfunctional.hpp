@@ -298,12 +298,14 @@ namespace QuantLib {
             OptimizationMethod &method, const EndCriteria &endCriteria,
             const Constraint &constraint = Constraint(),
             const std::vector<Real> &weights = std::vector<Real>(),
-            const std::vector<bool> &fixParameters = std::vector<bool>()) {
+            const std::vector<bool> &fixParameters = std::vector<bool>(),
+            bool tapeJacobian = false) {
 
             CalibratedModel::calibrate(helper, method, endCriteria, constraint,
                                        weights, fixParameters.size() == 0
                                                     ? FixedFirstVolatility()
-                                                    : fixParameters);
+                                                    : fixParameters,
+                                       tapeJacobian);
         }
 
         void update() {
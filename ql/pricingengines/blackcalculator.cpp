@@ -65,6 +65,7 @@ namespace QuantLib {
     }
 
     void BlackCalculator::initialize(const shared_ptr<StrikedTypePayoff>& p) {
+        QL_TAPE_TAG("BlackCalculator");
         QL_REQUIRE(strike_>=0.0,
                    "strike (" << strike_ << ") must be non-negative");
         QL_REQUIRE(forward_>0.0,
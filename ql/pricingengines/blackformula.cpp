@@ -258,7 +258,8 @@ namespace QuantLib {
                        "stdDev (" << stdDev << ") must be non-negative");
             #endif
             Real signedD1 = signedMoneyness_/stdDev + halfOptionType_*stdDev;
-            return signedForward_*N_.derivative(signedD1);
+            // vega is positive for calls and puts alike
+            return std::fabs(signedForward_)*N_.derivative(signedD1);
         }
       private:
         Real halfOptionType_;
@@ -276,7 +277,8 @@ namespace QuantLib {
                                    Real displacement,
                                    Real guess,
                                    Real accuracy,
-                                   Natural maxIterations)
+                                   Natural maxIterations,
+                                   bool implicitDifferentiation)
     {
         checkParameters(strike, forward, displacement);
 
@@ -321,6 +323,7 @@ namespace QuantLib {
                                    blackPrice/discount);
         NewtonSafe solver;
         solver.setMaxEvaluations(maxIterations);
+        solver.setImplicitDifferentiation(implicitDifferentiation);
         Real minSdtDev = 0.0, maxStdDev = 24.0; // 24 = 300% * sqrt(60)
         Real stdDev = solver.solve(f, accuracy, guess, minSdtDev, maxStdDev);
         QL_ENSURE(stdDev>=0.0,
@@ -336,9 +339,11 @@ namespace QuantLib {
                         Real displacement,
                         Real guess,
                         Real accuracy,
-                        Natural maxIterations) {
+                        Natural maxIterations,
+                        bool implicitDifferentiation) {
         return blackFormulaImpliedStdDev(payoff->optionType(), payoff->strike(),
-            forward, blackPrice, discount, displacement, guess, accuracy, maxIterations);
+            forward, blackPrice, discount, displacement, guess, accuracy, maxIterations,
+            implicitDifferentiation);
     }
 
     Real blackFormulaCashItmProbability(Option::Type optionType,
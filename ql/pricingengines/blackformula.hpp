@@ -120,6 +120,12 @@ namespace QuantLib {
 
     /*! Black 1976 implied standard deviation,
         i.e. volatility*sqrt(timeToMaturity)
+
+        If implicitDifferentiation is true and a tape is recording, the
+        iterations of the solver are not recorded and the root gets the
+        derivatives of the implicit function theorem, see
+        Solver1D::setImplicitDifferentiation. By default every iteration
+        is recorded.
     */
     Real blackFormulaImpliedStdDev(Option::Type optionType,
                                    Real strike,
@@ -129,7 +135,8 @@ namespace QuantLib {
                                    Real displacement = 0.0,
                                    Real guess = Null<Real>(),
                                    Real accuracy = 1.0e-6,
-                                   Natural maxIterations = 100);
+                                   Natural maxIterations = 100,
+                                   bool implicitDifferentiation = false);
 
     /*! Black 1976 implied standard deviation,
         i.e. volatility*sqrt(timeToMaturity)
@@ -142,7 +149,8 @@ namespace QuantLib {
                         Real displacement = 0.0,
                         Real guess = Null<Real>(),
                         Real accuracy = 1.0e-6,
-                        Natural maxIterations = 100);
+                        Natural maxIterations = 100,
+                        bool implicitDifferentiation = false);
 
 
     /*! Black 1976 probability of being in the money (in the bond martingale
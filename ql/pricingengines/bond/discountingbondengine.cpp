@@ -32,6 +32,7 @@ namespace QuantLib {
     }
 
     void DiscountingBondEngine::calculate() const {
+        QL_TAPE_TAG("DiscountingBondEngine");
         QL_REQUIRE(!discountCurve_.empty(),
                    "discounting term structure handle is empty");
 
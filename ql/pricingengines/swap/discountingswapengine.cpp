@@ -36,6 +36,7 @@ namespace QuantLib {
     }
 
     void DiscountingSwapEngine::calculate() const {
+        QL_TAPE_TAG("DiscountingSwapEngine");
         QL_REQUIRE(!discountCurve_.empty(),
                    "discounting term structure handle is empty");
 
@@ -31,6 +31,7 @@ namespace QuantLib {
     }
 
     void AnalyticEuropeanEngine::calculate() const {
+        QL_TAPE_TAG("AnalyticEuropeanEngine");
 
         QL_REQUIRE(arguments_.exercise->type() == Exercise::European,
                    "not an European option");
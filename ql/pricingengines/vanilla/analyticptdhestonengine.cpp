@@ -82,8 +82,8 @@ namespace QuantLib {
         // todo: use l'Hospital's rule use to get lim_{phi->0}
         phi = std::max(Real(std::numeric_limits<float>::epsilon()), phi);
         
-        std::complex<Real> D = 0.0;
-        std::complex<Real> C = 0.0;
+        std::complex<Real> D(0.0);
+        std::complex<Real> C(0.0);
 
         for (Size i=timeGrid_.size()-1; i > 0; --i) {
             const Time begin = timeGrid_[i-1];
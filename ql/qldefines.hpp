@@ -74,12 +74,75 @@
 #   ifdef QL_ADJOINT
         // Define Real for use with QuantLibAdjoint
 #       include <ql/ad.hpp>
+#   elif defined QL_DUAL
+        // Define Real as forward mode dual number without a tape
+#       include <ql/dual.hpp>
 #   else
         // Define Real as regular double
 #       define QL_REAL double
 #   endif
 #endif
 
+/* Attributes the operations recorded in the enclosing scope to a name,
+   see cl::tape_tag. Expands to nothing unless Real is recorded on a tape.
+*/
+#ifndef QL_TAPE_TAG
+#   define QL_TAPE_TAG(name)
+#endif
+
+/* Evaluates the Real arithmetic of the enclosing scope on plain values
+   without recording it, see cl::tape_passive_scope. Only for code whose
+   results do not depend on the recorded inputs, e.g. day counters.
+   Expands to nothing unless Real is recorded on a tape; the arithmetic
+   is only evaluated on plain values if CL_TAPE_PASSIVE_ENABLED is defined,
+   see cl/tape/impl/tape_passive.hpp.
+*/
+#ifndef QL_TAPE_PASSIVE
+#   define QL_TAPE_PASSIVE()
+#endif
+
+/* True if a tape is recording on the calling thread, whether or not a
+   passive scope is open, see cl::tape_recording. False unless Real is
+   recorded on a tape.
+*/
+#ifndef QL_TAPE_RECORDING
+#   define QL_TAPE_RECORDING() false
+#endif
+
+/* True if the Real arithmetic of the calling thread is being recorded,
+   i.e. a tape is recording and no passive scope is open.
+*/
+#ifndef QL_TAPE_ACTIVE
+#   define QL_TAPE_ACTIVE() false
+#endif
+
+/* Returns the root of a 1-D solver found on plain values, recorded as a
+   single evaluation of the function at the root with the derivatives of
+   the implicit function theorem, see cl::implicit_root. Returns the root
+   unless Real is recorded on a tape.
+*/
+#ifndef QL_TAPE_IMPLICIT_ROOT
+#   define QL_TAPE_IMPLICIT_ROOT(root, f, derivative) (root)
+#endif
+
+/* Sets jac to the Jacobian of f at x, recorded on a tape of its own,
+   see cl::tape_jacobian. Must not be used while a tape is recording.
+   Expands to nothing unless Real is recorded on a tape, i.e. unless
+   QL_TAPE_ENABLED is defined; callers check that and QL_TAPE_RECORDING()
+   first and fall back to finite differences.
+*/
+#ifndef QL_TAPE_JACOBIAN
+#   define QL_TAPE_JACOBIAN(jac, x, f)
+#endif
+
+/* Sets the first columns of hes to the Hessian of the scalar f at x,
+   recorded on a tape of its own, see cl::tape_hessian. Same usage as
+   QL_TAPE_JACOBIAN.
+*/
+#ifndef QL_TAPE_HESSIAN
+#   define QL_TAPE_HESSIAN(hes, x, f, columns)
+#endif
+
 
 /*! \defgroup macros QuantLib macros
 
@@ -37,12 +37,27 @@
 namespace QuantLib {
 
     //! Universal piecewise-term-structure boostrapper.
+    /*! If true is passed to the constructor and a tape is
+        recording, each pillar is solved on plain values and only the
+        converged node is recorded: one evaluation of its bootstrap
+        error at the node, which depends on the helper quote and on
+        the nodes before it, and the implicit function theorem step
+        of Solver1D. The nodes are thus linked to the quotes through
+        the triangular Jacobian of the errors, and one reverse sweep
+        gives the sensitivities of the curve to all quotes. By
+        default every iteration of the solvers is recorded.
+
+        \warning With implicit differentiation the recorded nodes are
+                 the linearization of the bootstrap at the recorded
+                 quotes, so the tape gives derivatives at that point
+                 only and cannot be re-evaluated at other quotes.
+    */
     template <class Curve>
     class IterativeBootstrap {
         typedef typename Curve::traits_type Traits;
         typedef typename Curve::interpolator_type Interpolator;
       public:
-        IterativeBootstrap();
+        explicit IterativeBootstrap(bool implicitDifferentiation = false);
         void setup(Curve* ts);
         void calculate() const;
       private:
@@ -51,6 +66,7 @@ namespace QuantLib {
         Size n_;
         Brent firstSolver_;
         FiniteDifferenceNewtonSafe solver_;
+        bool implicitDifferentiation_;
         mutable bool initialized_, validCurve_, loopRequired_;
         mutable Size firstAliveHelper_, alive_;
         mutable std::vector<Real> previousData_;
@@ -61,9 +77,14 @@ namespace QuantLib {
     // template definitions
 
     template <class Curve>
-    IterativeBootstrap<Curve>::IterativeBootstrap()
-        : ts_(0), initialized_(false), validCurve_(false), 
-          loopRequired_(Interpolator::global) {}
+    IterativeBootstrap<Curve>::IterativeBootstrap(
+                                              bool implicitDifferentiation)
+        : ts_(0), implicitDifferentiation_(implicitDifferentiation),
+          initialized_(false), validCurve_(false), 
+          loopRequired_(Interpolator::global) {
+        firstSolver_.setImplicitDifferentiation(implicitDifferentiation);
+        solver_.setImplicitDifferentiation(implicitDifferentiation);
+    }
 
     template <class Curve>
     void IterativeBootstrap<Curve>::setup(Curve* ts) {
@@ -189,21 +210,29 @@ namespace QuantLib {
 
             for (Size i=1; i<=alive_; ++i) { // pillar loop
 
-                // bracket root and calculate guess
-                Real min = Traits::minValueAfter(i, ts_, validData,
+                Real min, max, guess;
+                {
+                    // the bracket and the guess do not affect the root
+                    QL_TAPE_PASSIVE();
+
+                    // bracket root and calculate guess
+                    min = Traits::minValueAfter(i, ts_, validData,
                                                             firstAliveHelper_);
-                Real max = Traits::maxValueAfter(i, ts_, validData,
+                    max = Traits::maxValueAfter(i, ts_, validData,
                                                             firstAliveHelper_);
-                Real guess = Traits::guess(i, ts_, validData,
+                    guess = Traits::guess(i, ts_, validData,
                                                             firstAliveHelper_);
-                // adjust guess if needed
-                if (guess>=max)
-                    guess = max - (max-min)/5.0;
-                else if (guess<=min)
-                    guess = min + (max-min)/5.0;
+                    // adjust guess if needed
+                    if (guess>=max)
+                        guess = max - (max-min)/5.0;
+                    else if (guess<=min)
+                        guess = min + (max-min)/5.0;
+                }
 
                 // extend interpolation if needed
                 if (!validData) {
+                    // the errors update the interpolation when evaluated
+                    QL_TAPE_PASSIVE();
                     try { // extend interpolation a point at a time
                           // including the pillar to be boostrapped
                         ts_->interpolation_ = ts_->interpolator_.interpolate(
@@ -221,10 +250,17 @@ namespace QuantLib {
                 }
 
                 try {
+                    Real root;
                     if (validData)
-                        solver_.solve(*errors_[i], accuracy, guess, min, max);
+                        root = solver_.solve(*errors_[i], accuracy,
+                                             guess, min, max);
                     else
-                        firstSolver_.solve(*errors_[i], accuracy,guess,min,max);
+                        root = firstSolver_.solve(*errors_[i], accuracy,
+                                                  guess, min, max);
+                    // the errors leave the node at the last value tried,
+                    // the root returned by the solver carries the derivatives
+                    if (implicitDifferentiation_ && QL_TAPE_ACTIVE())
+                        Traits::updateGuess(ts_->data_, root, i);
                 } catch (std::exception &e) {
                     // the previous curve state could have been a bad guess
                     // let's restart without using it
@@ -245,9 +281,14 @@ namespace QuantLib {
                  break;
 
             // exit condition
-            Real change = std::fabs(data[1]-previousData_[1]);
-            for (Size i=2; i<=alive_; ++i)
-                change = std::max(change, std::fabs(data[i]-previousData_[i]));
+            Real change;
+            {
+                QL_TAPE_PASSIVE();
+                change = std::fabs(data[1]-previousData_[1]);
+                for (Size i=2; i<=alive_; ++i)
+                    change = std::max(change,
+                                      std::fabs(data[i]-previousData_[i]));
+            }
             if (change<=accuracy)  // convergence reached
                 break;
 
@@ -258,6 +299,9 @@ namespace QuantLib {
 
             validData = true;
         }
+        // the interpolation of the nodes set from the roots
+        if (implicitDifferentiation_ && QL_TAPE_ACTIVE())
+            ts_->interpolation_.update();
         validCurve_ = true;
     }
 
@@ -569,6 +569,7 @@ namespace QuantLib {
     }
 
     Time Date::fractionOfDay() const {
+        QL_TAPE_PASSIVE();
         const time_duration t = dateTime().time_of_day();
 
         const Time seconds
@@ -579,6 +580,7 @@ namespace QuantLib {
     }
 
     Time Date::fractionOfSecond() const {
+        QL_TAPE_PASSIVE();
         return dateTime_.time_of_day().fractional_seconds()
             /Real(ticksPerSecond());
     }
@@ -125,6 +125,7 @@ namespace QuantLib {
 
     inline Time DayCounter::yearFraction(const Date& d1, const Date& d2,
         const Date& refPeriodStart, const Date& refPeriodEnd) const {
+            QL_TAPE_PASSIVE();
             QL_REQUIRE(impl_, "no implementation provided");
             return impl_->yearFraction(d1,d2,refPeriodStart,refPeriodEnd);
     }
@@ -111,6 +111,8 @@ namespace QuantLib {
       firstDate_(first==effectiveDate ? Date() : first),
       nextToLastDate_(nextToLast==terminationDate ? Date() : nextToLast)
     {
+        QL_TAPE_PASSIVE();
+
         // sanity checks
         QL_REQUIRE(terminationDate != Date(), "null termination date");
 
@@ -0,0 +1,29 @@
+﻿/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_dual_hpp
+#define cl_tape_dual_hpp
+
+// Forward mode dual numbers, independent of the tape backends
+#include <cl/tape/impl/dual/dual.hpp>
+#include <cl/tape/impl/dual/dualmath.hpp>
+#include <cl/tape/impl/dual/duallimits.hpp>
+
+#endif // cl_tape_dual_hpp
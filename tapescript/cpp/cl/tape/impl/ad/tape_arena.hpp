@@ -0,0 +1,267 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_arena_hpp
+#define cl_tape_impl_ad_tape_arena_hpp
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include <cppad/thread_alloc.hpp>
+
+namespace cl
+{
+    /// <summary>Sizes of the buffers which make up a recorded operation sequence.</summary>
+    struct tape_capacity
+    {
+        tape_capacity()
+            : num_op_(0)
+            , num_op_arg_(0)
+            , num_par_(0)
+            , num_text_(0)
+            , num_vec_ind_(0)
+            , num_var_(0)
+        {}
+
+        tape_capacity(size_t num_op, size_t num_op_arg, size_t num_par, size_t num_var)
+            : num_op_(num_op)
+            , num_op_arg_(num_op_arg)
+            , num_par_(num_par)
+            , num_text_(0)
+            , num_vec_ind_(0)
+            , num_var_(num_var)
+        {}
+
+        /// <summary>Returns true if every buffer of other fits into this capacity.</summary>
+        bool covers(tape_capacity const& other) const
+        {
+            return num_op_ >= other.num_op_
+                && num_op_arg_ >= other.num_op_arg_
+                && num_par_ >= other.num_par_
+                && num_text_ >= other.num_text_
+                && num_vec_ind_ >= other.num_vec_ind_
+                && num_var_ >= other.num_var_;
+        }
+
+        /// <summary>Element-wise maximum.</summary>
+        void merge(tape_capacity const& other)
+        {
+            num_op_ = std::max(num_op_, other.num_op_);
+            num_op_arg_ = std::max(num_op_arg_, other.num_op_arg_);
+            num_par_ = std::max(num_par_, other.num_par_);
+            num_text_ = std::max(num_text_, other.num_text_);
+            num_vec_ind_ = std::max(num_vec_ind_, other.num_vec_ind_);
+            num_var_ = std::max(num_var_, other.num_var_);
+        }
+
+        // Number of operators.
+        size_t num_op_;
+        // Number of operator arguments.
+        size_t num_op_arg_;
+        // Number of parameters.
+        size_t num_par_;
+        // Number of characters in the text buffer (PriOp).
+        size_t num_text_;
+        // Number of VecAD indices.
+        size_t num_vec_ind_;
+        // Number of variables, i.e. rows of the Taylor and Partial matrices.
+        size_t num_var_;
+    };
+
+    /// <summary>Returns the sizes of the operation sequence stored in f.</summary>
+    template <class Base>
+    inline tape_capacity tape_size(tape_function_base<Base> const& f)
+    {
+        tape_capacity result;
+        result.num_op_ = f.play_.num_op_rec();
+        result.num_op_arg_ = f.play_.num_op_arg_rec();
+        result.num_par_ = f.play_.num_par_rec();
+        result.num_text_ = f.play_.num_text_rec();
+        result.num_vec_ind_ = f.play_.num_vec_ind_rec();
+        result.num_var_ = f.play_.num_var_rec();
+        return result;
+    }
+
+    /// <summary>Arena for repeated recordings of the same calculation.
+    /// CppAD takes every tape buffer (recorder, player, Taylor and Partial
+    /// matrices) from thread_alloc. While an arena is alive the memory released
+    /// by the previous recording is held by the recording thread and given back
+    /// to the next recording instead of going through the system allocator.
+    /// The arena is bound to the thread which records with it.</summary>
+    template <class Base>
+    class tape_arena
+    {
+    public:
+        tape_arena()
+            : reserved_()
+            , high_water_()
+            , memory_high_water_(0)
+            , recordings_(0)
+        {
+            hold();
+        }
+
+        /// <summary>Creates the arena with blocks already reserved for a recording of the given size.</summary>
+        explicit tape_arena(tape_capacity const& hint)
+            : reserved_()
+            , high_water_()
+            , memory_high_water_(0)
+            , recordings_(0)
+        {
+            hold();
+            reserve(hint);
+        }
+
+        ~tape_arena()
+        {
+            release();
+            if (--hold_count() == 0)
+            {
+                CppAD::thread_alloc::hold_memory(false);
+            }
+        }
+
+        /// <summary>Makes sure that a recording of the given size and its first order
+        /// sweeps are served by held blocks. Cheap if the capacity is already reserved.</summary>
+        void reserve(tape_capacity const& hint)
+        {
+            if (reserved_.covers(hint))
+            {
+                return;
+            }
+
+            tape_capacity capacity = reserved_;
+            capacity.merge(hint);
+
+            // Buffers grow one element at a time, so every block size
+            // up to the final capacity is requested on the way.
+            std::vector<void*> blocks;
+            take_ladder(capacity.num_op_ * sizeof(CPPAD_OP_CODE_TYPE), blocks);
+            take_ladder(capacity.num_op_arg_ * sizeof(CppAD::addr_t), blocks);
+            take_ladder(capacity.num_par_ * sizeof(Base), blocks);
+            take_ladder(capacity.num_text_ * sizeof(char), blocks);
+            take_ladder(capacity.num_vec_ind_ * sizeof(CppAD::addr_t), blocks);
+
+            // cskip_op_ flags of the function.
+            take_ladder(capacity.num_op_ * sizeof(bool), blocks);
+
+            // Taylor matrix for zero and first order, Partial matrix for first order.
+            take_ladder(2 * capacity.num_var_ * sizeof(Base), blocks);
+            take_ladder(capacity.num_var_ * sizeof(Base), blocks);
+
+            // Blocks returned while hold_memory is on stay with this thread.
+            for (void* block : blocks)
+            {
+                CppAD::thread_alloc::return_memory(block);
+            }
+
+            reserved_ = capacity;
+        }
+
+        /// <summary>Updates high-water marks from the recording just stored in f
+        /// and reserves for the next recording of the same size.</summary>
+        void update(tape_function_base<Base> const& f)
+        {
+            ++recordings_;
+            high_water_.merge(tape_size(f));
+            memory_high_water_ = std::max(memory_high_water_
+                , CppAD::thread_alloc::inuse(CppAD::thread_alloc::thread_num()));
+            reserve(high_water_);
+        }
+
+        /// <summary>Returns the memory held by the recording thread to the system.
+        /// High-water marks are kept, the next update reserves them again.</summary>
+        void release()
+        {
+            CppAD::thread_alloc::free_available(CppAD::thread_alloc::thread_num());
+            reserved_ = tape_capacity();
+        }
+
+        /// <summary>Largest buffer sizes seen over all recordings.</summary>
+        tape_capacity const& high_water() const
+        {
+            return high_water_;
+        }
+
+        /// <summary>Capacity currently reserved by the arena.</summary>
+        tape_capacity const& reserved() const
+        {
+            return reserved_;
+        }
+
+        /// <summary>Largest number of bytes in use by the recording thread
+        /// observed at the end of a recording.</summary>
+        size_t memory_high_water() const
+        {
+            return memory_high_water_;
+        }
+
+        /// <summary>Bytes held by the recording thread for reuse.</summary>
+        size_t memory_available() const
+        {
+            return CppAD::thread_alloc::available(CppAD::thread_alloc::thread_num());
+        }
+
+        /// <summary>Number of recordings stored with this arena.</summary>
+        size_t recordings() const
+        {
+            return recordings_;
+        }
+
+    private:
+        tape_arena(tape_arena const&);
+        tape_arena& operator=(tape_arena const&);
+
+        // Number of alive arenas, hold_memory is switched off with the last one.
+        static std::atomic<size_t>& hold_count()
+        {
+            static std::atomic<size_t> count(0);
+            return count;
+        }
+
+        static void hold()
+        {
+            if (hold_count()++ == 0)
+            {
+                CppAD::thread_alloc::hold_memory(true);
+            }
+        }
+
+        // Takes one block of each thread_alloc capacity up to bytes.
+        static void take_ladder(size_t bytes, std::vector<void*>& blocks)
+        {
+            size_t min_bytes = 1;
+            size_t cap_bytes = 0;
+            while (cap_bytes < bytes)
+            {
+                blocks.push_back(CppAD::thread_alloc::get_memory(min_bytes, cap_bytes));
+                min_bytes = cap_bytes + 1;
+            }
+        }
+
+        tape_capacity reserved_;
+        tape_capacity high_water_;
+        size_t memory_high_water_;
+        size_t recordings_;
+    };
+}
+
+#endif // cl_tape_impl_ad_tape_arena_hpp
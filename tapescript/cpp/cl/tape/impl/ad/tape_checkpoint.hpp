@@ -0,0 +1,221 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file includes code from CppAD, a C++ algorithmic differentiation library
+distributed under multiple licenses. This distribution is under the terms of
+the Eclipse Public License Version 1.0, a copy of which is available at:
+
+https://www.eclipse.org/legal/epl-v10.html
+
+CppAD code included in this file is subject to copyright:
+
+Copyright (C) 2003-15 Bradley M. Bell
+*/
+
+#ifndef cl_tape_impl_ad_tape_checkpoint_hpp
+#define cl_tape_impl_ad_tape_checkpoint_hpp
+
+#include <set>
+#include <vector>
+
+#include <cl/tape/impl/double.hpp>
+
+namespace cl
+{
+    /// <summary>Checkpointed region of a recorded calculation.
+    /// The region y = f(x) is recorded once to its own tape and enters
+    /// a recording as a single atomic operation, so the caller tape holds
+    /// the region inputs and results only. Forward sweeps evaluate the region
+    /// tape, the reverse sweep recomputes its Taylor coefficients from the
+    /// stored inputs and then propagates the adjoints through it. This bounds
+    /// the memory of long calculations, e.g. a time step of a path or
+    /// of a finite difference scheme applied many times.
+    ///
+    /// The region is recorded in the constructor, which cannot be called
+    /// while a tape is recording. As for any recording, the operation sequence
+    /// must not depend on the values of x. The checkpoint must outlive every
+    /// function recorded with it.</summary>
+    template <class Base>
+    class tape_checkpoint : public CppAD::atomic_base<Base>
+    {
+    public:
+        typedef CppAD::AD<Base> ad_type;
+        typedef std::vector<cl::tape_wrapper<Base>> tape_vector;
+
+        template <class T> using vector = CppAD::vector<T>;
+
+        /// <summary>Records the region algo(x, y) at the point x.
+        /// The algorithm has the signature void(tape_vector const& x, tape_vector& y)
+        /// and sets the size of y.</summary>
+        template <class Algo>
+        tape_checkpoint(const char* name, Algo algo, std::vector<Base> const& x)
+            : CppAD::atomic_base<Base>(name)
+            , f_()
+            , depend_()
+        {
+            std::vector<ad_type> ax(x.begin(), x.end());
+            CppAD::Independent(ax);
+
+            tape_vector tx(ax.begin(), ax.end());
+            tape_vector ty;
+            algo(tx, ty);
+
+            std::vector<ad_type> ay(ty.size());
+            for (size_t i = 0; i < ay.size(); i++)
+            {
+                ay[i] = cl::tapescript::cvalue(ty[i]);
+            }
+            f_.Dependent(ax, ay);
+
+            // The results which depend on each argument, used to decide
+            // which results of a call are variables.
+            size_t n = f_.Domain();
+            vector<std::set<size_t>> r(n);
+            for (size_t j = 0; j < n; j++)
+            {
+                r[j].insert(j);
+            }
+            vector<std::set<size_t>> s = f_.ForSparseJac(n, r);
+            f_.size_forward_set(0);
+
+            depend_.resize(n);
+            for (size_t i = 0; i < s.size(); i++)
+            {
+                for (size_t j : s[i])
+                {
+                    depend_[j].push_back(i);
+                }
+            }
+        }
+
+        /// <summary>Applies the region to x. While a tape is recording,
+        /// the call is recorded as a single operation.</summary>
+        void operator()(tape_vector const& x, tape_vector& y)
+        {
+            std::vector<ad_type> ax(x.size());
+            for (size_t j = 0; j < ax.size(); j++)
+            {
+                ax[j] = cl::tapescript::cvalue(x[j]);
+            }
+
+            std::vector<ad_type> ay(f_.Range());
+            CppAD::atomic_base<Base>::operator()(ax, ay);
+
+            y.assign(ay.begin(), ay.end());
+        }
+
+        /// <summary>Number of arguments of the region.</summary>
+        size_t domain() const
+        {
+            return f_.Domain();
+        }
+
+        /// <summary>Number of results of the region.</summary>
+        size_t range() const
+        {
+            return f_.Range();
+        }
+
+        /// <summary>Number of variables on the region tape, every call
+        /// would add this many variables to a tape without the checkpoint.</summary>
+        size_t size_var() const
+        {
+            return f_.size_var();
+        }
+
+    private:
+        tape_checkpoint(tape_checkpoint const&);
+        tape_checkpoint& operator=(tape_checkpoint const&);
+
+        virtual bool forward(
+            size_t                    p,
+            size_t                    q,
+            const vector<bool>&      vx,
+                  vector<bool>&      vy,
+            const vector<Base>&      tx,
+                  vector<Base>&      ty)
+        {
+            if (vx.size() > 0)
+            {
+                for (size_t i = 0; i < vy.size(); i++)
+                {
+                    vy[i] = false;
+                }
+                for (size_t j = 0; j < vx.size(); j++)
+                {
+                    if (vx[j])
+                    {
+                        for (size_t i : depend_[j])
+                        {
+                            vy[i] = true;
+                        }
+                    }
+                }
+            }
+
+            ty = f_.Forward(q, tx);
+
+            // The region coefficients are recomputed by every call.
+            f_.capacity_order(0, 0);
+            return true;
+        }
+
+        virtual bool reverse(
+            size_t                    q,
+            const vector<Base>&       tx,
+            const vector<Base>&       ty,
+                  vector<Base>&       px,
+            const vector<Base>&       py)
+        {
+            // Recompute the region coefficients at the stored arguments.
+            f_.Forward(q, tx);
+            px = f_.Reverse(q + 1, py);
+
+            f_.capacity_order(0, 0);
+            return true;
+        }
+
+        virtual bool for_sparse_jac(
+            size_t                                  q,
+            const vector<std::set<size_t>>&         r,
+                  vector<std::set<size_t>>&         s)
+        {
+            s = f_.ForSparseJac(q, r);
+            f_.size_forward_set(0);
+            return true;
+        }
+
+        virtual bool rev_sparse_jac(
+            size_t                                  q,
+            const vector<std::set<size_t>>&         rt,
+                  vector<std::set<size_t>>&         st)
+        {
+            bool transpose = true;
+            st = f_.RevSparseJac(q, rt, transpose);
+            return true;
+        }
+
+        CppAD::ADFun<Base> f_;
+
+        // Indices of the results which depend on each argument.
+        std::vector<std::vector<size_t>> depend_;
+    };
+}
+
+#endif // cl_tape_impl_ad_tape_checkpoint_hpp
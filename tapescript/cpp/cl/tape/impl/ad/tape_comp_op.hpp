@@ -0,0 +1,80 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file includes code from CppAD, a C++ algorithmic differentiation library
+distributed under multiple licenses. This distribution is under the terms of
+the Eclipse Public License Version 1.0, a copy of which is available at:
+
+https://www.eclipse.org/legal/epl-v10.html
+
+CppAD code included in this file is subject to copyright:
+
+Copyright (C) 2003-15 Bradley M. Bell
+*/
+
+#ifndef cl_tape_impl_ad_tape_comp_op_hpp
+#define cl_tape_impl_ad_tape_comp_op_hpp
+
+namespace CppAD { // BEGIN_CPPAD_NAMESPACE
+
+    /*
+    Zero order forward mode comparison checks for tape_inner values.
+
+    A comparison is recorded with the relation which held when the tape was
+    recorded, and for array values the bool comparison operators of tape_inner
+    hold only if they hold in every lane. The generic checks count a change
+    only if the opposite relation holds in every lane, so a lane which takes
+    the other branch goes unnoticed. Here a change is counted unless the
+    recorded relation holds in every lane; a comparison whose lanes disagree
+    is always reported, because the single branch on the tape is not valid
+    for all of them.
+    */
+#define CL_TAPE_INNER_COMPARE_OP(Name, Rel, Left, Right)                                        \
+    template <class Array>                                                                      \
+    inline void forward_##Name##_op_0(                                                          \
+        size_t&                         count,                                                  \
+        const addr_t*                   arg,                                                    \
+        const cl::tape_inner<Array>*    parameter,                                              \
+        size_t                          cap_order,                                              \
+        cl::tape_inner<Array>*          taylor)                                                 \
+    {                                                                                           \
+        count += !(Left Rel Right);                                                             \
+    }
+
+#define CL_TAPE_INNER_COMPARE_PAR(i) parameter[arg[i]]
+#define CL_TAPE_INNER_COMPARE_VAR(i) taylor[arg[i] * cap_order]
+
+    CL_TAPE_INNER_COMPARE_OP(lepv, <=, CL_TAPE_INNER_COMPARE_PAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(levp, <=, CL_TAPE_INNER_COMPARE_VAR(0), CL_TAPE_INNER_COMPARE_PAR(1))
+    CL_TAPE_INNER_COMPARE_OP(levv, <=, CL_TAPE_INNER_COMPARE_VAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(ltpv, < , CL_TAPE_INNER_COMPARE_PAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(ltvp, < , CL_TAPE_INNER_COMPARE_VAR(0), CL_TAPE_INNER_COMPARE_PAR(1))
+    CL_TAPE_INNER_COMPARE_OP(ltvv, < , CL_TAPE_INNER_COMPARE_VAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(eqpv, ==, CL_TAPE_INNER_COMPARE_PAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(eqvv, ==, CL_TAPE_INNER_COMPARE_VAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(nepv, !=, CL_TAPE_INNER_COMPARE_PAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+    CL_TAPE_INNER_COMPARE_OP(nevv, !=, CL_TAPE_INNER_COMPARE_VAR(0), CL_TAPE_INNER_COMPARE_VAR(1))
+
+#undef CL_TAPE_INNER_COMPARE_VAR
+#undef CL_TAPE_INNER_COMPARE_PAR
+#undef CL_TAPE_INNER_COMPARE_OP
+
+} // END_CPPAD_NAMESPACE
+
+#endif // cl_tape_impl_ad_tape_comp_op_hpp
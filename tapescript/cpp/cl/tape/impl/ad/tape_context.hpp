@@ -0,0 +1,232 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_context_hpp
+#define cl_tape_impl_ad_tape_context_hpp
+
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+
+#include <cl/tape/impl/ad/tape_reverse.hpp>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Points the vector to the elements of the source without copying,
+        /// the vector does not own them and does not free them.</summary>
+        template <class Type>
+        inline void attach_shared(CppAD::pod_vector<Type>& vec, CppAD::pod_vector<Type> const& source)
+        {
+            vec.free();
+            vec.data_ = const_cast<Type*>(source.data());
+            vec.length_ = source.size();
+            vec.capacity_ = 0;
+        }
+    }
+
+    /// <summary>Evaluation state of a recorded function for one thread.
+    /// The function keeps the Taylor coefficients, skipped operators and
+    /// VecAD load results of its sweeps, so one tape_function can not be swept
+    /// by two threads at once. A context shares the operation sequence of the
+    /// function without copying and owns the rest: its player position, Taylor
+    /// and Partial rows, skipped operators and load results. Contexts on the same
+    /// function can be swept concurrently, one context per thread.
+    ///
+    /// All memory of the context is allocated by the constructor, sweeps of a
+    /// tape over plain values do not allocate from thread_alloc, which is not
+    /// set up for parallel mode. For the same reason tapes with atomic functions
+    /// or VecAD are not supported, and contexts are created and destroyed by the
+    /// thread which recorded the function. The function must outlive its contexts and
+    /// its operation sequence must not change (e.g. by optimize) while they exist.
+    /// Lane buffers of array values are pooled by the context, see lane_buffer_pool.</summary>
+    template <class Base>
+    class tape_context
+    {
+    public:
+        explicit tape_context(tape_function_base<Base> const& f)
+            : play_()
+            , ind_taddr_(f.ind_taddr_)
+            , dep_taddr_(f.dep_taddr_)
+            , num_var_(f.num_var_tape_)
+            , has_taylor_(false)
+            , taylor_()
+            , partial_()
+            , cskip_op_()
+            , load_op_()
+            , buffers_()
+        {
+            CppAD::player<Base> const& play = f.play_;
+            if (play.num_vec_ind_rec() != 0)
+            {
+                throw std::runtime_error("tape_context: tapes with VecAD are not supported.");
+            }
+            for (size_t i_op = 0; i_op < play.num_op_rec(); i_op++)
+            {
+                if (play.GetOp(i_op) == CppAD::UserOp)
+                {
+                    throw std::runtime_error("tape_context: tapes with atomic functions are not supported.");
+                }
+            }
+
+            play_.num_var_rec_ = play.num_var_rec_;
+            play_.num_load_op_rec_ = play.num_load_op_rec_;
+            play_.num_vecad_vec_rec_ = play.num_vecad_vec_rec_;
+            tapescript::attach_shared(play_.op_rec_, play.op_rec_);
+            tapescript::attach_shared(play_.op_arg_rec_, play.op_arg_rec_);
+            tapescript::attach_shared(play_.par_rec_, play.par_rec_);
+            tapescript::attach_shared(play_.text_rec_, play.text_rec_);
+            tapescript::attach_shared(play_.vecad_ind_rec_, play.vecad_ind_rec_);
+
+            taylor_.extend(num_var_);
+            partial_.extend(num_var_);
+            cskip_op_.extend(play.num_op_rec());
+            load_op_.extend(play.num_load_op_rec());
+        }
+
+        /// <summary>Dimension of the domain of the function.</summary>
+        size_t domain() const
+        {
+            return ind_taddr_.size();
+        }
+
+        /// <summary>Dimension of the range of the function.</summary>
+        size_t range() const
+        {
+            return dep_taddr_.size();
+        }
+
+        /// <summary>Zero order forward sweep at x, the same as f.Forward(0, x)
+        /// but with the coefficients stored in this context.</summary>
+        template <typename VectorBase>
+        void forward(VectorBase const& x, VectorBase& y)
+        {
+            size_t n = domain();
+            size_t m = range();
+            if (size_t(x.size()) != n)
+            {
+                throw std::runtime_error("tape_context::forward: x.size() is not equal to the domain size.");
+            }
+
+            typename tapescript::lane_buffers<Base>::scope buffers(buffers_);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                taylor_[ind_taddr_[j]] = x[j];
+            }
+
+            size_t compare_change_number = 0;
+            size_t compare_change_op_index = 0;
+            forward0sweep(std::cout, false, n, num_var_, &play_, 1
+                , taylor_.data(), cskip_op_.data(), load_op_
+                , 0, compare_change_number, compare_change_op_index);
+            has_taylor_ = true;
+
+            if (size_t(y.size()) != m)
+            {
+                y.resize(m);
+            }
+            for (size_t i = 0; i < m; i++)
+            {
+                y[i] = taylor_[dep_taddr_[i]];
+            }
+        }
+
+        /// <summary>First order reverse sweep with the range weights w at the
+        /// point of the last forward sweep of this context, the same as f.Reverse(1, w).</summary>
+        template <typename VectorBase>
+        void reverse(VectorBase const& w, VectorBase& dw)
+        {
+            size_t n = domain();
+            size_t m = range();
+            if (!has_taylor_)
+            {
+                throw std::runtime_error("tape_context::reverse: forward was not called for this context.");
+            }
+            if (size_t(w.size()) != m)
+            {
+                throw std::runtime_error("tape_context::reverse: w.size() is not equal to the range size.");
+            }
+
+            typename tapescript::lane_buffers<Base>::scope buffers(buffers_);
+
+            for (size_t i = 0; i < num_var_; i++)
+            {
+                tapescript::reset_partial(partial_[i], taylor_[i]);
+            }
+            // use += because two dependent variables can point to same location
+            for (size_t i = 0; i < m; i++)
+            {
+                partial_[dep_taddr_[i]] += w[i];
+            }
+
+            ReverseSweep(0, n, num_var_, &play_, 1
+                , taylor_.data(), 1, partial_.data(), cskip_op_.data(), load_op_
+                , CppAD::getarg<1>(w));
+
+            if (size_t(dw.size()) != n)
+            {
+                dw.resize(n);
+            }
+            for (size_t j = 0; j < n; j++)
+            {
+                dw[j] = partial_[ind_taddr_[j]];
+                tapescript::set_not_intrusive(dw[j]);
+            }
+        }
+
+        /// <summary>Values y and gradient dw of w^T F at x, a forward sweep
+        /// followed by a reverse sweep in this context.</summary>
+        template <typename VectorBase>
+        void evaluate(VectorBase const& x, VectorBase const& w, VectorBase& y, VectorBase& dw)
+        {
+            forward(x, y);
+            reverse(w, dw);
+        }
+
+    private:
+        tape_context(tape_context const&);
+        tape_context& operator=(tape_context const&);
+
+        CppAD::player<Base> play_;
+        CppAD::vector<size_t> ind_taddr_;
+        CppAD::vector<size_t> dep_taddr_;
+        size_t num_var_;
+        bool has_taylor_;
+        CppAD::pod_vector<Base> taylor_;
+        CppAD::pod_vector<Base> partial_;
+        CppAD::pod_vector<bool> cskip_op_;
+        CppAD::pod_vector<CppAD::addr_t> load_op_;
+        tapescript::lane_buffers<Base> buffers_;
+    };
+
+    /// <summary>Thread-safe sweep of a recorded function: the values y and gradient dw
+    /// of w^T F at x computed with the evaluation state of the context. Threads which
+    /// evaluate the same function concurrently each use their own context.</summary>
+    template <class Base, typename VectorBase>
+    inline void evaluate(tape_context<Base>& context, VectorBase const& x, VectorBase const& w
+        , VectorBase& y, VectorBase& dw)
+    {
+        context.evaluate(x, w, y, dw);
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_context_hpp
@@ -0,0 +1,136 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file includes code from CppAD, a C++ algorithmic differentiation library
+distributed under multiple licenses. This distribution is under the terms of
+the Eclipse Public License Version 1.0, a copy of which is available at:
+
+https://www.eclipse.org/legal/epl-v10.html
+
+CppAD code included in this file is subject to copyright:
+
+Copyright (C) 2003-15 Bradley M. Bell
+*/
+
+#ifndef cl_tape_impl_ad_tape_cskip_op_hpp
+#define cl_tape_impl_ad_tape_cskip_op_hpp
+
+namespace CppAD { // BEGIN_CPPAD_NAMESPACE
+
+    /*!
+    Zero order forward mode execution of op = CSkipOp for tape_inner values.
+
+    The generic version decides on a single comparison result, for array values
+    the comparison operators of tape_inner are true only if they hold in every
+    lane. A lane mix would then skip the operators of the true case although
+    some lanes select them. Here operators are skipped only if the comparison
+    has the same result in every lane, otherwise both cases are evaluated and
+    the lane-wise CExpOp picks the values.
+    */
+    template <class Array>
+    inline void forward_cskip_op_0(
+        size_t                          i_z,
+        const addr_t*                   arg,
+        size_t                          num_par,
+        const cl::tape_inner<Array>*    parameter,
+        size_t                          cap_order,
+        cl::tape_inner<Array>*          taylor,
+        bool*                           cskip_op)
+    {
+        typedef cl::tape_inner<Array> Base;
+
+        CPPAD_ASSERT_UNKNOWN(size_t(arg[0]) < size_t(CompareNe));
+        CPPAD_ASSERT_UNKNOWN(arg[1] != 0);
+
+        Base left, right;
+        if (arg[1] & 1)
+        {
+            left = taylor[arg[2] * cap_order + 0];
+        }
+        else
+        {
+            CPPAD_ASSERT_UNKNOWN(size_t(arg[2]) < num_par);
+            left = parameter[arg[2]];
+        }
+        if (arg[1] & 2)
+        {
+            right = taylor[arg[3] * cap_order + 0];
+        }
+        else
+        {
+            CPPAD_ASSERT_UNKNOWN(size_t(arg[3]) < num_par);
+            right = parameter[arg[3]];
+        }
+
+        // true_case holds if the comparison is true in every lane,
+        // false_case if it is false in every lane.
+        bool true_case = false;
+        bool false_case = false;
+        Base diff = left - right;
+        switch (CompareOp(arg[0]))
+        {
+        case CompareLt:
+            true_case = diff < 0.;
+            false_case = diff >= 0.;
+            break;
+
+        case CompareLe:
+            true_case = diff <= 0.;
+            false_case = diff > 0.;
+            break;
+
+        case CompareEq:
+            true_case = diff == 0.;
+            false_case = diff != 0.;
+            break;
+
+        case CompareGe:
+            true_case = diff >= 0.;
+            false_case = diff < 0.;
+            break;
+
+        case CompareGt:
+            true_case = diff > 0.;
+            false_case = diff <= 0.;
+            break;
+
+        case CompareNe:
+            true_case = diff != 0.;
+            false_case = diff == 0.;
+            break;
+
+        default:
+            CPPAD_ASSERT_UNKNOWN(false);
+        }
+
+        if (true_case)
+        {
+            for (size_t i = 0; i < size_t(arg[4]); i++)
+                cskip_op[arg[6 + i]] = true;
+        }
+        else if (false_case)
+        {
+            for (size_t i = 0; i < size_t(arg[5]); i++)
+                cskip_op[arg[6 + arg[4] + i]] = true;
+        }
+    }
+
+} // END_CPPAD_NAMESPACE
+
+#endif // cl_tape_impl_ad_tape_cskip_op_hpp
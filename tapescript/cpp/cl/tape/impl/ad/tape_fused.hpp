@@ -0,0 +1,753 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_fused_hpp
+#define cl_tape_impl_ad_tape_fused_hpp
+
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Kinds of the nodes of a fused tape.</summary>
+        enum fused_kind
+        {
+            // c_0 + sum_k c_k u_k v_k, v_k is absent for linear terms.
+            fused_linear,
+            // exp(c_0 + sum_k c_k u_k v_k).
+            fused_exp_linear,
+            // u / v.
+            fused_div,
+            // pow(u, v).
+            fused_pow,
+            // f(u), code_ is the CppAD::OpCode of f.
+            fused_unary,
+            // compare(l, r) ? t : f, code_ is the CppAD::CompareOp.
+            fused_cond
+        };
+
+        /// <summary>Operand slot of a term without second factor.</summary>
+        const CppAD::addr_t fused_none = std::numeric_limits<CppAD::addr_t>::max();
+
+        /// <summary>Node of a fused tape, operands are slots of the value array.</summary>
+        struct fused_node
+        {
+            unsigned char kind_;
+            unsigned char code_;
+            // Slot of the result.
+            CppAD::addr_t result_;
+            // First operand slot in the argument array.
+            CppAD::addr_t arg_;
+            // Number of terms of a linear node, operands of the other nodes.
+            CppAD::addr_t size_;
+            // Index of the constant term of a linear node in the coefficients,
+            // the coefficients of the terms follow it.
+            CppAD::addr_t coef_;
+        };
+    }
+
+    /// <summary>Recorded function translated to fused nodes, evaluated by its own zero
+    /// order forward and first order reverse sweeps. The tape records one operation per
+    /// tape_wrapper operator, each with its own Taylor coefficient. The translation runs
+    /// on the finished recording, so the cost of recording and the size of the tape are
+    /// unchanged; only the sweeps of this object are shorter. It folds every sum,
+    /// difference, product and scaling whose intermediate results are used once into
+    /// one node c_0 + sum_k c_k u_k v_k, which covers FMA (df * (1 + r * tau)),
+    /// axpy-style sums and cumulative sums, and merges exp of such a node into it
+    /// (exp(-r * t)). Intermediate results which are not used are dropped.
+    /// Values agree with the tape to rounding, the order of the additions may differ.
+    ///
+    /// Supports the operations of compiled tapes (write_tape_source) on a native
+    /// Base: comparisons and CSkipOp do not change the sweeps, every conditional
+    /// expression is evaluated. The object owns its value and adjoint arrays, one
+    /// object must not be swept by several threads at once.</summary>
+    template <class Base>
+    class fused_tape_function
+    {
+        static_assert(std::is_arithmetic<Base>::value
+            , "Fused tapes are limited to tapes with a native Base.");
+
+        typedef CppAD::addr_t addr_t;
+        typedef tapescript::fused_node node_type;
+
+    public:
+        explicit fused_tape_function(tape_function_base<Base> const& f)
+            : num_op_(f.play_.num_op_rec())
+            , node_()
+            , arg_()
+            , coef_()
+            , value_()
+            , adjoint_()
+            , ind_slot_()
+            , dep_slot_()
+            , play_(nullptr)
+            , var_slot_()
+            , par_slot_()
+            , use_()
+            , pending_()
+        {
+            translate(f);
+        }
+
+        /// <summary>Number of independent variables.</summary>
+        size_t domain() const
+        {
+            return ind_slot_.size();
+        }
+
+        /// <summary>Number of dependent variables.</summary>
+        size_t range() const
+        {
+            return dep_slot_.size();
+        }
+
+        /// <summary>Number of operations of the recorded tape.</summary>
+        size_t size_op() const
+        {
+            return num_op_;
+        }
+
+        /// <summary>Number of fused nodes evaluated by the sweeps.</summary>
+        size_t size_node() const
+        {
+            return node_.size();
+        }
+
+        /// <summary>Number of values, constants included, with one adjoint each.</summary>
+        size_t size_value() const
+        {
+            return value_.size();
+        }
+
+        /// <summary>Bytes held by the nodes, operands, coefficients, values and adjoints.</summary>
+        size_t memory() const
+        {
+            return node_.size() * sizeof(node_type) + arg_.size() * sizeof(addr_t)
+                + (coef_.size() + value_.size() + adjoint_.size()) * sizeof(Base)
+                + (ind_slot_.size() + dep_slot_.size()) * sizeof(addr_t);
+        }
+
+        /// <summary>Values of the function at x.</summary>
+        std::vector<Base> forward(std::vector<Base> const& x)
+        {
+            check(x.size(), domain(), "fused_tape_function::forward: x.size() is not equal to the domain size.");
+
+            for (size_t j = 0; j < ind_slot_.size(); j++)
+            {
+                value_[ind_slot_[j]] = x[j];
+            }
+            sweep_forward();
+
+            std::vector<Base> y(dep_slot_.size());
+            for (size_t i = 0; i < dep_slot_.size(); i++)
+            {
+                y[i] = value_[dep_slot_[i]];
+            }
+            return y;
+        }
+
+        /// <summary>Derivatives of w^T y with respect to x at x.</summary>
+        std::vector<Base> reverse(std::vector<Base> const& x, std::vector<Base> const& w)
+        {
+            check(w.size(), range(), "fused_tape_function::reverse: w.size() is not equal to the range size.");
+
+            forward(x);
+
+            std::fill(adjoint_.begin(), adjoint_.end(), Base(0));
+            // use += because two dependent variables can point to same location
+            for (size_t i = 0; i < dep_slot_.size(); i++)
+            {
+                adjoint_[dep_slot_[i]] += w[i];
+            }
+            sweep_reverse();
+
+            std::vector<Base> dw(ind_slot_.size());
+            for (size_t j = 0; j < ind_slot_.size(); j++)
+            {
+                dw[j] = adjoint_[ind_slot_[j]];
+            }
+            return dw;
+        }
+
+    private:
+        fused_tape_function(fused_tape_function const&);
+        fused_tape_function& operator=(fused_tape_function const&);
+
+        // c u v, v is tapescript::fused_none for linear terms.
+        struct term
+        {
+            Base coef_;
+            addr_t u_;
+            addr_t v_;
+        };
+
+        // Sum of a constant and terms, not yet emitted as a node.
+        struct linear
+        {
+            linear()
+                : constant_(0)
+                , terms_()
+            {}
+
+            Base constant_;
+            std::vector<term> terms_;
+
+            void scale(Base c)
+            {
+                constant_ *= c;
+                for (auto& t : terms_)
+                {
+                    t.coef_ *= c;
+                }
+            }
+
+            void add(linear const& other, Base sign)
+            {
+                constant_ += sign * other.constant_;
+                for (auto t : other.terms_)
+                {
+                    t.coef_ *= sign;
+                    terms_.push_back(t);
+                }
+            }
+        };
+
+        static void check(size_t size, size_t expected, char const* what)
+        {
+            if (size != expected)
+            {
+                throw std::runtime_error(what);
+            }
+        }
+
+        // Calls visit(i) for every variable argument i of the operation.
+        template <class Visit>
+        static void variables(CppAD::OpCode op, addr_t const* arg, Visit visit)
+        {
+            using namespace CppAD;
+
+            switch (op)
+            {
+            case AbsOp: case SignOp: case ExpOp: case LogOp: case SqrtOp:
+            case SinOp: case CosOp: case TanOp: case AsinOp: case AcosOp: case AtanOp:
+            case SinhOp: case CoshOp: case TanhOp: case ErfOp:
+                visit(arg[0]);
+                break;
+
+            case AddvvOp: case SubvvOp: case MulvvOp: case DivvvOp: case PowvvOp:
+                visit(arg[0]);
+                visit(arg[1]);
+                break;
+
+            case AddpvOp: case SubpvOp: case MulpvOp: case DivpvOp: case PowpvOp:
+                visit(arg[1]);
+                break;
+
+            case SubvpOp: case DivvpOp: case PowvpOp:
+                visit(arg[0]);
+                break;
+
+            case CSumOp:
+                for (addr_t j = 0; j < arg[0] + arg[1]; j++)
+                {
+                    visit(arg[3 + j]);
+                }
+                break;
+
+            case CExpOp:
+                for (addr_t j = 0; j < 4; j++)
+                {
+                    if (arg[1] & (1 << j))
+                    {
+                        visit(arg[2 + j]);
+                    }
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        addr_t new_slot(Base value)
+        {
+            value_.push_back(value);
+            return addr_t(value_.size() - 1);
+        }
+
+        // Slot of the parameter, one per parameter of the tape.
+        addr_t constant(size_t i_par)
+        {
+            addr_t& slot = par_slot_[i_par];
+            if (slot == tapescript::fused_none)
+            {
+                slot = new_slot(play_->par_rec_[i_par]);
+            }
+            return slot;
+        }
+
+        // Slot of the operand, a parameter if the flag is not set.
+        addr_t operand(addr_t const* arg, size_t j, bool variable)
+        {
+            return variable ? slot(arg[j]) : constant(arg[j]);
+        }
+
+        // Slot of the variable, emits its pending sum first.
+        addr_t slot(size_t i_var)
+        {
+            auto it = pending_.find(i_var);
+            if (it != pending_.end())
+            {
+                linear sum = std::move(it->second);
+                pending_.erase(it);
+                var_slot_[i_var] = emit(tapescript::fused_linear, sum);
+            }
+            return var_slot_[i_var];
+        }
+
+        // Sum of the variable, taken over if it is pending.
+        linear expression(size_t i_var)
+        {
+            linear result;
+            auto it = pending_.find(i_var);
+            if (it != pending_.end())
+            {
+                result = std::move(it->second);
+                pending_.erase(it);
+            }
+            else
+            {
+                result.terms_.push_back(term{ Base(1), slot(i_var), tapescript::fused_none });
+            }
+            return result;
+        }
+
+        // c u if the variable is a scaled single value, otherwise 1 and its slot.
+        term factor(size_t i_var)
+        {
+            auto it = pending_.find(i_var);
+            if (it != pending_.end() && it->second.constant_ == Base(0)
+                && it->second.terms_.size() == 1 && it->second.terms_[0].v_ == tapescript::fused_none)
+            {
+                term result = it->second.terms_[0];
+                pending_.erase(it);
+                return result;
+            }
+            return term{ Base(1), slot(i_var), tapescript::fused_none };
+        }
+
+        addr_t emit(tapescript::fused_kind kind, linear const& sum)
+        {
+            node_type node;
+            node.kind_ = static_cast<unsigned char>(kind);
+            node.code_ = 0;
+            node.result_ = new_slot(Base(0));
+            node.arg_ = addr_t(arg_.size());
+            node.size_ = addr_t(sum.terms_.size());
+            node.coef_ = addr_t(coef_.size());
+            coef_.push_back(sum.constant_);
+            for (auto const& t : sum.terms_)
+            {
+                coef_.push_back(t.coef_);
+                arg_.push_back(t.u_);
+                arg_.push_back(t.v_);
+            }
+            node_.push_back(node);
+            return node.result_;
+        }
+
+        addr_t emit(tapescript::fused_kind kind, unsigned char code, std::vector<addr_t> const& operands)
+        {
+            node_type node;
+            node.kind_ = static_cast<unsigned char>(kind);
+            node.code_ = code;
+            node.result_ = new_slot(Base(0));
+            node.arg_ = addr_t(arg_.size());
+            node.size_ = addr_t(operands.size());
+            node.coef_ = 0;
+            arg_.insert(arg_.end(), operands.begin(), operands.end());
+            node_.push_back(node);
+            return node.result_;
+        }
+
+        // The sum of z is kept pending if its only use can take it over.
+        void assign(size_t z, linear&& sum)
+        {
+            if (use_[z] == 1)
+            {
+                pending_[z] = std::move(sum);
+            }
+            else
+            {
+                var_slot_[z] = emit(tapescript::fused_linear, sum);
+            }
+        }
+
+        void translate(tape_function_base<Base> const& f)
+        {
+            using namespace CppAD;
+
+            player<Base> const& play = f.play_;
+            play_ = &play;
+            size_t num_var = f.num_var_tape_;
+
+            var_slot_.assign(num_var, tapescript::fused_none);
+            par_slot_.assign(play.num_par_rec(), tapescript::fused_none);
+            use_.assign(num_var, 0);
+
+            // Uses of the variables; dependent variables are never pending.
+            tapescript::for_each_op(play, [this](OpCode op, addr_t const* arg, size_t)
+            {
+                variables(op, arg, [this](size_t i) { use_[i]++; });
+            });
+            for (size_t i = 0; i < f.dep_taddr_.size(); i++)
+            {
+                use_[f.dep_taddr_[i]] += 2;
+            }
+
+            tapescript::for_each_op(play, [this](OpCode op, addr_t const* arg, size_t z)
+            {
+                // Results which are not used are not evaluated.
+                bool used = NumRes(op) == 0 || use_[z] != 0;
+                if (op != InvOp && op != ParOp && used)
+                {
+                    translate_op(op, arg, z);
+                }
+                else if (op == InvOp)
+                {
+                    var_slot_[z] = new_slot(Base(0));
+                    ind_slot_.push_back(var_slot_[z]);
+                }
+                else if (op == ParOp)
+                {
+                    var_slot_[z] = constant(arg[0]);
+                }
+            });
+
+            for (size_t i = 0; i < f.dep_taddr_.size(); i++)
+            {
+                dep_slot_.push_back(slot(f.dep_taddr_[i]));
+            }
+
+            adjoint_.assign(value_.size(), Base(0));
+            pending_.clear();
+            var_slot_ = std::vector<addr_t>();
+            par_slot_ = std::vector<addr_t>();
+            use_ = std::vector<size_t>();
+            play_ = nullptr;
+        }
+
+        void translate_op(CppAD::OpCode op, addr_t const* arg, size_t z)
+        {
+            using namespace CppAD;
+
+            Base const* par = play_->par_rec_.data();
+
+            switch (op)
+            {
+            case BeginOp:
+            case EndOp:
+            case PriOp:
+            case CSkipOp:
+            case EqpvOp: case EqvvOp:
+            case LepvOp: case LevpOp: case LevvOp:
+            case LtpvOp: case LtvpOp: case LtvvOp:
+            case NepvOp: case NevvOp:
+                // All operations are evaluated, comparisons only count changes.
+                break;
+
+            case AddvvOp:
+            case SubvvOp:
+            {
+                linear sum = expression(arg[0]);
+                sum.add(expression(arg[1]), op == AddvvOp ? Base(1) : Base(-1));
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case AddpvOp:
+            case SubpvOp:
+            {
+                linear sum;
+                sum.constant_ = par[arg[0]];
+                sum.add(expression(arg[1]), op == AddpvOp ? Base(1) : Base(-1));
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case SubvpOp:
+            {
+                linear sum = expression(arg[0]);
+                sum.constant_ -= par[arg[1]];
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case CSumOp:
+            {
+                // arg[0] added and arg[1] subtracted variables follow the parameter arg[2].
+                linear sum;
+                sum.constant_ = par[arg[2]];
+                for (addr_t j = 0; j < arg[0] + arg[1]; j++)
+                {
+                    sum.add(expression(arg[3 + j]), j < arg[0] ? Base(1) : Base(-1));
+                }
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case MulpvOp:
+            {
+                linear sum = expression(arg[1]);
+                sum.scale(par[arg[0]]);
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case DivvpOp:
+            {
+                linear sum = expression(arg[0]);
+                sum.scale(Base(1) / par[arg[1]]);
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case MulvvOp:
+            {
+                term u = factor(arg[0]);
+                term v = factor(arg[1]);
+                linear sum;
+                sum.terms_.push_back(term{ u.coef_ * v.coef_, u.u_, v.u_ });
+                assign(z, std::move(sum));
+                break;
+            }
+
+            case ExpOp:
+                if (pending_.count(arg[0]))
+                {
+                    var_slot_[z] = emit(tapescript::fused_exp_linear, expression(arg[0]));
+                }
+                else
+                {
+                    var_slot_[z] = emit(tapescript::fused_unary, static_cast<unsigned char>(op)
+                        , std::vector<addr_t>{ slot(arg[0]) });
+                }
+                break;
+
+            case DivvvOp:
+            case DivpvOp:
+                var_slot_[z] = emit(tapescript::fused_div, 0
+                    , std::vector<addr_t>{ operand(arg, 0, op == DivvvOp), slot(arg[1]) });
+                break;
+
+            case PowvvOp:
+            case PowpvOp:
+            case PowvpOp:
+                var_slot_[z] = emit(tapescript::fused_pow, 0
+                    , std::vector<addr_t>{ operand(arg, 0, op != PowpvOp), operand(arg, 1, op != PowvpOp) });
+                break;
+
+            case AbsOp: case SignOp: case LogOp: case SqrtOp:
+            case SinOp: case CosOp: case TanOp: case AsinOp: case AcosOp: case AtanOp:
+            case SinhOp: case CoshOp: case TanhOp:
+                var_slot_[z] = emit(tapescript::fused_unary, static_cast<unsigned char>(op)
+                    , std::vector<addr_t>{ slot(arg[0]) });
+                break;
+
+            case ErfOp:
+                // arg[2] is the parameter 2 / sqrt(pi).
+                var_slot_[z] = emit(tapescript::fused_unary, static_cast<unsigned char>(op)
+                    , std::vector<addr_t>{ slot(arg[0]), constant(arg[2]) });
+                break;
+
+            case CExpOp:
+                var_slot_[z] = emit(tapescript::fused_cond, static_cast<unsigned char>(arg[0])
+                    , std::vector<addr_t>{ operand(arg, 2, (arg[1] & 1) != 0), operand(arg, 3, (arg[1] & 2) != 0)
+                        , operand(arg, 4, (arg[1] & 4) != 0), operand(arg, 5, (arg[1] & 8) != 0) });
+                break;
+
+            default:
+                // Discrete functions, VecAD and atomic operations.
+                throw std::runtime_error(std::string("Fused tapes do not support the tape operation ")
+                    + OpName(op) + ".");
+            }
+        }
+
+        static bool compare(unsigned char code, Base left, Base right)
+        {
+            switch (CppAD::CompareOp(code))
+            {
+            case CppAD::CompareLt: return left < right;
+            case CppAD::CompareLe: return left <= right;
+            case CppAD::CompareEq: return left == right;
+            case CppAD::CompareGe: return left >= right;
+            case CppAD::CompareGt: return left > right;
+            default: return left != right;
+            }
+        }
+
+        void sweep_forward()
+        {
+            Base* v = value_.data();
+            addr_t const* arg = arg_.data();
+            Base const* coef = coef_.data();
+
+            for (node_type const& node : node_)
+            {
+                addr_t const* a = arg + node.arg_;
+                switch (node.kind_)
+                {
+                case tapescript::fused_linear:
+                case tapescript::fused_exp_linear:
+                {
+                    Base const* c = coef + node.coef_;
+                    Base sum = c[0];
+                    for (addr_t k = 0; k < node.size_; k++)
+                    {
+                        Base t = c[k + 1] * v[a[2 * k]];
+                        if (a[2 * k + 1] != tapescript::fused_none)
+                        {
+                            t *= v[a[2 * k + 1]];
+                        }
+                        sum += t;
+                    }
+                    v[node.result_] = node.kind_ == tapescript::fused_linear ? sum : std::exp(sum);
+                    break;
+                }
+
+                case tapescript::fused_div:
+                    v[node.result_] = v[a[0]] / v[a[1]];
+                    break;
+
+                case tapescript::fused_pow:
+                    v[node.result_] = std::pow(v[a[0]], v[a[1]]);
+                    break;
+
+                case tapescript::fused_unary:
+                    v[node.result_] = tapescript::unary_op_value(CppAD::OpCode(node.code_), v[a[0]]);
+                    break;
+
+                default:
+                    v[node.result_] = compare(node.code_, v[a[0]], v[a[1]]) ? v[a[2]] : v[a[3]];
+                    break;
+                }
+            }
+        }
+
+        // Adjoints of the constants are accumulated too and never read.
+        void sweep_reverse()
+        {
+            Base const* v = value_.data();
+            Base* d = adjoint_.data();
+            addr_t const* arg = arg_.data();
+            Base const* coef = coef_.data();
+
+            for (size_t i_node = node_.size(); i_node-- > 0;)
+            {
+                node_type const& node = node_[i_node];
+                addr_t const* a = arg + node.arg_;
+                Base dz = d[node.result_];
+                if (dz == Base(0))
+                {
+                    continue;
+                }
+
+                switch (node.kind_)
+                {
+                case tapescript::fused_linear:
+                case tapescript::fused_exp_linear:
+                {
+                    Base const* c = coef + node.coef_;
+                    if (node.kind_ == tapescript::fused_exp_linear)
+                    {
+                        dz *= v[node.result_];
+                    }
+                    for (addr_t k = 0; k < node.size_; k++)
+                    {
+                        Base dt = c[k + 1] * dz;
+                        addr_t u = a[2 * k];
+                        addr_t w = a[2 * k + 1];
+                        if (w == tapescript::fused_none)
+                        {
+                            d[u] += dt;
+                        }
+                        else
+                        {
+                            d[u] += dt * v[w];
+                            d[w] += dt * v[u];
+                        }
+                    }
+                    break;
+                }
+
+                case tapescript::fused_div:
+                    d[a[0]] += dz / v[a[1]];
+                    d[a[1]] -= dz * v[node.result_] / v[a[1]];
+                    break;
+
+                case tapescript::fused_pow:
+                    d[a[0]] += dz * v[a[1]] * std::pow(v[a[0]], v[a[1]] - Base(1));
+                    d[a[1]] += dz * v[node.result_] * std::log(v[a[0]]);
+                    break;
+
+                case tapescript::fused_unary:
+                    d[a[0]] += dz * tapescript::unary_op_derivative(CppAD::OpCode(node.code_), v[a[0]]
+                        , v[node.result_], node.size_ > 1 ? v[a[1]] : Base(0));
+                    break;
+
+                default:
+                    d[compare(node.code_, v[a[0]], v[a[1]]) ? a[2] : a[3]] += dz;
+                    break;
+                }
+            }
+        }
+
+        // Operations of the recorded tape.
+        size_t num_op_;
+        std::vector<node_type> node_;
+        // Operand slots of the nodes.
+        std::vector<addr_t> arg_;
+        // Coefficients of the linear nodes.
+        std::vector<Base> coef_;
+        // Values of the constants, independent variables and nodes.
+        std::vector<Base> value_;
+        std::vector<Base> adjoint_;
+        std::vector<addr_t> ind_slot_;
+        std::vector<addr_t> dep_slot_;
+
+        // State of the translation.
+        CppAD::player<Base> const* play_;
+        std::vector<addr_t> var_slot_;
+        std::vector<addr_t> par_slot_;
+        std::vector<size_t> use_;
+        std::unordered_map<size_t, linear> pending_;
+    };
+}
+
+#endif // cl_tape_impl_ad_tape_fused_hpp
@@ -0,0 +1,139 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_hessian_hpp
+#define cl_tape_impl_ad_tape_hessian_hpp
+
+#include <set>
+#include <vector>
+#include <stdexcept>
+
+#include <cl/tape/impl/ad/tape_sparsity.hpp>
+
+namespace cl
+{
+    /// <summary>Hessian of w^T F times the direction v by forward over reverse mode:
+    /// a first order forward sweep in the direction v followed by a second order
+    /// reverse sweep, both at the independent values of the last zero order
+    /// forward sweep. The cost is a small multiple of a gradient.</summary>
+    template <class Base, class VectorBase>
+    inline VectorBase
+    hessian_times(tape_function_base<Base>& f, VectorBase const& w, VectorBase const& v)
+    {
+        size_t n = f.Domain();
+        if (f.size_order() == 0)
+        {
+            throw std::runtime_error("Zero order forward has to be computed before the Hessian.");
+        }
+        if (v.size() != n || w.size() != f.Range())
+        {
+            throw std::runtime_error("Hessian direction or weights do not match the function size.");
+        }
+
+        f.Forward(1, v);
+        VectorBase ddw = f.Reverse(2, w);
+
+        // Second order partials are the derivatives of the first order ones along v.
+        VectorBase hv(n);
+        for (size_t j = 0; j < n; j++)
+        {
+            hv[j] = ddw[j * 2 + 1];
+        }
+        return hv;
+    }
+
+    /// <summary>Dense Hessian of w^T F at x by one forward over reverse sweep per
+    /// independent variable, hes[j * n + l] is the derivative by x_j and x_l.</summary>
+    template <class Base, class VectorBase>
+    inline VectorBase
+    hessian(tape_function_base<Base>& f, VectorBase const& x, VectorBase const& w)
+    {
+        size_t n = f.Domain();
+        f.Forward(0, x);
+
+        VectorBase hes(n * n);
+        VectorBase u(n, Base(0));
+        for (size_t l = 0; l < n; l++)
+        {
+            u[l] = Base(1);
+            VectorBase column = hessian_times(f, w, u);
+            u[l] = Base(0);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                hes[j * n + l] = column[j];
+            }
+        }
+        return hes;
+    }
+
+    /// <summary>Sparse Hessian of w^T F at x. On the first call, with an empty hes,
+    /// the sparsity pattern is computed and the columns are grouped by a symmetric
+    /// colouring, so that one forward over reverse sweep gives all the columns of
+    /// a group. Both are stored in hes and work and reused by the following calls,
+    /// which only update the values. Returns the number of sweeps.</summary>
+    template <class Base, class VectorBase>
+    inline size_t
+    sparse_hessian(tape_function_base<Base>& f, VectorBase const& x, VectorBase const& w
+        , tape_sparse_matrix<Base>& hes, CppAD::sparse_hessian_work& work)
+    {
+        size_t n = f.Domain();
+
+        // The pattern is used only to colour the columns, which is done once.
+        tape_sparsity p;
+        if (hes.row_.empty())
+        {
+            p = hessian_sparsity(f, w);
+
+            hes.rows_ = n;
+            hes.cols_ = n;
+            for (size_t j = 0; j < n; j++)
+            {
+                for (size_t l : p[j])
+                {
+                    hes.row_.push_back(j);
+                    hes.col_.push_back(l);
+                }
+            }
+            hes.value_.resize(hes.row_.size());
+            work.clear();
+        }
+
+        if (hes.row_.empty())
+        {
+            f.Forward(0, x);
+            return 0;
+        }
+        return f.SparseHessian(x, w, p, hes.row_, hes.col_, hes.value_, work);
+    }
+
+    /// <summary>Sparse Hessian of w^T F at x, see the overload above.</summary>
+    template <class Base, class VectorBase>
+    inline tape_sparse_matrix<Base>
+    sparse_hessian(tape_function_base<Base>& f, VectorBase const& x, VectorBase const& w)
+    {
+        tape_sparse_matrix<Base> hes;
+        CppAD::sparse_hessian_work work;
+        sparse_hessian(f, x, w, hes, work);
+        return hes;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_hessian_hpp
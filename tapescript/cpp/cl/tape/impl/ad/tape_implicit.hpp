@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_implicit_hpp
+#define cl_tape_impl_ad_tape_implicit_hpp
+
+#include <stdexcept>
+
+#include <cl/tape/impl/double.hpp>
+#include <cl/tape/impl/thread_local.hpp>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Number of second order scopes open on the calling thread.</summary>
+        inline unsigned& implicit_second_order_depth()
+        {
+            static CL_THREAD_LOCAL unsigned depth = 0;
+            return depth;
+        }
+    }
+
+    /// <summary>Scope in which implicit_root also gives exact second derivatives.
+    /// The single step of implicit_root is linear in f, so the second derivatives
+    /// of the root miss the curvature of f in x. While the scope is open on the
+    /// calling thread a second Newton step x - (f(x) - f0) / d is recorded from
+    /// the result of the first one, whose error is of second order in the inputs,
+    /// so the error of the root is of third order and its Hessian is exact.
+    /// This costs a second evaluation of f; tape_hessian opens the scope while
+    /// recording. Scopes nest.</summary>
+    class implicit_second_order_scope
+    {
+    public:
+        implicit_second_order_scope()
+        {
+            tapescript::implicit_second_order_depth()++;
+        }
+
+        ~implicit_second_order_scope()
+        {
+            tapescript::implicit_second_order_depth()--;
+        }
+
+        /// <summary>True if the calling thread is inside a second order scope.</summary>
+        static bool active()
+        {
+            return tapescript::implicit_second_order_depth() != 0;
+        }
+
+    private:
+        implicit_second_order_scope(implicit_second_order_scope const&);
+        implicit_second_order_scope& operator=(implicit_second_order_scope const&);
+    };
+
+    /// <summary>Root x of f(x, p) = 0 with the derivatives of the implicit
+    /// function theorem, dx/dp = -(df/dx)^-1 df/dp.
+    ///
+    /// The root is found beforehand on plain values, e.g. by the iterations
+    /// of a solver in a tape_passive_scope, so none of them is recorded.
+    /// derivative(x) returns df/dx and is called first, in a passive scope.
+    /// f(x) is then evaluated once at the value of the root while recording,
+    /// so it depends on the inputs p of the recording but not on x; being
+    /// the last evaluation, it also leaves functions which keep state, e.g.
+    /// a curve bootstrap, at the root. The result has the value of the root
+    /// and is recorded as x - (f(x) - f0) / d with the parameters f0 = f(x)
+    /// and d = df/dx, so the tape holds one evaluation of f and three
+    /// operations whatever the number of iterations, and the derivatives do
+    /// not depend on when the iterations stopped.
+    ///
+    /// The first derivatives are exact up to the error of d, which scales
+    /// them by d / (df/dx). If derivative uses finite differences, e.g.
+    /// the central ones of Solver1D for functions without a derivative
+    /// method, their relative error is of order eps^(2/3), about 1e-11 in
+    /// double. See implicit_second_order_scope for the second derivatives.
+    ///
+    /// The recorded step is the linearization of the root at the recorded
+    /// inputs, so a tape with implicit roots is valid at the recorded point
+    /// only and must not be swept at other inputs, see tape_function.</summary>
+    template <class Base, class Function, class Derivative>
+    inline tape_wrapper<Base> implicit_root(tape_wrapper<Base> const& root
+        , Function const& f, Derivative const& derivative)
+    {
+        typedef tape_wrapper<Base> value_type;
+
+        value_type x(tapescript::passive_value(tapescript::cvalue(root)));
+        Base df;
+        {
+            tape_passive_scope scope;
+            df = tapescript::passive_value(tapescript::cvalue(value_type(derivative(x))));
+        }
+
+        value_type f_root = f(x);
+        if (!CppAD::Variable(tapescript::cvalue(f_root)))
+        {
+            return x;
+        }
+        if (!(df != Base(0.0)))
+        {
+            throw std::runtime_error("implicit_root: derivative of the function at the root is zero or not a number.");
+        }
+
+        Base fx = tapescript::passive_value(tapescript::cvalue(f_root));
+        value_type result = x - (f_root - fx) / df;
+        if (implicit_second_order_scope::active())
+        {
+            result -= (f(result) - fx) / df;
+        }
+        return result;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_implicit_hpp
@@ -0,0 +1,255 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file includes code from CppAD, a C++ algorithmic differentiation library
+distributed under multiple licenses. This distribution is under the terms of
+the Eclipse Public License Version 1.0, a copy of which is available at:
+
+https://www.eclipse.org/legal/epl-v10.html
+
+CppAD code included in this file is subject to copyright:
+
+Copyright (C) 2003-15 Bradley M. Bell
+*/
+
+#ifndef cl_tape_impl_ad_tape_inner_op_hpp
+#define cl_tape_impl_ad_tape_inner_op_hpp
+
+namespace CppAD { // BEGIN_CPPAD_NAMESPACE
+
+    /*
+    Arithmetic operations of the sweeps for tape_inner values.
+
+    The generic operations compute a new value, e.g. z[0] = x[0] * y[0] or
+    px[0] += pz[0] * y[0], and copy it to the Taylor or Partial row, so every
+    array operation of a sweep allocates and frees a temporary. Here the
+    results are written to the rows in place: zero order forward results
+    reuse the array storage of the Taylor row, and the reverse updates add
+    the products and quotients to the Partial rows lane by lane. Parameters
+    are used by reference instead of being copied.
+    */
+#define CL_TAPE_INNER_FORWARD_OP(Name, Assign, Left, Right)                                     \
+    template <class Array>                                                                      \
+    inline void forward_##Name##_op_0(                                                          \
+        size_t                          i_z,                                                    \
+        const addr_t*                   arg,                                                    \
+        const cl::tape_inner<Array>*    parameter,                                              \
+        size_t                          cap_order,                                              \
+        cl::tape_inner<Array>*          taylor)                                                 \
+    {                                                                                           \
+        cl::tapescript::Assign(taylor[i_z * cap_order], Left, Right);                           \
+    }
+
+#define CL_TAPE_INNER_PAR(i) parameter[arg[i]]
+#define CL_TAPE_INNER_VAR(i) taylor[arg[i] * cap_order]
+
+    CL_TAPE_INNER_FORWARD_OP(addvv, assign_sum, CL_TAPE_INNER_VAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(addpv, assign_sum, CL_TAPE_INNER_PAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(subvv, assign_difference, CL_TAPE_INNER_VAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(subpv, assign_difference, CL_TAPE_INNER_PAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(subvp, assign_difference, CL_TAPE_INNER_VAR(0), CL_TAPE_INNER_PAR(1))
+    CL_TAPE_INNER_FORWARD_OP(mulvv, assign_product, CL_TAPE_INNER_VAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(mulpv, assign_product, CL_TAPE_INNER_PAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(divvv, assign_quotient, CL_TAPE_INNER_VAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(divpv, assign_quotient, CL_TAPE_INNER_PAR(0), CL_TAPE_INNER_VAR(1))
+    CL_TAPE_INNER_FORWARD_OP(divvp, assign_quotient, CL_TAPE_INNER_VAR(0), CL_TAPE_INNER_PAR(1))
+
+#undef CL_TAPE_INNER_VAR
+#undef CL_TAPE_INNER_PAR
+#undef CL_TAPE_INNER_FORWARD_OP
+
+    // True if all orders of the partial are identically zero.
+    template <class Array>
+    inline bool tape_inner_skip(size_t d, const cl::tape_inner<Array>* pz)
+    {
+        bool skip(true);
+        for (size_t i_d = 0; i_d <= d; i_d++)
+        {
+            skip &= IdenticalZero(pz[i_d]);
+        }
+        return skip;
+    }
+
+    // Reverse mode partials of z = x * y.
+    template <class Array>
+    inline void reverse_mulvv_op(
+        size_t                          d,
+        size_t                          i_z,
+        const addr_t*                   arg,
+        const cl::tape_inner<Array>*    parameter,
+        size_t                          cap_order,
+        const cl::tape_inner<Array>*    taylor,
+        size_t                          nc_partial,
+        cl::tape_inner<Array>*          partial)
+    {
+        const cl::tape_inner<Array>* x = taylor + arg[0] * cap_order;
+        const cl::tape_inner<Array>* y = taylor + arg[1] * cap_order;
+
+        cl::tape_inner<Array>* px = partial + arg[0] * nc_partial;
+        cl::tape_inner<Array>* py = partial + arg[1] * nc_partial;
+        cl::tape_inner<Array>* pz = partial + i_z * nc_partial;
+
+        // If pz is zero, make sure this operation has no effect
+        // (zero times infinity or nan would be non-zero).
+        if (tape_inner_skip(d, pz))
+        {
+            return;
+        }
+
+        size_t j = d + 1;
+        while (j)
+        {
+            --j;
+            for (size_t k = 0; k <= j; k++)
+            {
+                cl::tapescript::add_product(px[j - k], pz[j], y[k]);
+                cl::tapescript::add_product(py[k], pz[j], x[j - k]);
+            }
+        }
+    }
+
+    // Reverse mode partials of z = p * y for the parameter p.
+    template <class Array>
+    inline void reverse_mulpv_op(
+        size_t                          d,
+        size_t                          i_z,
+        const addr_t*                   arg,
+        const cl::tape_inner<Array>*    parameter,
+        size_t                          cap_order,
+        const cl::tape_inner<Array>*    taylor,
+        size_t                          nc_partial,
+        cl::tape_inner<Array>*          partial)
+    {
+        const cl::tape_inner<Array>& x = parameter[arg[0]];
+
+        cl::tape_inner<Array>* py = partial + arg[1] * nc_partial;
+        cl::tape_inner<Array>* pz = partial + i_z * nc_partial;
+
+        size_t j = d + 1;
+        while (j)
+        {
+            --j;
+            cl::tapescript::add_product(py[j], pz[j], x);
+        }
+    }
+
+    // Reverse mode partials of z = x / y.
+    template <class Array>
+    inline void reverse_divvv_op(
+        size_t                          d,
+        size_t                          i_z,
+        const addr_t*                   arg,
+        const cl::tape_inner<Array>*    parameter,
+        size_t                          cap_order,
+        const cl::tape_inner<Array>*    taylor,
+        size_t                          nc_partial,
+        cl::tape_inner<Array>*          partial)
+    {
+        const cl::tape_inner<Array>* y = taylor + arg[1] * cap_order;
+        const cl::tape_inner<Array>* z = taylor + i_z * cap_order;
+
+        cl::tape_inner<Array>* px = partial + arg[0] * nc_partial;
+        cl::tape_inner<Array>* py = partial + arg[1] * nc_partial;
+        cl::tape_inner<Array>* pz = partial + i_z * nc_partial;
+
+        if (tape_inner_skip(d, pz))
+        {
+            return;
+        }
+
+        size_t j = d + 1;
+        while (j)
+        {
+            --j;
+            pz[j] /= y[0];
+            px[j] += pz[j];
+            for (size_t k = 1; k <= j; k++)
+            {
+                cl::tapescript::subtract_product(pz[j - k], pz[j], y[k]);
+                cl::tapescript::subtract_product(py[k], pz[j], z[j - k]);
+            }
+            cl::tapescript::subtract_product(py[0], pz[j], z[j]);
+        }
+    }
+
+    // Reverse mode partials of z = p / y for the parameter p.
+    template <class Array>
+    inline void reverse_divpv_op(
+        size_t                          d,
+        size_t                          i_z,
+        const addr_t*                   arg,
+        const cl::tape_inner<Array>*    parameter,
+        size_t                          cap_order,
+        const cl::tape_inner<Array>*    taylor,
+        size_t                          nc_partial,
+        cl::tape_inner<Array>*          partial)
+    {
+        const cl::tape_inner<Array>* y = taylor + arg[1] * cap_order;
+        const cl::tape_inner<Array>* z = taylor + i_z * cap_order;
+
+        cl::tape_inner<Array>* py = partial + arg[1] * nc_partial;
+        cl::tape_inner<Array>* pz = partial + i_z * nc_partial;
+
+        if (tape_inner_skip(d, pz))
+        {
+            return;
+        }
+
+        size_t j = d + 1;
+        while (j)
+        {
+            --j;
+            pz[j] /= y[0];
+            for (size_t k = 1; k <= j; k++)
+            {
+                cl::tapescript::subtract_product(pz[j - k], pz[j], y[k]);
+                cl::tapescript::subtract_product(py[k], pz[j], z[j - k]);
+            }
+            cl::tapescript::subtract_product(py[0], pz[j], z[j]);
+        }
+    }
+
+    // Reverse mode partials of z = x / p for the parameter p.
+    template <class Array>
+    inline void reverse_divvp_op(
+        size_t                          d,
+        size_t                          i_z,
+        const addr_t*                   arg,
+        const cl::tape_inner<Array>*    parameter,
+        size_t                          cap_order,
+        const cl::tape_inner<Array>*    taylor,
+        size_t                          nc_partial,
+        cl::tape_inner<Array>*          partial)
+    {
+        const cl::tape_inner<Array>& y = parameter[arg[1]];
+
+        cl::tape_inner<Array>* px = partial + arg[0] * nc_partial;
+        cl::tape_inner<Array>* pz = partial + i_z * nc_partial;
+
+        size_t j = d + 1;
+        while (j)
+        {
+            --j;
+            cl::tapescript::add_quotient(px[j], pz[j], y);
+        }
+    }
+
+} // END_CPPAD_NAMESPACE
+
+#endif // cl_tape_impl_ad_tape_inner_op_hpp
@@ -0,0 +1,155 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_jacobian_hpp
+#define cl_tape_impl_ad_tape_jacobian_hpp
+
+#include <vector>
+
+#include <cl/tape/impl/double.hpp>
+#include <cl/tape/impl/ad/tape_hessian.hpp>
+#include <cl/tape/impl/ad/tape_implicit.hpp>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Records f at the plain values xv of x on a tape of its own,
+        /// with X as independent variables and Y as dependent variables.</summary>
+        template <class Vector, class Function, class Base, class Result>
+        inline void record_function(Vector const& x, Function const& f
+            , std::vector<Base>& xv, std::vector<tape_wrapper<Base>>& X, Result& Y)
+        {
+            size_t n = x.size();
+            xv.resize(n);
+            X.resize(n);
+            for (size_t j = 0; j < n; j++)
+            {
+                xv[j] = passive_value(cvalue(x[j]));
+                X[j] = xv[j];
+            }
+
+            Independent(X);
+            try
+            {
+                Vector ax(x);
+                for (size_t j = 0; j < n; j++)
+                {
+                    ax[j] = X[j];
+                }
+                Y = f(ax);
+            }
+            catch (...)
+            {
+                CppAD::AD<Base>::abort_recording();
+                throw;
+            }
+        }
+    }
+
+    /// <summary>Jacobian of y = f(x) at the values of x, jac[i][j] = dy_i/dx_j.
+    ///
+    /// f is recorded once on its own tape with the plain values of x as
+    /// independent variables, then the Jacobian is computed by CppAD in
+    /// forward or reverse mode, whichever takes fewer sweeps. This replaces
+    /// one evaluation of f per bumped argument of a finite difference
+    /// Jacobian, e.g. in a least squares calibration, and gives the exact
+    /// derivatives. Vector is a random access container of tape_wrapper
+    /// with size(), f(Vector const&) returns a container of tape_wrapper with
+    /// begin() and end(), and jac is indexed as jac[i][j] and already has
+    /// the size of the Jacobian.
+    ///
+    /// As for tape_checkpoint, the function cannot be called while a tape
+    /// is recording on the calling thread.</summary>
+    template <class Matrix, class Vector, class Function>
+    inline void tape_jacobian(Matrix& jac, Vector const& x, Function const& f)
+    {
+        typedef typename Vector::value_type value_type;
+        typedef typename value_type::base_type base_type;
+
+        std::vector<base_type> xv;
+        std::vector<value_type> X;
+        Vector y;
+        tapescript::record_function(x, f, xv, X, y);
+
+        std::vector<value_type> Y(y.begin(), y.end());
+        tape_function<base_type> tf(X, Y);
+        std::vector<base_type> J = tf.Jacobian(xv);
+
+        size_t n = X.size();
+        size_t m = Y.size();
+        for (size_t i = 0; i < m; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                jac[i][j] = J[i * n + j];
+            }
+        }
+    }
+
+    /// <summary>First columns of the Hessian of the scalar y = f(x) at the
+    /// values of x, hes[i][j] = d2y/dx_i dx_j for every argument i and the
+    /// first columns arguments j.
+    ///
+    /// f is recorded once on its own tape as for tape_jacobian and each column
+    /// takes one forward over reverse sweep, see hessian_times. Ordering the
+    /// arguments so that only the first ones are needed as columns, e.g. the
+    /// parameters of a calibration followed by its market inputs, gives the
+    /// mixed derivatives without the sweeps of the other columns. Roots of
+    /// implicit_root are recorded in an implicit_second_order_scope.
+    /// f(Vector const&) returns a tape_wrapper and hes already has the size
+    /// of the columns. The function cannot be called while a tape
+    /// is recording on the calling thread.</summary>
+    template <class Matrix, class Vector, class Function>
+    inline void tape_hessian(Matrix& hes, Vector const& x, Function const& f, size_t columns)
+    {
+        typedef typename Vector::value_type value_type;
+        typedef typename value_type::base_type base_type;
+
+        std::vector<base_type> xv;
+        std::vector<value_type> X;
+        value_type y;
+        {
+            implicit_second_order_scope scope;
+            tapescript::record_function(x, f, xv, X, y);
+        }
+
+        std::vector<value_type> Y(1, y);
+        tape_function<base_type> tf(X, Y);
+        tf.Forward(0, xv);
+
+        size_t n = X.size();
+        std::vector<base_type> w(1, base_type(1.0));
+        std::vector<base_type> u(n, base_type(0.0));
+        for (size_t j = 0; j < columns; j++)
+        {
+            u[j] = base_type(1.0);
+            std::vector<base_type> column = hessian_times(tf, w, u);
+            u[j] = base_type(0.0);
+
+            for (size_t i = 0; i < n; i++)
+            {
+                hes[i][j] = column[i];
+            }
+        }
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_jacobian_hpp
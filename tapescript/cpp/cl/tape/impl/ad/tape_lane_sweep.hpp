@@ -0,0 +1,465 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_lane_sweep_hpp
+#define cl_tape_impl_ad_tape_lane_sweep_hpp
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <cl/tape/impl/worker_pool.hpp>
+#include <cl/tape/impl/inner/tape_inner.hpp>
+#include <cl/tape/impl/ad/tape_reverse.hpp>
+
+namespace cl
+{
+    /// <summary>Settings of the lane-parallel sweeps.</summary>
+    struct lane_options
+    {
+        lane_options(size_t lane_chunk = 4096, size_t num_threads = 0)
+            : lane_chunk_(lane_chunk)
+            , num_threads_(num_threads)
+        {}
+
+        // Number of lanes evaluated by one task.
+        size_t lane_chunk_;
+
+        // Number of threads, zero means std::thread::hardware_concurrency.
+        size_t num_threads_;
+    };
+
+    namespace tapescript
+    {
+        /// <summary>Number of lanes of the value, zero for a scalar.</summary>
+        template <class T>
+        inline size_t lane_count(T const&)
+        {
+            return 0;
+        }
+
+        template <class Array>
+        inline size_t lane_count(tape_inner<Array> const& val)
+        {
+            return val.is_array() ? val.size() : 0;
+        }
+
+        /// <summary>Copies lanes [begin, begin + count) of the value, scalars are copied as is.</summary>
+        template <class T>
+        inline void lane_slice(T const& val, size_t, size_t, T& result)
+        {
+            result = val;
+        }
+
+        template <class Array>
+        inline void lane_slice(tape_inner<Array> const& val, size_t begin, size_t count, tape_inner<Array>& result)
+        {
+            if (val.is_scalar())
+            {
+                result = val;
+                return;
+            }
+
+            if (!result.is_array() || result.size() != count)
+            {
+                result.resize(count);
+            }
+            result.mode_ = tape_inner<Array>::ArrayMode;
+            for (size_t i = 0; i < count; i++)
+            {
+                result.array_value_[i] = val.array_value_[begin + i];
+            }
+        }
+
+        /// <summary>Writes the value to lanes [begin, begin + count) of the result
+        /// which has the given number of lanes, scalar values are broadcast.</summary>
+        template <class T>
+        inline void lane_store(T const& val, size_t, size_t, size_t, T& result)
+        {
+            result = val;
+        }
+
+        template <class Array>
+        inline void lane_store(tape_inner<Array> const& val, size_t begin, size_t count, size_t lanes
+            , tape_inner<Array>& result)
+        {
+            if (!result.is_array() || result.size() != lanes)
+            {
+                result.resize(lanes);
+            }
+            result.mode_ = tape_inner<Array>::ArrayMode;
+            for (size_t i = 0; i < count; i++)
+            {
+                result.array_value_[begin + i] = val.element_at(i);
+            }
+        }
+    }
+
+    /// <summary>Sweeps of a function of tape_inner arrays split by lanes.
+    /// Lanes of array values are independent, each chunk of lanes is swept with
+    /// its own copy of the player and its own Taylor and Partial rows, and the
+    /// chunks are shared between the threads of tapescript::worker_pool.
+    /// Scalar rows are the same for all chunks, in the reverse sweep their
+    /// adjoints are summed over chunks.
+    /// Tapes with atomic functions or VecAD, which may mix lanes or
+    /// allocate from thread_alloc inside the sweep, are swept serially.</summary>
+    template <class Base>
+    class lane_sweep
+    {
+    public:
+        lane_sweep(CppAD::ADFun<Base>& f, lane_options const& options)
+            : f_(f)
+            , options_(options)
+            , lanes_(0)
+        {}
+
+        /// <summary>Forward mode of order q, the same as f.Forward(q, xq).</summary>
+        template <typename VectorBase>
+        VectorBase forward(size_t q, VectorBase const& xq)
+        {
+            using namespace CppAD;
+
+            size_t n = f_.ind_taddr_.size();
+            size_t m = f_.dep_taddr_.size();
+
+            CPPAD_ASSERT_KNOWN(
+                size_t(xq.size()) == n,
+                "lane_sweep::forward: xq.size() is not equal n"
+                );
+            CPPAD_ASSERT_KNOWN(
+                q == 0 || q <= f_.num_order_taylor_,
+                "lane_sweep::forward: number of Taylor coefficient orders stored"
+                " is less than q."
+                );
+
+            lanes_ = 0;
+            for (size_t j = 0; j < n && lanes_ != npos(); j++)
+            {
+                merge_lanes(tapescript::lane_count(xq[j]));
+            }
+            if (!is_parallel())
+            {
+                return f_.Forward(q, xq);
+            }
+
+            if ((f_.cap_order_taylor_ <= q) | (f_.num_direction_taylor_ != 1))
+            {
+                f_.num_order_taylor_ = q;
+                f_.capacity_order(std::max(q + 1, f_.cap_order_taylor_), 1);
+            }
+
+            size_t C = f_.cap_order_taylor_;
+            for (size_t j = 0; j < n; j++)
+            {
+                f_.taylor_[C * f_.ind_taddr_[j] + q] = xq[j];
+            }
+
+            size_t J = q + 1;
+            size_t num_var = f_.num_var_tape_;
+            size_t num_op = f_.play_.num_op_rec();
+            size_t num_chunk = chunk_count();
+
+            std::vector<CppAD::pod_vector<Base>> taylor(num_chunk);
+            std::vector<CppAD::pod_vector<bool>> cskip(num_chunk);
+            for (size_t c = 0; c < num_chunk; c++)
+            {
+                taylor[c].extend(num_var * J);
+                cskip[c].extend(num_op);
+            }
+
+            run([&](CppAD::player<Base>& play, size_t c, size_t begin, size_t count)
+            {
+                // lower orders of all variables and order q of independents are inputs
+                Base* tc = taylor[c].data();
+                for (size_t i = 0; i < num_var; i++)
+                {
+                    for (size_t k = 0; k < q; k++)
+                    {
+                        tapescript::lane_slice(f_.taylor_[C * i + k], begin, count, tc[J * i + k]);
+                    }
+                }
+                for (size_t j = 0; j < f_.ind_taddr_.size(); j++)
+                {
+                    size_t row = f_.ind_taddr_[j];
+                    tapescript::lane_slice(f_.taylor_[C * row + q], begin, count, tc[J * row + q]);
+                }
+
+                // values of PriOp are printed by the first chunk only
+                size_t compare_change_number = 0;
+                size_t compare_change_op_index = 0;
+                if (q == 0)
+                {
+                    forward0sweep(std::cout, c == 0, f_.ind_taddr_.size(), num_var, &play, J
+                        , tc, cskip[c].data(), f_.load_op_
+                        , 0, compare_change_number, compare_change_op_index);
+                }
+                else
+                {
+                    forward1sweep(std::cout, c == 0, q, q, f_.ind_taddr_.size(), num_var, &play, J
+                        , tc, cskip[c].data(), f_.load_op_
+                        , 0, compare_change_number, compare_change_op_index);
+                }
+            });
+
+            // gather order q, an operator is skipped only if it is skipped in every chunk
+            for (size_t i = 0; i < num_var; i++)
+            {
+                gather(taylor, J * i + q, f_.taylor_[C * i + q]);
+            }
+            for (size_t i_op = 0; i_op < num_op; i_op++)
+            {
+                bool skip = true;
+                for (size_t c = 0; c < num_chunk && skip; c++)
+                {
+                    skip = cskip[c][i_op];
+                }
+                f_.cskip_op_[i_op] = skip;
+            }
+
+            f_.compare_change_number_ = 0;
+            f_.compare_change_op_index_ = 0;
+            f_.num_order_taylor_ = q + 1;
+
+            VectorBase yq(m);
+            for (size_t i = 0; i < m; i++)
+            {
+                yq[i] = f_.taylor_[C * f_.dep_taddr_[i] + q];
+            }
+            return yq;
+        }
+
+        /// <summary>First order reverse mode, the same as f.Reverse(1, w).</summary>
+        template <typename VectorBase>
+        VectorBase reverse(VectorBase const& w)
+        {
+            using namespace CppAD;
+
+            size_t n = f_.ind_taddr_.size();
+            size_t m = f_.dep_taddr_.size();
+
+            CPPAD_ASSERT_KNOWN(
+                size_t(w.size()) == m,
+                "lane_sweep::reverse: w.size() is not equal m"
+                );
+            CPPAD_ASSERT_KNOWN(
+                f_.num_order_taylor_ >= 1 && f_.num_direction_taylor_ == 1,
+                "lane_sweep::reverse: zero order Taylor coefficients are not stored."
+                );
+
+            size_t C = f_.cap_order_taylor_;
+            size_t num_var = f_.num_var_tape_;
+
+            lanes_ = 0;
+            for (size_t i = 0; i < num_var && lanes_ != npos(); i++)
+            {
+                merge_lanes(tapescript::lane_count(f_.taylor_[C * i]));
+            }
+            for (size_t i = 0; i < m && lanes_ != npos(); i++)
+            {
+                merge_lanes(tapescript::lane_count(w[i]));
+            }
+            if (!is_parallel())
+            {
+                return f_.Reverse(1, w);
+            }
+
+            size_t num_chunk = chunk_count();
+
+            std::vector<CppAD::pod_vector<Base>> taylor(num_chunk);
+            std::vector<CppAD::pod_vector<Base>> partial(num_chunk);
+            for (size_t c = 0; c < num_chunk; c++)
+            {
+                taylor[c].extend(num_var);
+                partial[c].extend(num_var);
+            }
+
+            run([&](CppAD::player<Base>& play, size_t c, size_t begin, size_t count)
+            {
+                Base* tc = taylor[c].data();
+                Base* pc = partial[c].data();
+                for (size_t i = 0; i < num_var; i++)
+                {
+                    tapescript::lane_slice(f_.taylor_[C * i], begin, count, tc[i]);
+                    tapescript::reset_partial(pc[i], tc[i]);
+                }
+
+                // scalar dependents do not depend on lanes and are seeded in the first chunk
+                for (size_t i = 0; i < m; i++)
+                {
+                    size_t row = f_.dep_taddr_[i];
+                    if (tapescript::lane_count(tc[row]) || c == 0)
+                    {
+                        Base wc;
+                        tapescript::lane_slice(w[i], begin, count, wc);
+                        pc[row] += wc;
+                    }
+                }
+
+                ReverseSweep(0, f_.ind_taddr_.size(), num_var, &play, 1
+                    , tc, 1, pc, f_.cskip_op_.data(), f_.load_op_, getarg<1>(w));
+            });
+
+            VectorBase dw(n);
+            for (size_t j = 0; j < n; j++)
+            {
+                size_t row = f_.ind_taddr_[j];
+                if (tapescript::lane_count(f_.taylor_[C * row]))
+                {
+                    gather(partial, row, dw[j]);
+                }
+                else
+                {
+                    // adjoint of a scalar is the sum of its lane adjoints
+                    dw[j] = partial[0][row];
+                    for (size_t c = 1; c < num_chunk; c++)
+                    {
+                        dw[j] += partial[c][row];
+                    }
+                }
+                tapescript::set_not_intrusive(dw[j]);
+            }
+            return dw;
+        }
+
+        /// <summary>Number of lanes of the last sweep, zero if it was serial.</summary>
+        size_t lanes() const
+        {
+            return lanes_ == npos() ? 0 : lanes_;
+        }
+
+    private:
+        lane_sweep(lane_sweep const&);
+        lane_sweep& operator=(lane_sweep const&);
+
+        static size_t npos()
+        {
+            return size_t(-1);
+        }
+
+        // Arrays of different sizes are not split.
+        void merge_lanes(size_t count)
+        {
+            if (count == 0 || lanes_ == npos())
+            {
+                return;
+            }
+            lanes_ = lanes_ == 0 || lanes_ == count ? count : npos();
+        }
+
+        bool is_parallel()
+        {
+            for (size_t i = 0; i < f_.play_.num_par_rec() && lanes_ != npos(); i++)
+            {
+                size_t count = tapescript::lane_count(f_.play_.par_rec_[i]);
+                if (count && lanes_)
+                {
+                    merge_lanes(count);
+                }
+            }
+
+            bool parallel = lanes_ != npos()
+                && lanes_ > std::max<size_t>(options_.lane_chunk_, 1)
+                && f_.play_.num_vec_ind_rec() == 0;
+
+            for (size_t i_op = 0; i_op < f_.play_.num_op_rec() && parallel; i_op++)
+            {
+                parallel = f_.play_.GetOp(i_op) != CppAD::UserOp;
+            }
+
+            if (!parallel)
+            {
+                lanes_ = npos();
+            }
+            return parallel;
+        }
+
+        size_t chunk_count() const
+        {
+            size_t chunk = std::max<size_t>(options_.lane_chunk_, 1);
+            return (lanes_ + chunk - 1) / chunk;
+        }
+
+        // Copies lanes of the chunk rows into the result row.
+        void gather(std::vector<CppAD::pod_vector<Base>> const& rows, size_t index, Base& result)
+        {
+            size_t chunk = std::max<size_t>(options_.lane_chunk_, 1);
+            bool is_array = false;
+            for (size_t c = 0; c < rows.size() && !is_array; c++)
+            {
+                is_array = tapescript::lane_count(rows[c][index]) != 0;
+            }
+
+            if (!is_array)
+            {
+                result = rows[0][index];
+                return;
+            }
+
+            for (size_t c = 0; c < rows.size(); c++)
+            {
+                size_t begin = c * chunk;
+                tapescript::lane_store(rows[c][index], begin, std::min(chunk, lanes_ - begin), lanes_, result);
+            }
+        }
+
+        // Runs the task for every chunk on the shared worker pool, each thread
+        // has its own copy of the player with array parameters sliced to the
+        // lanes of the chunk.
+        template <typename Task>
+        void run(Task task)
+        {
+            size_t chunk = std::max<size_t>(options_.lane_chunk_, 1);
+            size_t num_chunk = chunk_count();
+            size_t num_threads = options_.num_threads_
+                ? options_.num_threads_ : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+            num_threads = std::min(num_threads, num_chunk);
+
+            // players are copied by this thread because pod_vector memory
+            // comes from thread_alloc which is not set up for parallel mode
+            std::vector<CppAD::player<Base>> play(num_threads);
+            for (size_t t = 0; t < num_threads; t++)
+            {
+                play[t] = f_.play_;
+            }
+
+            auto work = [&](size_t t)
+            {
+                for (size_t c = t; c < num_chunk; c += num_threads)
+                {
+                    size_t begin = c * chunk;
+                    size_t count = std::min(chunk, lanes_ - begin);
+                    for (size_t i = 0; i < f_.play_.num_par_rec(); i++)
+                    {
+                        tapescript::lane_slice(f_.play_.par_rec_[i], begin, count, play[t].par_rec_[i]);
+                    }
+                    task(play[t], c, begin, count);
+                }
+            };
+
+            tapescript::worker_pool::instance().run(num_threads, work);
+        }
+
+        CppAD::ADFun<Base>& f_;
+        lane_options options_;
+        size_t lanes_;
+    };
+}
+
+#endif // cl_tape_impl_ad_tape_lane_sweep_hpp
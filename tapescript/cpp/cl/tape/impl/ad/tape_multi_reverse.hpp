@@ -0,0 +1,263 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_multi_reverse_hpp
+#define cl_tape_impl_ad_tape_multi_reverse_hpp
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <cl/tape/impl/inner/tape_inner.hpp>
+#include <cl/tape/impl/ad/tape_reverse.hpp>
+
+namespace cl
+{
+    /// <summary>Number of directions propagated by one sweep of multi_reverse.</summary>
+    template <class Array>
+    struct multi_reverse_width
+    {
+        // std::valarray lanes are sized at run time, all directions go in one sweep.
+        static size_t get(size_t directions)
+        {
+            return directions;
+        }
+    };
+
+    template <class Scalar, size_t N>
+    struct multi_reverse_width<lanes<Scalar, N>>
+    {
+        static size_t get(size_t)
+        {
+            return N;
+        }
+    };
+
+    /// <summary>First order reverse mode for several weight vectors at once.
+    /// The operation sequence of a scalar tape is copied to a tape over
+    /// tape_inner<Array>, its Taylor coefficients stay scalar and the adjoints
+    /// carry one direction per lane. One sweep then returns the derivatives
+    /// of a block of weighted sums, e.g. a block of Jacobian rows.
+    /// With lanes<Scalar, N> the directions are swept N at a time without
+    /// allocations, with std::valarray all of them in one sweep, whose lane
+    /// buffers are kept by the object for the next sweep.
+    /// Tapes with atomic operations (checkpoints) are not supported.</summary>
+    template <class Base, class Array = tape_array>
+    class multi_reverse
+    {
+    public:
+        typedef tape_inner<Array> inner_type;
+        typedef typename inner_type::array_type array_type;
+
+        /// <summary>Copies the operation sequence of f. If f holds zero order
+        /// coefficients they are recomputed at the same independent values.</summary>
+        explicit multi_reverse(tape_function_base<Base> const& f)
+            : g_()
+            , partial_()
+            , buffers_()
+        {
+            copy(f);
+
+            if (f.num_order_taylor_ > 0)
+            {
+                std::vector<Base> x0(f.ind_taddr_.size());
+                for (size_t j = 0; j < x0.size(); j++)
+                {
+                    x0[j] = f.taylor_[f.ind_taddr_[j] * f.cap_order_taylor_];
+                }
+                forward(x0);
+            }
+        }
+
+        /// <summary>Number of independent variables.</summary>
+        size_t domain() const
+        {
+            return g_.Domain();
+        }
+
+        /// <summary>Number of dependent variables.</summary>
+        size_t range() const
+        {
+            return g_.Range();
+        }
+
+        /// <summary>Zero order forward mode at x, sets the point of the derivatives.</summary>
+        void forward(std::vector<Base> const& x)
+        {
+            typename tapescript::lane_buffer_pool<Array>::scope buffers(buffers_);
+            std::vector<inner_type> ax(x.begin(), x.end());
+            g_.Forward(0, ax);
+        }
+
+        /// <summary>Derivatives of the weighted sums w_k^T y with respect to x
+        /// for k = 0, ..., K - 1. Direction k is stored at w[k * m + i] and the
+        /// result, an n x K block, at dw[j * K + k].</summary>
+        std::vector<Base> reverse(std::vector<Base> const& w, size_t K)
+        {
+            size_t n = domain();
+            size_t m = range();
+            if (w.size() != m * K)
+            {
+                throw std::runtime_error("Weights do not have K times the range size.");
+            }
+
+            typename tapescript::lane_buffer_pool<Array>::scope buffers(buffers_);
+            std::vector<Base> dw(n * K);
+            size_t width = multi_reverse_width<Array>::get(K);
+            std::vector<inner_type> aw(m);
+            for (size_t k0 = 0; k0 < K; k0 += width)
+            {
+                size_t count = std::min(width, K - k0);
+
+                // Unused lanes of the last block have zero weights.
+                for (size_t i = 0; i < m; i++)
+                {
+                    array_type lane_w = inner_type::traits::get_const(width, Base(0));
+                    for (size_t k = 0; k < count; k++)
+                    {
+                        lane_w[k] = w[(k0 + k) * m + i];
+                    }
+                    aw[i] = inner_type(std::move(lane_w));
+                }
+
+                sweep(aw);
+
+                for (size_t j = 0; j < n; j++)
+                {
+                    // An adjoint which no direction reaches stays a scalar zero.
+                    inner_type const& adw = partial_[g_.ind_taddr_[j]];
+                    for (size_t k = 0; k < count; k++)
+                    {
+                        dw[j * K + k0 + k] = adw.is_scalar()
+                            ? adw.scalar_value_ : adw.array_value_[k];
+                    }
+                }
+            }
+            return dw;
+        }
+
+    private:
+        // First order reverse sweep with the lanes of the weights kept apart.
+        // ADFun::Reverse sums the lanes of partials whose Taylor coefficient is
+        // a scalar, as a scalar argument of an array calculation requires,
+        // here every partial starts as a plain scalar zero instead.
+        void sweep(std::vector<inner_type> const& aw)
+        {
+            CPPAD_ASSERT_KNOWN(
+                g_.num_order_taylor_ >= 1,
+                "multi_reverse: forward has to be called before reverse."
+                );
+
+            if (partial_.size() != g_.num_var_tape_)
+            {
+                partial_.free();
+                partial_.extend(g_.num_var_tape_);
+            }
+            for (size_t i = 0; i < partial_.size(); i++)
+            {
+                // Array storage of the row is kept for the next accumulation.
+                partial_[i].mode_ = inner_type::ScalarMode;
+                partial_[i].scalar_value_ = typename inner_type::scalar_type(0);
+            }
+
+            // (use += because two dependent variables can point to same location)
+            for (size_t i = 0; i < aw.size(); i++)
+            {
+                partial_[g_.dep_taddr_[i]] += aw[i];
+            }
+
+            CppAD::ReverseSweep(
+                0,
+                g_.ind_taddr_.size(),
+                g_.num_var_tape_,
+                &g_.play_,
+                g_.cap_order_taylor_,
+                g_.taylor_.data(),
+                1,
+                partial_.data(),
+                g_.cskip_op_.data(),
+                g_.load_op_,
+                CppAD::getarg<1>(aw)
+                );
+        }
+
+        // Copies the operation sequence with the parameters as scalar inner values,
+        // the function state is set as Dependent does.
+        void copy(tape_function_base<Base> const& f)
+        {
+            CppAD::player<Base> const& play = f.play_;
+            CppAD::player<inner_type>& inner_play = g_.play_;
+
+            for (size_t i = 0; i < play.op_rec_.size(); i++)
+            {
+                if (CppAD::OpCode(play.op_rec_[i]) == CppAD::UserOp)
+                {
+                    throw std::runtime_error("Reverse mode for several directions does not support atomic operations.");
+                }
+            }
+
+            inner_play.num_var_rec_ = play.num_var_rec_;
+            inner_play.num_load_op_rec_ = play.num_load_op_rec_;
+            inner_play.num_vecad_vec_rec_ = play.num_vecad_vec_rec_;
+            inner_play.op_rec_ = play.op_rec_;
+            inner_play.vecad_ind_rec_ = play.vecad_ind_rec_;
+            inner_play.op_arg_rec_ = play.op_arg_rec_;
+            inner_play.text_rec_ = play.text_rec_;
+
+            inner_play.par_rec_.erase();
+            inner_play.par_rec_.extend(play.par_rec_.size());
+            for (size_t i = 0; i < play.par_rec_.size(); i++)
+            {
+                inner_play.par_rec_[i] = inner_type(play.par_rec_[i]);
+            }
+
+            g_.has_been_optimized_ = f.has_been_optimized_;
+            g_.compare_change_count_ = 0;
+            g_.compare_change_number_ = 0;
+            g_.compare_change_op_index_ = 0;
+            g_.num_order_taylor_ = 0;
+            g_.num_direction_taylor_ = 0;
+            g_.cap_order_taylor_ = 0;
+            g_.num_var_tape_ = f.num_var_tape_;
+            g_.taylor_.erase();
+            g_.cskip_op_.erase();
+            g_.cskip_op_.extend(play.op_rec_.size());
+            g_.load_op_.erase();
+            g_.load_op_.extend(play.num_load_op_rec_);
+
+            g_.ind_taddr_.resize(f.ind_taddr_.size());
+            g_.ind_taddr_ = f.ind_taddr_;
+            g_.dep_taddr_.resize(f.dep_taddr_.size());
+            g_.dep_taddr_ = f.dep_taddr_;
+            g_.dep_parameter_.resize(f.dep_parameter_.size());
+            g_.dep_parameter_ = f.dep_parameter_;
+        }
+
+        tape_function_base<inner_type> g_;
+
+        // Partial matrix of the last sweep, one row per variable.
+        CppAD::pod_vector<inner_type> partial_;
+
+        // Lane buffers of the sweeps.
+        tapescript::lane_buffer_pool<Array> buffers_;
+    };
+}
+
+#endif // cl_tape_impl_ad_tape_multi_reverse_hpp
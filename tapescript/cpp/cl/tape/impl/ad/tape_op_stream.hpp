@@ -0,0 +1,135 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_op_stream_hpp
+#define cl_tape_impl_ad_tape_op_stream_hpp
+
+#include <cmath>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Arguments of the operation which follows op with the arguments arg
+        /// in the recorded operation sequence.</summary>
+        inline CppAD::addr_t const* next_op_arg(CppAD::OpCode op, CppAD::addr_t const* arg)
+        {
+            // CSumOp and CSkipOp have a variable number of arguments.
+            if (op == CppAD::CSumOp)
+            {
+                return arg + arg[0] + arg[1] + 4;
+            }
+            if (op == CppAD::CSkipOp)
+            {
+                return arg + 7 + arg[4] + arg[5];
+            }
+            return arg + CppAD::NumArg(op);
+        }
+
+        /// <summary>Calls visit(op, arg, i_var) for every recorded operation in the
+        /// order of the tape, i_var is the index of its primary (last) result as in
+        /// player::forward_next.</summary>
+        template <class Base, class Visit>
+        inline void for_each_op(CppAD::player<Base> const& play, Visit visit)
+        {
+            CppAD::addr_t const* arg = play.op_arg_rec_.data();
+            size_t num_op = play.num_op_rec();
+            size_t i_var = 0;
+            for (size_t i_op = 0; i_op < num_op; i_op++)
+            {
+                CppAD::OpCode op = CppAD::OpCode(play.op_rec_[i_op]);
+                if (i_op > 0)
+                {
+                    i_var += CppAD::NumRes(op);
+                }
+                visit(op, arg, i_var);
+                arg = next_op_arg(op, arg);
+            }
+        }
+
+        /// <summary>Sign of x as a value of its type.</summary>
+        template <class Value>
+        inline Value unary_sign(Value const& x)
+        {
+            return Value((x > 0) - (x < 0));
+        }
+
+        /// <summary>Value of the unary operation op at x. Value is a native type,
+        /// or a type with the math functions found by argument dependent lookup,
+        /// e.g. the C expressions of code generation.</summary>
+        template <class Value>
+        inline Value unary_op_value(CppAD::OpCode op, Value const& x)
+        {
+            using namespace CppAD;
+            using std::fabs; using std::exp; using std::log; using std::sqrt;
+            using std::sin; using std::cos; using std::tan; using std::asin; using std::acos; using std::atan;
+            using std::sinh; using std::cosh; using std::tanh; using std::erf;
+
+            switch (op)
+            {
+            case AbsOp: return fabs(x);
+            case SignOp: return unary_sign(x);
+            case ExpOp: return exp(x);
+            case LogOp: return log(x);
+            case SqrtOp: return sqrt(x);
+            case SinOp: return sin(x);
+            case CosOp: return cos(x);
+            case TanOp: return tan(x);
+            case AsinOp: return asin(x);
+            case AcosOp: return acos(x);
+            case AtanOp: return atan(x);
+            case SinhOp: return sinh(x);
+            case CoshOp: return cosh(x);
+            case TanhOp: return tanh(x);
+            default: return erf(x);
+            }
+        }
+
+        /// <summary>Derivative of the unary operation op at x with the value z,
+        /// c is the parameter 2 / sqrt(pi) of ErfOp.</summary>
+        template <class Value>
+        inline Value unary_op_derivative(CppAD::OpCode op, Value const& x, Value const& z, Value const& c)
+        {
+            using namespace CppAD;
+            using std::exp; using std::sqrt; using std::sin; using std::cos; using std::sinh; using std::cosh;
+
+            switch (op)
+            {
+            case AbsOp: return unary_sign(x);
+            case SignOp: return Value(0.0);
+            case ExpOp: return z;
+            case LogOp: return Value(1.0) / x;
+            case SqrtOp: return Value(0.5) / z;
+            case SinOp: return cos(x);
+            case CosOp: return -sin(x);
+            case TanOp: return Value(1.0) + z * z;
+            case AsinOp: return Value(1.0) / sqrt(Value(1.0) - x * x);
+            case AcosOp: return Value(-1.0) / sqrt(Value(1.0) - x * x);
+            case AtanOp: return Value(1.0) / (Value(1.0) + x * x);
+            case SinhOp: return cosh(x);
+            case CoshOp: return sinh(x);
+            case TanhOp: return Value(1.0) - z * z;
+            default: return c * exp(-x * x);
+            }
+        }
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_op_stream_hpp
@@ -0,0 +1,101 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_optimize_hpp
+#define cl_tape_impl_ad_tape_optimize_hpp
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <cl/tape/impl/ad/tape_arena.hpp>
+
+namespace cl
+{
+    /// <summary>Sizes of an operation sequence before and after optimization.</summary>
+    struct tape_optimize_stats
+    {
+        tape_optimize_stats()
+            : before_()
+            , after_()
+        {}
+
+        /// <summary>Number of operators removed by the optimization.</summary>
+        size_t removed_ops() const
+        {
+            return before_.num_op_ - after_.num_op_;
+        }
+
+        /// <summary>Number of variables removed by the optimization.</summary>
+        size_t removed_vars() const
+        {
+            return before_.num_var_ - after_.num_var_;
+        }
+
+        // Sizes of the recorded operation sequence.
+        tape_capacity before_;
+        // Sizes of the optimized operation sequence.
+        tape_capacity after_;
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, tape_optimize_stats const& stats)
+    {
+        return os << "operators: " << stats.before_.num_op_ << " -> " << stats.after_.num_op_
+            << ", variables: " << stats.before_.num_var_ << " -> " << stats.after_.num_var_
+            << ", parameters: " << stats.before_.num_par_ << " -> " << stats.after_.num_par_;
+    }
+
+    /// <summary>Optimizes the operation sequence stored in f. Operators which do not
+    /// affect the dependent variables are removed, identical operators on the same
+    /// arguments are merged, chains of additions and subtractions are fused into
+    /// cumulative sums (CSumOp) and the branches of conditional expressions are
+    /// skipped when not selected (CSkipOp, disabled by the "no_conditional_skip" option).
+    /// Operations on parameters only are folded to constants at recording already.
+    /// The optimized sequence is evaluated by the TapeScript sweeps, with tape_inner
+    /// bases a branch is skipped only if every lane selects the other one.
+    /// Zero order coefficients held by f are recomputed at the same independent values.</summary>
+    template <class Base>
+    inline tape_optimize_stats optimize(tape_function_base<Base>& f, std::string const& options = "")
+    {
+        tape_optimize_stats stats;
+        stats.before_ = tape_size(f);
+
+        std::vector<Base> x0;
+        if (f.num_order_taylor_ > 0)
+        {
+            x0.resize(f.ind_taddr_.size());
+            for (size_t j = 0; j < x0.size(); j++)
+            {
+                x0[j] = f.taylor_[f.ind_taddr_[j] * f.cap_order_taylor_];
+            }
+        }
+
+        f.optimize(options);
+        stats.after_ = tape_size(f);
+
+        if (!x0.empty())
+        {
+            f.Forward(0, x0);
+        }
+        return stats;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_optimize_hpp
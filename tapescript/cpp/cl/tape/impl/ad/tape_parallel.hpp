@@ -0,0 +1,264 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_parallel_hpp
+#define cl_tape_impl_ad_tape_parallel_hpp
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include <cl/tape/impl/double.hpp>
+#include <cl/tape/impl/thread_local.hpp>
+#include <cl/tape/impl/worker_pool.hpp>
+
+namespace cl
+{
+    /// <summary>Settings of the parallel portfolio recording.</summary>
+    struct parallel_options
+    {
+        parallel_options(size_t shard_size = 64, size_t num_threads = 0)
+            : shard_size_(shard_size)
+            , num_threads_(num_threads)
+        {}
+
+        // Number of instruments recorded on one tape. Shards do not depend
+        // on the number of threads, so neither do the summed results.
+        size_t shard_size_;
+
+        // Number of threads, zero means std::thread::hardware_concurrency.
+        // CppAD keeps at most CPPAD_MAX_NUM_THREADS tapes, define it before
+        // including tape.hpp to use more threads.
+        size_t num_threads_;
+    };
+
+    /// <summary>Value and gradient of a portfolio with respect to its market inputs.</summary>
+    template <class Base>
+    struct portfolio_risk
+    {
+        portfolio_risk()
+            : value_()
+            , gradient_()
+            , shards_(0)
+        {}
+
+        // Sum of the instrument values.
+        Base value_;
+
+        // Derivatives of the value with respect to the market inputs.
+        std::vector<Base> gradient_;
+
+        // Number of tapes recorded.
+        size_t shards_;
+    };
+
+    namespace tapescript
+    {
+        /// <summary>Thread numbering of CppAD in parallel mode. The calling thread
+        /// is number zero, the workers are numbered when they start.</summary>
+        struct parallel_mode
+        {
+            static size_t& thread_index()
+            {
+                static CL_THREAD_LOCAL size_t index = 0;
+                return index;
+            }
+
+            static std::atomic<bool>& active()
+            {
+                static std::atomic<bool> value(false);
+                return value;
+            }
+
+            static bool in_parallel()
+            {
+                return active();
+            }
+
+            static size_t thread_num()
+            {
+                return thread_index();
+            }
+        };
+
+        /// <summary>Sets up thread_alloc and the AD<Base> tapes for the given number
+        /// of threads and restores sequential mode on destruction. Memory held
+        /// by the worker threads is freed by the destructor.</summary>
+        template <class Base>
+        class parallel_scope
+        {
+        public:
+            explicit parallel_scope(size_t num_threads)
+                : num_threads_(num_threads)
+            {
+                if (CppAD::thread_alloc::num_threads() != 1)
+                {
+                    throw std::runtime_error("parallel_scope: parallel mode is already set up.");
+                }
+
+                CppAD::thread_alloc::parallel_setup(num_threads_
+                    , &parallel_mode::in_parallel, &parallel_mode::thread_num);
+                CppAD::parallel_ad<Base>();
+                parallel_mode::active() = true;
+            }
+
+            ~parallel_scope()
+            {
+                parallel_mode::active() = false;
+                for (size_t t = 1; t < num_threads_; t++)
+                {
+                    CppAD::thread_alloc::free_available(t);
+                }
+                CppAD::thread_alloc::parallel_setup(1, 0, 0);
+
+                // frees the tape tables of the worker threads
+                CppAD::parallel_ad<Base>();
+            }
+
+        private:
+            parallel_scope(parallel_scope const&);
+            parallel_scope& operator=(parallel_scope const&);
+
+            size_t num_threads_;
+        };
+    }
+
+    /// <summary>Value and gradient of a portfolio priced from the market inputs x.
+    /// Instruments are split into shards of options.shard_size_ consecutive
+    /// instruments. Every shard is recorded on its own tape against its own copy
+    /// of the market inputs, then swept in reverse, by the thread which recorded
+    /// it. The first shard is recorded before parallel mode is set up, the
+    /// others are shared between the threads of tapescript::worker_pool, and
+    /// the shard values and gradients are summed in the order of the shards,
+    /// so the result does not depend on the number of threads or on their
+    /// scheduling.
+    ///
+    /// The pricer has the signature tape_wrapper<Base>(std::vector<tape_wrapper<Base>> const& x, size_t i)
+    /// and returns the value of instrument i, it is called concurrently and must
+    /// not share mutable state between instruments. Atomic functions (e.g.
+    /// tape_checkpoint) must be created before the call, and no tape may be
+    /// recording on the calling thread.</summary>
+    template <class Base, class Pricer>
+    inline portfolio_risk<Base>
+    parallel_portfolio_risk(std::vector<Base> const& x, size_t num_instruments, Pricer pricer
+        , parallel_options const& options = parallel_options())
+    {
+        typedef tape_wrapper<Base> value_type;
+
+        size_t n = x.size();
+        size_t shard_size = std::max<size_t>(options.shard_size_, 1);
+        size_t num_shards = (num_instruments + shard_size - 1) / shard_size;
+        size_t num_threads = options.num_threads_
+            ? options.num_threads_ : std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+        num_threads = std::max<size_t>(std::min<size_t>(std::min<size_t>(num_threads, num_shards), CPPAD_MAX_NUM_THREADS), 1);
+
+        std::vector<Base> values(num_shards);
+        std::vector<std::vector<Base>> gradients(num_shards);
+        std::vector<std::exception_ptr> errors(num_threads);
+        std::atomic<size_t> next_shard(0);
+
+        auto record = [&](size_t s)
+        {
+            std::vector<value_type> X(x.begin(), x.end());
+            Independent(X);
+
+            std::vector<value_type> Y(1, value_type(0.0));
+            size_t end = std::min(num_instruments, (s + 1) * shard_size);
+            for (size_t i = s * shard_size; i < end; i++)
+            {
+                Y[0] += pricer(X, i);
+            }
+
+            // the recording leaves the zero order coefficients at x in f
+            tape_function<Base> f(X, Y);
+            values[s] = CppAD::Value(Y[0].value());
+            gradients[s] = f.Reverse(1, std::vector<Base>(1, Base(1.0)));
+        };
+
+        auto work = [&](size_t t)
+        {
+            tapescript::parallel_mode::thread_index() = t;
+            try
+            {
+                for (size_t s = next_shard++; s < num_shards; s = next_shard++)
+                {
+                    record(s);
+                }
+            }
+            catch (...)
+            {
+                CppAD::AD<Base>::abort_recording();
+                errors[t] = std::current_exception();
+                next_shard = num_shards;
+            }
+        };
+
+        if (num_threads == 1)
+        {
+            work(0);
+        }
+        else
+        {
+            // The first shard is recorded in sequential mode, CppAD initializes
+            // the static variables of the recording and sweep code on first use.
+            try
+            {
+                record(next_shard++);
+            }
+            catch (...)
+            {
+                CppAD::AD<Base>::abort_recording();
+                throw;
+            }
+
+            tapescript::parallel_scope<Base> scope(num_threads);
+
+            tapescript::worker_pool::instance().run(num_threads, work);
+        }
+
+        for (auto const& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        // deterministic reduction in the order of the shards
+        portfolio_risk<Base> result;
+        result.value_ = Base(0.0);
+        result.gradient_.assign(n, Base(0.0));
+        result.shards_ = num_shards;
+        for (size_t s = 0; s < num_shards; s++)
+        {
+            result.value_ += values[s];
+            for (size_t j = 0; j < n; j++)
+            {
+                result.gradient_[j] += gradients[s][j];
+            }
+        }
+        return result;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_parallel_hpp
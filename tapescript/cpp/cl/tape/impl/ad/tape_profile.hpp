@@ -0,0 +1,362 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_profile_hpp
+#define cl_tape_impl_ad_tape_profile_hpp
+
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+
+#include <cl/tape/impl/thread_local.hpp>
+
+namespace cl
+{
+    /// <summary>Bytes held by the buffers of a recorded function.</summary>
+    struct tape_memory
+    {
+        tape_memory()
+            : op_(0)
+            , op_arg_(0)
+            , par_(0)
+            , text_(0)
+            , vecad_(0)
+            , taylor_(0)
+            , cskip_(0)
+            , load_op_(0)
+            , sparsity_(0)
+        {}
+
+        size_t total() const
+        {
+            return op_ + op_arg_ + par_ + text_ + vecad_ + taylor_ + cskip_ + load_op_ + sparsity_;
+        }
+
+        // Operation codes.
+        size_t op_;
+        // Operation arguments.
+        size_t op_arg_;
+        // Parameters, sizeof(Base) each, array storage of tape_inner values is not counted.
+        size_t par_;
+        // Text of PriOp operations, including tags.
+        size_t text_;
+        // VecAD indices.
+        size_t vecad_;
+        // Taylor coefficients of all variables, orders and directions.
+        size_t taylor_;
+        // Flags of the skipped operations.
+        size_t cskip_;
+        // Variables of the VecAD loads.
+        size_t load_op_;
+        // Forward Jacobian sparsity kept by the function.
+        size_t sparsity_;
+    };
+
+    /// <summary>Operations attributed to a tag of the recording.</summary>
+    struct tape_tag_stats
+    {
+        tape_tag_stats()
+            : scopes_(0)
+            , num_op_(0)
+            , num_var_(0)
+            , inclusive_op_(0)
+            , inclusive_var_(0)
+        {}
+
+        // Number of tag scopes with this name.
+        size_t scopes_;
+        // Operations and variables recorded in the scopes but not in nested tags.
+        size_t num_op_;
+        size_t num_var_;
+        // Operations and variables recorded in the scopes including nested tags.
+        size_t inclusive_op_;
+        size_t inclusive_var_;
+    };
+
+    /// <summary>Operation counts, buffer sizes and tag attribution of a recorded function.</summary>
+    struct tape_statistics
+    {
+        tape_statistics()
+            : op_count_(CppAD::NumberOp, 0)
+            , num_op_(0)
+            , num_var_(0)
+            , num_par_(0)
+            , memory_()
+            , tags_()
+        {}
+
+        /// <summary>Name of the operation code.</summary>
+        static const char* op_name(size_t op)
+        {
+            return CppAD::OpName(CppAD::OpCode(op));
+        }
+
+        /// <summary>Writes the counts by operation, the memory and the tags
+        /// in the order of decreasing number of operations.</summary>
+        void write(std::ostream& out) const
+        {
+            out << "operations: " << num_op_
+                << ", variables: " << num_var_
+                << ", parameters: " << num_par_
+                << ", bytes: " << memory_.total() << "\n";
+
+            out << "memory:"
+                << " op " << memory_.op_
+                << ", op_arg " << memory_.op_arg_
+                << ", par " << memory_.par_
+                << ", text " << memory_.text_
+                << ", vecad " << memory_.vecad_
+                << ", taylor " << memory_.taylor_
+                << ", cskip " << memory_.cskip_
+                << ", load_op " << memory_.load_op_
+                << ", sparsity " << memory_.sparsity_ << "\n";
+
+            std::vector<std::pair<size_t, size_t>> ops;
+            for (size_t op = 0; op < op_count_.size(); op++)
+            {
+                if (op_count_[op])
+                {
+                    ops.push_back(std::make_pair(op_count_[op], op));
+                }
+            }
+            std::sort(ops.rbegin(), ops.rend());
+            for (auto const& op : ops)
+            {
+                out << std::setw(10) << op.first << "  " << op_name(op.second) << "\n";
+            }
+
+            std::vector<std::pair<size_t, std::string>> tags;
+            for (auto const& tag : tags_)
+            {
+                tags.push_back(std::make_pair(tag.second.num_op_, tag.first));
+            }
+            std::sort(tags.rbegin(), tags.rend());
+            for (auto const& tag : tags)
+            {
+                tape_tag_stats const& stats = tags_.find(tag.second)->second;
+                out << std::setw(10) << stats.num_op_
+                    << std::setw(10) << stats.inclusive_op_
+                    << std::setw(8) << stats.scopes_
+                    << "  " << (tag.second.empty() ? "(untagged)" : tag.second) << "\n";
+            }
+        }
+
+        // Number of operations by CppAD::OpCode.
+        std::vector<size_t> op_count_;
+        size_t num_op_;
+        size_t num_var_;
+        size_t num_par_;
+        tape_memory memory_;
+        // Attribution by tag name, operations outside of tags are under the empty name.
+        std::map<std::string, tape_tag_stats> tags_;
+    };
+
+    /// <summary>Average time of one sweep, in seconds.</summary>
+    struct tape_sweep_times
+    {
+        tape_sweep_times()
+            : forward_(0)
+            , reverse_(0)
+            , repeat_(0)
+        {}
+
+        // Zero order forward sweep.
+        double forward_;
+        // First order reverse sweep.
+        double reverse_;
+        // Number of sweeps averaged.
+        size_t repeat_;
+    };
+
+    /// <summary>Scope of the recording attributed to a name, e.g. the QuantLib
+    /// class which records it. Tags are off by default; when they are
+    /// enabled on the recording thread the scope marks its beginning and end
+    /// in the tape with PriOp operations whose position argument is positive,
+    /// so they never print. tape_statistics attributes the operations between
+    /// the marks to the innermost tag. The marks cost two operations per scope,
+    /// optimize removes them, so tags are counted on the tape as recorded.</summary>
+    template <class Base>
+    class basic_tape_tag
+    {
+    public:
+        explicit basic_tape_tag(const char* name)
+            : active_(enabled())
+        {
+            if (active_)
+            {
+                mark((std::string(prefix()) + name).c_str());
+            }
+        }
+
+        ~basic_tape_tag()
+        {
+            if (active_)
+            {
+                mark(end());
+            }
+        }
+
+        /// <summary>Switches the tags on or off for the calling thread.</summary>
+        static void enable(bool value)
+        {
+            enabled() = value;
+        }
+
+        static bool& enabled()
+        {
+            static CL_THREAD_LOCAL bool value = false;
+            return value;
+        }
+
+        /// <summary>Text of the mark which opens a tag, followed by the name.</summary>
+        static const char* prefix()
+        {
+            return "\x01" "cl_tag:";
+        }
+
+        /// <summary>Text of the mark which closes the innermost tag.</summary>
+        static const char* end()
+        {
+            return "\x01" "cl_tag_end";
+        }
+
+    private:
+        basic_tape_tag(basic_tape_tag const&);
+        basic_tape_tag& operator=(basic_tape_tag const&);
+
+        // Does nothing if the thread is not recording.
+        static void mark(const char* text)
+        {
+            CppAD::PrintFor(CppAD::AD<Base>(1), text, CppAD::AD<Base>(0), "");
+        }
+
+        bool active_;
+    };
+
+    typedef basic_tape_tag<double> tape_tag;
+
+    /// <summary>Counts the operations of f by code and by tag and the bytes of its buffers.</summary>
+    template <class Base>
+    inline tape_statistics statistics(tape_function_base<Base> const& f)
+    {
+        using namespace CppAD;
+
+        typedef basic_tape_tag<double> tag_type;
+
+        player<Base> const& play = f.play_;
+        tape_statistics result;
+        result.num_op_ = play.num_op_rec();
+        result.num_var_ = f.num_var_tape_;
+        result.num_par_ = play.num_par_rec();
+
+        tape_memory& memory = result.memory_;
+        memory.op_ = play.op_rec_.size() * sizeof(CPPAD_OP_CODE_TYPE);
+        memory.op_arg_ = play.op_arg_rec_.size() * sizeof(addr_t);
+        memory.par_ = play.par_rec_.size() * sizeof(Base);
+        memory.text_ = play.text_rec_.size() * sizeof(char);
+        memory.vecad_ = play.vecad_ind_rec_.size() * sizeof(addr_t);
+        memory.taylor_ = f.taylor_.size() * sizeof(Base);
+        memory.cskip_ = f.cskip_op_.size() * sizeof(bool);
+        memory.load_op_ = f.load_op_.size() * sizeof(addr_t);
+        memory.sparsity_ = f.num_var_tape_ * f.for_jac_sparse_pack_.memory()
+            + 3 * sizeof(size_t) * f.for_jac_sparse_set_.number_elements();
+
+        size_t prefix_size = std::strlen(tag_type::prefix());
+        std::vector<std::string> stack;
+        tapescript::for_each_op(play, [&](OpCode op, addr_t const* arg, size_t)
+        {
+            result.op_count_[op]++;
+
+            const char* text = op == PriOp ? play.GetTxt(arg[2]) : "";
+            if (std::strncmp(text, tag_type::prefix(), prefix_size) == 0)
+            {
+                stack.push_back(text + prefix_size);
+                result.tags_[stack.back()].scopes_++;
+            }
+            else if (std::strcmp(text, tag_type::end()) == 0)
+            {
+                if (!stack.empty())
+                {
+                    stack.pop_back();
+                }
+            }
+            else
+            {
+                // the innermost tag owns the operation, every tag on the stack
+                // includes it once, also if it is nested in itself
+                size_t num_res = NumRes(op);
+                tape_tag_stats& owner = result.tags_[stack.empty() ? std::string() : stack.back()];
+                owner.num_op_++;
+                owner.num_var_ += num_res;
+                for (size_t k = 0; k < stack.size(); k++)
+                {
+                    if (std::find(stack.begin() + k + 1, stack.end(), stack[k]) == stack.end())
+                    {
+                        tape_tag_stats& outer = result.tags_[stack[k]];
+                        outer.inclusive_op_++;
+                        outer.inclusive_var_ += num_res;
+                    }
+                }
+                if (stack.empty())
+                {
+                    owner.inclusive_op_++;
+                    owner.inclusive_var_ += num_res;
+                }
+            }
+        });
+        return result;
+    }
+
+    /// <summary>Times the zero order forward sweep at x and the first order
+    /// reverse sweep with the weights w, averaged over repeat sweeps.
+    /// The function is left with the zero order coefficients at x.</summary>
+    template <class Base, class VectorBase>
+    inline tape_sweep_times time_sweeps(tape_function_base<Base>& f
+        , VectorBase const& x, VectorBase const& w, size_t repeat = 1)
+    {
+        typedef std::chrono::steady_clock clock;
+
+        tape_sweep_times result;
+        result.repeat_ = std::max<size_t>(repeat, 1);
+
+        for (size_t k = 0; k < result.repeat_; k++)
+        {
+            clock::time_point start = clock::now();
+            f.Forward(0, x);
+            clock::time_point middle = clock::now();
+            f.Reverse(1, w);
+            clock::time_point stop = clock::now();
+
+            result.forward_ += std::chrono::duration<double>(middle - start).count();
+            result.reverse_ += std::chrono::duration<double>(stop - middle).count();
+        }
+
+        result.forward_ /= result.repeat_;
+        result.reverse_ /= result.repeat_;
+        return result;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_profile_hpp
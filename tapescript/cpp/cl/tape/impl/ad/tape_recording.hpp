@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_recording_hpp
+#define cl_tape_impl_ad_tape_recording_hpp
+
+#include <cl/tape/impl/double.hpp>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Argument of the assignment of AD<double> which reads the
+        /// recording state of the calling thread instead of assigning.</summary>
+        struct recording_probe
+        {
+            bool* recording_;
+        };
+    }
+}
+
+namespace CppAD
+{
+    // The tape pointer of AD is private, a specialization of its assignment
+    // template is a member and may read it.
+    template <>
+    template <>
+    inline AD<double>& AD<double>::operator=(cl::tapescript::recording_probe const& probe)
+    {
+        *probe.recording_ = tape_ptr() != CPPAD_NULL;
+        return *this;
+    }
+}
+
+namespace cl
+{
+    /// <summary>True if a tape of AD<double> is recording on the calling thread,
+    /// i.e. Independent was called and the recording was neither stopped by
+    /// a tape_function nor aborted. Passive scopes do not matter. Used to skip
+    /// work which only pays off while recording and to check that a tape of
+    /// its own may be recorded, as CppAD records one tape per thread.</summary>
+    inline bool tape_recording()
+    {
+        bool recording = false;
+        tapescript::recording_probe probe = { &recording };
+        CppAD::AD<double> probe_target;
+        probe_target = probe;
+        return recording;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_recording_hpp
@@ -0,0 +1,224 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+This file includes code from CppAD, a C++ algorithmic differentiation library
+distributed under multiple licenses. This distribution is under the terms of
+the Eclipse Public License Version 1.0, a copy of which is available at:
+
+https://www.eclipse.org/legal/epl-v10.html
+
+CppAD code included in this file is subject to copyright:
+
+Copyright (C) 2003-15 Bradley M. Bell
+*/
+
+#ifndef cl_tape_impl_ad_tape_reverse_workspace_hpp
+#define cl_tape_impl_ad_tape_reverse_workspace_hpp
+
+#include <algorithm>
+
+#include <cl/tape/impl/inner/tape_inner.hpp>
+#include <cl/tape/impl/ad/tape_reverse.hpp>
+
+namespace cl
+{
+    /// <summary>Partial matrix kept between reverse sweeps of the same function.
+    /// ADFun::Reverse allocates and initializes the matrix for every call,
+    /// the workspace allocates it once and before a sweep resets only the rows
+    /// the previous sweep could write. Array storage of the rows is reused and
+    /// the workspace pools the lane buffers of its sweeps, so repeated sweeps
+    /// of tape_inner values do not allocate.</summary>
+    template <class Base>
+    class reverse_workspace
+    {
+    public:
+        reverse_workspace()
+            : partial_()
+            , touched_(0)
+            , num_var_(0)
+            , q_(0)
+            , buffers_()
+        {}
+
+        /// <summary>Reverse mode sweep of order q with the range weights w.
+        /// Derivatives are written to dw, which is resized only if its size differs.</summary>
+        template <typename VectorBase>
+        void reverse(CppAD::ADFun<Base>& f, size_t q, VectorBase const& w, VectorBase& dw)
+        {
+            using namespace CppAD;
+
+            // number of independent variables
+            size_t n = f.ind_taddr_.size();
+
+            // number of dependent variables
+            size_t m = f.dep_taddr_.size();
+
+            CheckSimpleVector<Base, VectorBase>();
+            typename tapescript::lane_buffers<Base>::scope buffers(buffers_);
+
+            CPPAD_ASSERT_KNOWN(
+                size_t(w.size()) == m || size_t(w.size()) == (m * q),
+                "Argument w to Reverse does not have length equal to\n"
+                "the dimension of the range for the corresponding ADFun."
+                );
+            CPPAD_ASSERT_KNOWN(
+                q > 0,
+                "The first argument to Reverse must be greater than zero."
+                );
+            CPPAD_ASSERT_KNOWN(
+                f.num_order_taylor_ >= q,
+                "Less that q taylor_ coefficients are currently stored"
+                " in this ADFun object."
+                );
+            // special case where multiple forward directions have been computed,
+            // but we are only using the one direction zero order results
+            if ((q == 1) & (f.num_direction_taylor_ > 1))
+            {
+                f.num_order_taylor_ = 1;
+                f.capacity_order(f.cap_order_taylor_, 1);
+            }
+            CPPAD_ASSERT_KNOWN(
+                f.num_direction_taylor_ == 1,
+                "Reverse mode for Forward(q, r, xq) with more than one direction"
+                "\n(r > 1) is not yet supported for q > 1."
+                );
+
+            prepare(f, q);
+
+            // set the dependent variable direction
+            // (use += because two dependent variables can point to same location)
+            for (size_t i = 0; i < m; i++)
+            {
+                size_t row = f.dep_taddr_[i];
+                if (size_t(w.size()) == m)
+                {
+                    partial_[row * q + q - 1] += w[i];
+                }
+                else
+                {
+                    for (size_t k = 0; k < q; k++)
+                        partial_[row * q + k] = w[i * q + k];
+                }
+            }
+
+            ReverseSweep(
+                q - 1,
+                n,
+                f.num_var_tape_,
+                &f.play_,
+                f.cap_order_taylor_,
+                f.taylor_.data(),
+                q,
+                partial_.data(),
+                f.cskip_op_.data(),
+                f.load_op_,
+                getarg<1>(w)
+                );
+
+            if (size_t(dw.size()) != n * q)
+            {
+                dw.resize(n * q);
+            }
+
+            // by the Reverse Identity Theorem
+            // partial of y^{(k)} w.r.t. u^{(0)} is equal to
+            // partial of y^{(q-1)} w.r.t. u^{(q - 1 - k)}
+            for (size_t j = 0; j < n; j++)
+            {
+                size_t row = f.ind_taddr_[j];
+                for (size_t k = 0; k < q; k++)
+                {
+                    dw[j * q + k] = size_t(w.size()) == m
+                        ? partial_[row * q + q - 1 - k]
+                        : partial_[row * q + k];
+                    cl::tapescript::set_not_intrusive(dw[j * q + k]);
+                }
+            }
+
+            collect_touched(f);
+        }
+
+        /// <summary>Releases the partial matrix.</summary>
+        void clear()
+        {
+            partial_.free();
+            touched_ = 0;
+            num_var_ = 0;
+            q_ = 0;
+        }
+
+        /// <summary>Number of rows which will be reset before the next sweep.</summary>
+        size_t touched() const
+        {
+            return touched_;
+        }
+
+    private:
+        // Sizes the matrix for f and q, or resets the rows touched by the previous sweep.
+        void prepare(CppAD::ADFun<Base> const& f, size_t q)
+        {
+            size_t J = f.cap_order_taylor_;
+            if (num_var_ != f.num_var_tape_ || q_ != q)
+            {
+                partial_.free();
+                partial_.extend(f.num_var_tape_ * q);
+                num_var_ = f.num_var_tape_;
+                q_ = q;
+                touched_ = 0;
+
+                for (size_t i = 0; i < num_var_; i++)
+                {
+                    for (size_t k = 0; k < q; k++)
+                    {
+                        cl::tapescript::reset_partial(partial_[i * q + k], f.taylor_[i * J]);
+                    }
+                }
+                return;
+            }
+
+            for (size_t i = 0; i < touched_; i++)
+            {
+                for (size_t k = 0; k < q; k++)
+                {
+                    cl::tapescript::reset_partial(partial_[i * q + k], f.taylor_[i * J]);
+                }
+            }
+            touched_ = 0;
+        }
+
+        // The sweep reads and writes only rows of the operators recorded before
+        // the last dependent variable, later rows keep their reset values.
+        void collect_touched(CppAD::ADFun<Base> const& f)
+        {
+            touched_ = 0;
+            for (size_t i = 0; i < f.dep_taddr_.size(); i++)
+            {
+                touched_ = std::max(touched_, size_t(f.dep_taddr_[i]) + 1);
+            }
+        }
+
+        CppAD::pod_vector<Base> partial_;
+        size_t touched_;
+        size_t num_var_;
+        size_t q_;
+        tapescript::lane_buffers<Base> buffers_;
+    };
+}
+
+#endif // cl_tape_impl_ad_tape_reverse_workspace_hpp
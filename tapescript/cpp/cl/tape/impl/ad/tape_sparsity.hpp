@@ -0,0 +1,296 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_ad_tape_sparsity_hpp
+#define cl_tape_impl_ad_tape_sparsity_hpp
+
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <cl/tape/impl/ad/tape_reverse.hpp>
+
+namespace cl
+{
+    /// <summary>Sparsity pattern of a matrix, entry i holds the columns
+    /// of the non-zero elements in row i.</summary>
+    typedef std::vector<std::set<size_t>> tape_sparsity;
+
+    /// <summary>Sparse matrix in coordinate format, value_[k] is the
+    /// element at row_[k] and col_[k].</summary>
+    template <class Base>
+    struct tape_sparse_matrix
+    {
+        tape_sparse_matrix()
+            : rows_(0)
+            , cols_(0)
+            , row_()
+            , col_()
+            , value_()
+        {}
+
+        /// <summary>Number of stored elements.</summary>
+        size_t nnz() const
+        {
+            return value_.size();
+        }
+
+        size_t rows_;
+        size_t cols_;
+        std::vector<size_t> row_;
+        std::vector<size_t> col_;
+        std::vector<Base> value_;
+    };
+
+    /// <summary>Grouping of the rows or the columns of a sparse matrix into
+    /// structurally orthogonal sets: no two rows (columns) of one colour have
+    /// a non-zero element in the same column (row). A single sweep seeded with
+    /// the sum of the unit vectors of a colour then gives all of them at once.</summary>
+    struct tape_colouring
+    {
+        tape_colouring()
+            : forward_(true)
+            , colour_()
+            , count_(0)
+        {}
+
+        // Columns are coloured and swept forward if true, rows in reverse otherwise.
+        bool forward_;
+        // Colour of each column or row.
+        std::vector<size_t> colour_;
+        // Number of colours, equal to the number of sweeps.
+        size_t count_;
+    };
+
+    /// <summary>Transposed pattern, cols is the number of columns of p.</summary>
+    inline tape_sparsity transpose_sparsity(tape_sparsity const& p, size_t cols)
+    {
+        tape_sparsity t(cols);
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            for (size_t j : p[i])
+            {
+                t[j].insert(i);
+            }
+        }
+        return t;
+    }
+
+    /// <summary>Greedy colouring of the rows of p, cols is the number of columns.
+    /// Rows sharing a column get different colours, each row takes the smallest
+    /// colour not used by the rows it shares a column with.
+    /// Returns the number of colours.</summary>
+    inline size_t colour_rows(tape_sparsity const& p, size_t cols, std::vector<size_t>& colour)
+    {
+        size_t rows = p.size();
+        tape_sparsity t = transpose_sparsity(p, cols);
+
+        colour.assign(rows, rows);
+        // Last row which marked the colour as used by a neighbour.
+        std::vector<size_t> used(rows + 1, rows);
+        size_t count = 0;
+        for (size_t i = 0; i < rows; i++)
+        {
+            for (size_t j : p[i])
+            {
+                for (size_t l : t[j])
+                {
+                    used[colour[l]] = i;
+                }
+            }
+
+            size_t c = 0;
+            while (used[c] == i)
+            {
+                c++;
+            }
+            colour[i] = c;
+            count = std::max(count, c + 1);
+        }
+        return count;
+    }
+
+    /// <summary>Greedy colouring of the columns of p, cols is the number of columns.
+    /// Returns the number of colours.</summary>
+    inline size_t colour_columns(tape_sparsity const& p, size_t cols, std::vector<size_t>& colour)
+    {
+        return colour_rows(transpose_sparsity(p, cols), p.size(), colour);
+    }
+
+    /// <summary>Sparsity pattern of the Jacobian of the function recorded in f, valid
+    /// for all independent values. Sets of the smaller of the domain and the range
+    /// are propagated, forward for the domain and in reverse for the range.</summary>
+    template <class Base>
+    inline tape_sparsity jacobian_sparsity(tape_function_base<Base>& f)
+    {
+        size_t n = f.Domain();
+        size_t m = f.Range();
+
+        if (n <= m)
+        {
+            tape_sparsity r(n);
+            for (size_t j = 0; j < n; j++)
+            {
+                r[j].insert(j);
+            }
+            tape_sparsity p = f.ForSparseJac(n, r);
+
+            // Forward sparsity is kept by f until it is freed.
+            f.size_forward_set(0);
+            return p;
+        }
+
+        tape_sparsity r(m);
+        for (size_t i = 0; i < m; i++)
+        {
+            r[i].insert(i);
+        }
+        return f.RevSparseJac(m, r);
+    }
+
+    /// <summary>Sparsity pattern of the Hessian of w^T F, where F is the function
+    /// recorded in f. Only the results with non-zero weights are followed.</summary>
+    template <class Base, class VectorBase>
+    inline tape_sparsity hessian_sparsity(tape_function_base<Base>& f, VectorBase const& w)
+    {
+        size_t n = f.Domain();
+        size_t m = f.Range();
+        if (w.size() != m)
+        {
+            throw std::runtime_error("Hessian weights do not match the range size.");
+        }
+
+        tape_sparsity r(n);
+        for (size_t j = 0; j < n; j++)
+        {
+            r[j].insert(j);
+        }
+        f.ForSparseJac(n, r);
+
+        tape_sparsity s(1);
+        for (size_t i = 0; i < m; i++)
+        {
+            if (!CppAD::IdenticalZero(w[i]))
+            {
+                s[0].insert(i);
+            }
+        }
+        tape_sparsity p = f.RevSparseHes(n, s);
+
+        f.size_forward_set(0);
+        return p;
+    }
+
+    /// <summary>Sparse Jacobian of the function recorded in f at x. On the first call,
+    /// with an empty jac, the sparsity pattern is computed and both its rows and its
+    /// columns are coloured; the fewer colours decide between forward sweeps over
+    /// column groups and reverse sweeps over row groups. The pattern and the colouring
+    /// are stored in jac and colouring and reused by the following calls, which only
+    /// update the values. Returns the number of sweeps.</summary>
+    template <class Base, class VectorBase>
+    inline size_t sparse_jacobian(tape_function_base<Base>& f, VectorBase const& x
+        , tape_sparse_matrix<Base>& jac, tape_colouring& colouring)
+    {
+        size_t n = f.Domain();
+        size_t m = f.Range();
+
+        if (jac.row_.empty())
+        {
+            tape_sparsity p = jacobian_sparsity(f);
+
+            jac.rows_ = m;
+            jac.cols_ = n;
+            for (size_t i = 0; i < m; i++)
+            {
+                for (size_t j : p[i])
+                {
+                    jac.row_.push_back(i);
+                    jac.col_.push_back(j);
+                }
+            }
+            jac.value_.resize(jac.row_.size());
+
+            std::vector<size_t> column_colour;
+            size_t column_count = colour_columns(p, n, column_colour);
+            std::vector<size_t> row_colour;
+            size_t row_count = colour_rows(p, n, row_colour);
+
+            colouring.forward_ = column_count <= row_count;
+            colouring.colour_.swap(colouring.forward_ ? column_colour : row_colour);
+            colouring.count_ = colouring.forward_ ? column_count : row_count;
+        }
+
+        f.Forward(0, x);
+        if (jac.row_.empty())
+        {
+            return 0;
+        }
+
+        // Elements grouped by the colour of their column or row.
+        std::vector<size_t> const& index = colouring.forward_ ? jac.col_ : jac.row_;
+        std::vector<std::vector<size_t>> group(colouring.count_);
+        for (size_t k = 0; k < index.size(); k++)
+        {
+            group[colouring.colour_[index[k]]].push_back(k);
+        }
+
+        VectorBase seed(colouring.colour_.size(), Base(0));
+        for (size_t c = 0; c < colouring.count_; c++)
+        {
+            for (size_t l = 0; l < seed.size(); l++)
+            {
+                seed[l] = colouring.colour_[l] == c ? Base(1) : Base(0);
+            }
+
+            // Columns (rows) of a colour do not overlap, each element of the
+            // compressed result belongs to one of them.
+            if (colouring.forward_)
+            {
+                VectorBase dy = f.Forward(1, seed);
+                for (size_t k : group[c])
+                {
+                    jac.value_[k] = dy[jac.row_[k]];
+                }
+            }
+            else
+            {
+                VectorBase dw = f.Reverse(1, seed);
+                for (size_t k : group[c])
+                {
+                    jac.value_[k] = dw[jac.col_[k]];
+                }
+            }
+        }
+        return colouring.count_;
+    }
+
+    /// <summary>Sparse Jacobian of the function recorded in f at x, see the overload above.</summary>
+    template <class Base, class VectorBase>
+    inline tape_sparse_matrix<Base> sparse_jacobian(tape_function_base<Base>& f, VectorBase const& x)
+    {
+        tape_sparse_matrix<Base> jac;
+        tape_colouring colouring;
+        sparse_jacobian(f, x, jac, colouring);
+        return jac;
+    }
+}
+
+#endif // cl_tape_impl_ad_tape_sparsity_hpp
@@ -753,7 +753,15 @@ namespace cl
     typedef std::vector<cl::tape_double> tape_double_vector;
 
     /// <summary>Tape function is a compatible external functional implementation
-    /// this should be suitable inside external framework.</summary>
+    /// this should be suitable inside external framework.
+    ///
+    /// A tape which holds roots of implicit_root, e.g. of a solver or curve
+    /// bootstrap recorded with implicit differentiation, records each root as
+    /// one Newton step from the recorded point. Its derivatives are valid at
+    /// the recorded point only: Forward(0, x) at other inputs gives the first
+    /// order approximation of the roots, not the solution, and its second
+    /// derivatives are exact only if recorded in an implicit_second_order_scope.
+    /// Such tapes are re-recorded rather than re-evaluated for scenarios.</summary>
     template <typename Base>
     class tape_function
         : public tape_function_base<Base>
@@ -813,6 +821,23 @@ namespace cl
             return this->Reverse(q, v);
         }
 
+        /// reverse mode which keeps the partial matrix between calls,
+        /// derivatives are written to dw.
+        template<typename Vector>
+        inline void
+        reverse(size_t q, Vector const& v, Vector& dw)
+        {
+            workspace_.reverse(*this, q, v, dw);
+        }
+
+        /// reverse mode with the caller workspace, derivatives are written to dw.
+        template<typename Vector>
+        inline void
+        reverse(size_t q, Vector const& v, Vector& dw, reverse_workspace<Base>& workspace)
+        {
+            workspace.reverse(*this, q, v, dw);
+        }
+
         /// assign a new operation sequence
         template <typename ADvector>
         void dependent(const ADvector &x, const ADvector &y)
@@ -843,12 +868,151 @@ namespace cl
             return this->Forward(q,x,s);
         }
 
+        /// optimizes the operation sequence and returns its sizes
+        /// before and after, see cl::optimize.
+        inline tape_optimize_stats optimize(std::string const& options = "")
+        {
+            workspace_.clear();
+            return cl::optimize(static_cast<tape_function_base<Base>&>(*this), options);
+        }
+
+        /// zero order forward mode at new independent values on the recorded
+        /// operation sequence, the results are written to y. Returns the number
+        /// of recorded comparisons with a different outcome at x; if it is not
+        /// zero the calculation takes another branch and has to be recorded again.
+        template <typename VectorBase>
+        inline size_t replay(const VectorBase& x, VectorBase& y)
+        {
+            this->compare_change_count(1);
+            y = this->Forward(0, x);
+            return this->compare_change_number();
+        }
+
+        /// index of the first operator which compared differently in the last
+        /// replay, zero if all comparisons kept their outcome.
+        inline size_t replay_change_op_index() const
+        {
+            return this->compare_change_op_index();
+        }
+
+        /// forward mode with the lanes of array values split between threads.
+        template <typename VectorBase>
+        inline VectorBase forward_lanes(size_t q, const VectorBase& x, lane_options const& options = lane_options())
+        {
+            return lane_sweep<Base>(*this, options).forward(q, x);
+        }
+
+        /// first order reverse mode with the lanes of array values split between threads.
+        template <typename VectorBase>
+        inline VectorBase reverse_lanes(const VectorBase& w, lane_options const& options = lane_options())
+        {
+            return lane_sweep<Base>(*this, options).reverse(w);
+        }
+
+        /// sparsity pattern of the Jacobian, see cl::jacobian_sparsity.
+        inline tape_sparsity jacobian_sparsity()
+        {
+            return cl::jacobian_sparsity(static_cast<tape_function_base<Base>&>(*this));
+        }
+
+        /// sparsity pattern of the Hessian of w^T y, see cl::hessian_sparsity.
+        template <typename VectorBase>
+        inline tape_sparsity hessian_sparsity(const VectorBase& w)
+        {
+            return cl::hessian_sparsity(static_cast<tape_function_base<Base>&>(*this), w);
+        }
+
+        /// sparse Jacobian at x by compressed forward or reverse sweeps.
+        template <typename VectorBase>
+        inline tape_sparse_matrix<Base> sparse_jacobian(const VectorBase& x)
+        {
+            return cl::sparse_jacobian(static_cast<tape_function_base<Base>&>(*this), x);
+        }
+
+        /// sparse Jacobian at x, the pattern and the colouring stored in jac
+        /// and colouring by the first call are reused. Returns the number of sweeps.
+        template <typename VectorBase>
+        inline size_t sparse_jacobian(const VectorBase& x
+            , tape_sparse_matrix<Base>& jac, tape_colouring& colouring)
+        {
+            return cl::sparse_jacobian(static_cast<tape_function_base<Base>&>(*this), x, jac, colouring);
+        }
+
+        /// Hessian of w^T y times the direction v at the independent values
+        /// of the last zero order forward mode, see cl::hessian_times.
+        template <typename VectorBase>
+        inline VectorBase hessian_times(const VectorBase& w, const VectorBase& v)
+        {
+            return cl::hessian_times(static_cast<tape_function_base<Base>&>(*this), w, v);
+        }
+
+        /// dense Hessian of w^T y at x, hes[j * n + l] is the derivative
+        /// by x_j and x_l.
+        template <typename VectorBase>
+        inline VectorBase hessian(const VectorBase& x, const VectorBase& w)
+        {
+            return cl::hessian(static_cast<tape_function_base<Base>&>(*this), x, w);
+        }
+
+        /// sparse Hessian of w^T y at x with the columns grouped by colouring.
+        template <typename VectorBase>
+        inline tape_sparse_matrix<Base> sparse_hessian(const VectorBase& x, const VectorBase& w)
+        {
+            return cl::sparse_hessian(static_cast<tape_function_base<Base>&>(*this), x, w);
+        }
+
+        /// sparse Hessian of w^T y at x, the pattern and the colouring stored
+        /// in hes and work by the first call are reused. Returns the number of sweeps.
+        template <typename VectorBase>
+        inline size_t sparse_hessian(const VectorBase& x, const VectorBase& w
+            , tape_sparse_matrix<Base>& hes, CppAD::sparse_hessian_work& work)
+        {
+            return cl::sparse_hessian(static_cast<tape_function_base<Base>&>(*this), x, w, hes, work);
+        }
+
+        /// operation counts, buffer sizes and tag attribution, see cl::statistics.
+        inline tape_statistics statistics() const
+        {
+            return cl::statistics(static_cast<tape_function_base<Base> const&>(*this));
+        }
+
+        /// average times of the zero order forward and first order reverse sweeps.
+        template <typename VectorBase>
+        inline tape_sweep_times time_sweeps(const VectorBase& x, const VectorBase& w, size_t repeat = 1)
+        {
+            return cl::time_sweeps(static_cast<tape_function_base<Base>&>(*this), x, w, repeat);
+        }
+
         /// Dependent function forward to the adjoint library
         template <typename Inner>
         void Dependent(std::vector<cl::tape_wrapper<Inner>> const& x, std::vector<cl::tape_wrapper<Inner>> const& y)
         {
             tape_function_base<Base>::Dependent(tapescript::adapt(x), tapescript::adapt(y));
+            workspace_.clear();
         }
+
+        /// Dependent function which stores the recording sizes in the arena,
+        /// the next recording started with this arena reuses the released memory.
+        /// As the constructor does, zero order coefficients are computed at x.
+        template <typename Inner>
+        void Dependent(std::vector<cl::tape_wrapper<Inner>> const& x, std::vector<cl::tape_wrapper<Inner>> const& y
+            , tape_arena<Base>& arena)
+        {
+            Dependent(x, y);
+
+            auto const ax = tapescript::adapt(x);
+            std::vector<Base> x0(ax.size());
+            for (size_t j = 0; j < x0.size(); j++)
+            {
+                x0[j] = CppAD::Value(ax[j]);
+            }
+            this->Forward(0, x0);
+
+            arena.update(*this);
+        }
+
+    private:
+        reverse_workspace<Base> workspace_;
     };
 
     template <typename Inner>
@@ -881,6 +1045,16 @@ namespace cl
         ext::Independent(av);
     }
 
+    /// <summary>Starts recording with the memory reserved by the arena.</summary>
+    template <class Inner, class Base>
+    inline void
+    Independent(std::vector<cl::tape_wrapper<Inner>>& v_tape, tape_arena<Base>& arena)
+    {
+        arena.reserve(arena.high_water());
+        auto av = tapescript::adapt(v_tape);
+        ext::Independent(av);
+    }
+
     inline void
     Independent(std::vector<std::complex<cl::tape_double>> &x, std::size_t abort_index)
     {
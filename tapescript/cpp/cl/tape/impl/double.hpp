@@ -24,6 +24,7 @@ limitations under the License.
 #include <cl/tape/declare.hpp>
 #include <cl/tape/impl/doubleconverter.hpp>
 #include <cl/tape/impl/std_fwd.hpp>
+#include <cl/tape/impl/tape_passive.hpp>
 
 namespace cl
 {
@@ -230,34 +231,78 @@ namespace cl
         inline tape_type& operator=(double rhs) { value_ = rhs; return *this; }
 
         /// <summary>Adds rhs to self.</summary>
-        inline tape_type& operator+=(const tape_type& rhs) { value_ += rhs.value_; return *this; }
+        inline tape_type& operator+=(const tape_type& rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) + tapescript::passive_value(rhs.value_));
+            else value_ += rhs.value_;
+            return *this;
+        }
 
         /// <summary>Adds rhs to self.</summary>
-        inline tape_type& operator+=(double rhs) { value_ += rhs; return *this; }
+        inline tape_type& operator+=(double rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) + rhs);
+            else value_ += rhs;
+            return *this;
+        }
 
         /// <summary>Subtracts rhs from self.</summary>
-        inline tape_type& operator-=(const tape_type& rhs) { value_ -= rhs.value_; return *this; }
+        inline tape_type& operator-=(const tape_type& rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) - tapescript::passive_value(rhs.value_));
+            else value_ -= rhs.value_;
+            return *this;
+        }
 
         /// <summary>Subtracts rhs from self.</summary>
-        inline tape_type& operator-=(double rhs) { value_ -= rhs; return *this; }
+        inline tape_type& operator-=(double rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) - rhs);
+            else value_ -= rhs;
+            return *this;
+        }
 
         /// <summary>Multiplies self by rhs.</summary>
-        inline tape_type& operator*=(const tape_type& rhs) { value_ *= rhs.value_; return *this; }
+        inline tape_type& operator*=(const tape_type& rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) * tapescript::passive_value(rhs.value_));
+            else value_ *= rhs.value_;
+            return *this;
+        }
 
         /// <summary>Multiplies self by rhs.</summary>
-        inline tape_type& operator*=(double rhs) { value_ *= rhs; return *this; }
+        inline tape_type& operator*=(double rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) * rhs);
+            else value_ *= rhs;
+            return *this;
+        }
 
         /// <summary>Divides self by rhs.</summary>
-        inline tape_type& operator/=(const tape_type& rhs) { value_ /= rhs.value_; return *this; }
+        inline tape_type& operator/=(const tape_type& rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) / tapescript::passive_value(rhs.value_));
+            else value_ /= rhs.value_;
+            return *this;
+        }
 
         /// <summary>Divides self by rhs.</summary>
-        inline tape_type& operator/=(double rhs) { value_ /= rhs; return *this; }
+        inline tape_type& operator/=(double rhs)
+        {
+            if (tapescript::passive()) value_ = value_type(tapescript::passive_value(value_) / rhs);
+            else value_ /= rhs;
+            return *this;
+        }
 
         /// <summary>Returns a copy if self.</summary>
         inline tape_type operator+() const { return tape_type(value_); }
 
         /// <summary>Returns the negative of self.</summary>
-        inline tape_type operator-() const { return tape_type(-value_); }
+        inline tape_type operator-() const
+        {
+            if (tapescript::passive()) return tape_type(value_type(-tapescript::passive_value(value_)));
+            return tape_type(-value_);
+        }
 
         /// <summary>Returns true if self is equal to rhs.</summary>
         inline bool operator==(const tape_type& rhs) const { return value_ == rhs.value_; }
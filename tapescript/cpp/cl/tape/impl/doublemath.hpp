@@ -145,6 +145,9 @@ namespace std
         CL_CHECK(std::sqrt(v_(x))
             == (cl::tape_wrapper<Base>)CppAD::sqrt(x.value()));
 
+        if (cl::tapescript::passive())
+            return CppAD::sqrt(cl::tapescript::passive_value(x.value()));
+
         return CppAD::sqrt(x.value());
 #elif CL_TAPE_ADOLC
         cl::throw_("Not implemented"); return x;
@@ -160,6 +163,9 @@ namespace std
         CL_CHECK(std::log(v_(x))
             == (cl::tape_wrapper<Base>)CppAD::log(x.value()));
 
+        if (cl::tapescript::passive())
+            return CppAD::log(cl::tapescript::passive_value(x.value()));
+
         return CppAD::log(x.value());
 #elif CL_TAPE_ADOLC
         cl::throw_("Not implemented"); return x;
@@ -175,6 +181,9 @@ namespace std
         CL_CHECK(std::exp(v_(x))
             == (cl::tape_wrapper<Base>)CppAD::exp(x.value()));
 
+        if (cl::tapescript::passive())
+            return CppAD::exp(cl::tapescript::passive_value(x.value()));
+
         return CppAD::exp(x.value());
 #elif CL_TAPE_ADOLC
         cl::throw_("Not implemented"); return x;
@@ -325,6 +334,9 @@ namespace std
         CL_CHECK(std::pow(v_(x), v_(y))
             == (cl::tape_wrapper<Base>)CppAD::pow(x.value(), y.value()));
 
+        if (cl::tapescript::passive())
+            return CppAD::pow(cl::tapescript::passive_value(x.value()), cl::tapescript::passive_value(y.value()));
+
         return CppAD::pow(x.value(), y.value());
 #elif CL_TAPE_ADOLC
         cl::throw_("Not implemented"); return x;
@@ -473,6 +485,64 @@ namespace cl
     {
         return max_impl(y, x);
     }
+
+    // Selection functions select_lt, select_le, select_eq, select_ge, select_gt
+    // return if_true where left Op right holds and if_false elsewhere.
+    // Comparison of tape_inner arrays with bool operators is true only if it holds
+    // in every lane; the selection is recorded as a conditional expression,
+    // so every lane makes its own choice in forward and reverse sweeps.
+#if defined CL_TAPE_CPPAD
+#   define CL_TAPE_SELECT_WRAPPER_IMPL(Rel, Op)                                               \
+        return CppAD::CondExp##Rel(left.value(), right.value(), if_true.value(), if_false.value());
+#elif CL_TAPE_ADOLC
+#   define CL_TAPE_SELECT_WRAPPER_IMPL(Rel, Op)                                               \
+        cl::throw_("Not implemented"); return if_true;
+#else
+#   define CL_TAPE_SELECT_WRAPPER_IMPL(Rel, Op)                                               \
+        return (left.value() Op right.value()) ? if_true : if_false;
+#endif
+
+#define CL_TAPE_SELECT(Name, Rel, Op)                                                           \
+    template <typename Ty>                                                                      \
+    inline Ty select_##Name(Ty const& left, Ty const& right                                    \
+        , Ty const& if_true, Ty const& if_false)                                                \
+    {                                                                                           \
+        return (left Op right) ? if_true : if_false;                                            \
+    }                                                                                           \
+                                                                                                \
+    template <typename Base>                                                                    \
+    inline cl::tape_wrapper<Base> select_##Name(                                               \
+        cl::tape_wrapper<Base> const& left, cl::tape_wrapper<Base> const& right                \
+        , cl::tape_wrapper<Base> const& if_true, cl::tape_wrapper<Base> const& if_false)       \
+    {                                                                                           \
+        CL_TAPE_SELECT_WRAPPER_IMPL(Rel, Op)                                                    \
+    }
+
+    CL_TAPE_SELECT(lt, Lt, <)
+    CL_TAPE_SELECT(le, Le, <=)
+    CL_TAPE_SELECT(eq, Eq, ==)
+    CL_TAPE_SELECT(ge, Ge, >=)
+    CL_TAPE_SELECT(gt, Gt, >)
+#undef CL_TAPE_SELECT
+#undef CL_TAPE_SELECT_WRAPPER_IMPL
+
+#if defined CL_TAPE_CPPAD && defined CL_TAPE_INNER_ARRAY_ENABLED
+#define CL_TAPE_INNER_SELECT(Name, Compare)                                                     \
+    template <class Array>                                                                      \
+    inline cl::tape_inner<Array> select_##Name(                                                \
+        cl::tape_inner<Array> const& left, cl::tape_inner<Array> const& right                  \
+        , cl::tape_inner<Array> const& if_true, cl::tape_inner<Array> const& if_false)         \
+    {                                                                                           \
+        return CppAD::CondExpOp(CppAD::Compare, left, right, if_true, if_false);                \
+    }
+
+    CL_TAPE_INNER_SELECT(lt, CompareLt)
+    CL_TAPE_INNER_SELECT(le, CompareLe)
+    CL_TAPE_INNER_SELECT(eq, CompareEq)
+    CL_TAPE_INNER_SELECT(ge, CompareGe)
+    CL_TAPE_INNER_SELECT(gt, CompareGt)
+#undef CL_TAPE_INNER_SELECT
+#endif
 } // namespace cl
 
 namespace std
@@ -51,43 +51,98 @@ namespace cl
         {
             return tv.value_;
         }
+
+        /// Take plain value from tape double, used inside tape_passive_scope
+        template <typename TapeType>
+        inline typename TapeType::base_type passive_cvalue(TapeType const& tv)
+        {
+            return passive_value(cvalue(tv));
+        }
     }
 
     /// <summary>Returns the result of addition of two tape_double objects.</summary>
-    inline tape_double operator+(const tape_double& lhs, const tape_double& rhs) { return cl::tapescript::cvalue(lhs) + cl::tapescript::cvalue(rhs); }
+    inline tape_double operator+(const tape_double& lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) + cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) + cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of subtraction of two tape_double objects.</summary>
-    inline tape_double operator-(const tape_double& lhs, const tape_double& rhs) { return cl::tapescript::cvalue(lhs) - cl::tapescript::cvalue(rhs); }
+    inline tape_double operator-(const tape_double& lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) - cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) - cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of multiplication of two tape_double objects.</summary>
-    inline tape_double operator*(const tape_double& lhs, const tape_double& rhs) { return cl::tapescript::cvalue(lhs) * cl::tapescript::cvalue(rhs); }
+    inline tape_double operator*(const tape_double& lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) * cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) * cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of division of two tape_double objects.</summary>
-    inline tape_double operator/(const tape_double& lhs, const tape_double& rhs) { return cl::tapescript::cvalue(lhs) / cl::tapescript::cvalue(rhs); }
+    inline tape_double operator/(const tape_double& lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) / cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) / cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of addition of tape_double and double.</summary>
-    inline tape_double operator+(const tape_double& lhs, double rhs) { return cl::tapescript::cvalue(lhs) + rhs; }
+    inline tape_double operator+(const tape_double& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) + rhs;
+        return cl::tapescript::cvalue(lhs) + rhs;
+    }
 
     /// <summary>Returns the result of subtraction of tape_double and double.</summary>
-    inline tape_double operator-(const tape_double& lhs, double rhs) { return cl::tapescript::cvalue(lhs) - rhs; }
+    inline tape_double operator-(const tape_double& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) - rhs;
+        return cl::tapescript::cvalue(lhs) - rhs;
+    }
 
     /// <summary>Returns the result of multiplication of tape_double and double.</summary>
-    inline tape_double operator*(const tape_double& lhs, double rhs) { return cl::tapescript::cvalue(lhs) * rhs; }
+    inline tape_double operator*(const tape_double& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) * rhs;
+        return cl::tapescript::cvalue(lhs) * rhs;
+    }
 
     /// <summary>Returns the result of division of tape_double and double.</summary>
-    inline tape_double operator/(const tape_double& lhs, double rhs) { return cl::tapescript::cvalue(lhs) / rhs; }
+    inline tape_double operator/(const tape_double& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) / rhs;
+        return cl::tapescript::cvalue(lhs) / rhs;
+    }
 
     /// <summary>Returns the result of addition of double and tape_double.</summary>
-    inline tape_double operator+(double lhs, const tape_double& rhs) { return lhs + cl::tapescript::cvalue(rhs); }
+    inline tape_double operator+(double lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs + cl::tapescript::passive_cvalue(rhs);
+        return lhs + cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of subtraction of double and tape_double.</summary>
-    inline tape_double operator-(double lhs, const tape_double& rhs) { return lhs - cl::tapescript::cvalue(rhs); }
+    inline tape_double operator-(double lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs - cl::tapescript::passive_cvalue(rhs);
+        return lhs - cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of multiplication of double and tape_double.</summary>
-    inline tape_double operator*(double lhs, const tape_double& rhs) { return lhs * cl::tapescript::cvalue(rhs); }
+    inline tape_double operator*(double lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs * cl::tapescript::passive_cvalue(rhs);
+        return lhs * cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of division of double and tape_double.</summary>
-    inline tape_double operator/(double lhs, const tape_double& rhs) { return lhs / cl::tapescript::cvalue(rhs); }
+    inline tape_double operator/(double lhs, const tape_double& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs / cl::tapescript::passive_cvalue(rhs);
+        return lhs / cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns true if lhs is equal to rhs.</summary>
     inline bool operator==(double lhs, const tape_double& rhs) { return lhs == cl::tapescript::cvalue(rhs); }
@@ -116,51 +171,99 @@ namespace cl
 
     /// <summary>Returns the result of addition of two cl::tape_wrapper<Base> objects.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator+(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs) { return cl::tapescript::cvalue(lhs) + cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator+(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) + cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) + cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of subtraction of two cl::tape_wrapper<Base> objects.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator-(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs) { return cl::tapescript::cvalue(lhs) - cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator-(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) - cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) - cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of multiplication of two cl::tape_wrapper<Base> objects.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator*(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs) { return cl::tapescript::cvalue(lhs) * cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator*(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) * cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) * cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of division of two cl::tape_wrapper<Base> objects.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator/(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs) { return cl::tapescript::cvalue(lhs) / cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator/(const cl::tape_wrapper<Base>& lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) / cl::tapescript::passive_cvalue(rhs);
+        return cl::tapescript::cvalue(lhs) / cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of addition of cl::tape_wrapper<Base> and double.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator+(const cl::tape_wrapper<Base>& lhs, double rhs) { return cl::tapescript::cvalue(lhs) + rhs; }
+    inline cl::tape_wrapper<Base> operator+(const cl::tape_wrapper<Base>& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) + rhs;
+        return cl::tapescript::cvalue(lhs) + rhs;
+    }
 
     /// <summary>Returns the result of subtraction of cl::tape_wrapper<Base> and double.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator-(const cl::tape_wrapper<Base>& lhs, double rhs) { return cl::tapescript::cvalue(lhs) - rhs; }
+    inline cl::tape_wrapper<Base> operator-(const cl::tape_wrapper<Base>& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) - rhs;
+        return cl::tapescript::cvalue(lhs) - rhs;
+    }
 
     /// <summary>Returns the result of multiplication of cl::tape_wrapper<Base> and double.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator*(const cl::tape_wrapper<Base>& lhs, double rhs) { return cl::tapescript::cvalue(lhs) * rhs; }
+    inline cl::tape_wrapper<Base> operator*(const cl::tape_wrapper<Base>& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) * rhs;
+        return cl::tapescript::cvalue(lhs) * rhs;
+    }
 
     /// <summary>Returns the result of division of cl::tape_wrapper<Base> and double.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator/(const cl::tape_wrapper<Base>& lhs, double rhs) { return cl::tapescript::cvalue(lhs) / rhs; }
+    inline cl::tape_wrapper<Base> operator/(const cl::tape_wrapper<Base>& lhs, double rhs)
+    {
+        if (cl::tapescript::passive()) return cl::tapescript::passive_cvalue(lhs) / rhs;
+        return cl::tapescript::cvalue(lhs) / rhs;
+    }
 
     /// <summary>Returns the result of addition of double and cl::tape_wrapper<Base>.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator+(double lhs, const cl::tape_wrapper<Base>& rhs) { return lhs + cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator+(double lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs + cl::tapescript::passive_cvalue(rhs);
+        return lhs + cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of subtraction of double and cl::tape_wrapper<Base>.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator-(double lhs, const cl::tape_wrapper<Base>& rhs) { return lhs - cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator-(double lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs - cl::tapescript::passive_cvalue(rhs);
+        return lhs - cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of multiplication of double and cl::tape_wrapper<Base>.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator*(double lhs, const cl::tape_wrapper<Base>& rhs) { return lhs * cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator*(double lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs * cl::tapescript::passive_cvalue(rhs);
+        return lhs * cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns the result of division of double and cl::tape_wrapper<Base>.</summary>
     template <class Base>
-    inline cl::tape_wrapper<Base> operator/(double lhs, const cl::tape_wrapper<Base>& rhs) { return lhs / cl::tapescript::cvalue(rhs); }
+    inline cl::tape_wrapper<Base> operator/(double lhs, const cl::tape_wrapper<Base>& rhs)
+    {
+        if (cl::tapescript::passive()) return lhs / cl::tapescript::passive_cvalue(rhs);
+        return lhs / cl::tapescript::cvalue(rhs);
+    }
 
     /// <summary>Returns true if lhs is equal to rhs.</summary>
     template <class Base>
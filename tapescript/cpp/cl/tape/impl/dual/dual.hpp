@@ -0,0 +1,357 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_dual_dual_hpp
+#define cl_tape_impl_dual_dual_hpp
+
+#include <array>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+#if !defined CL_DUAL_DIRECTIONS
+    /// <summary>Number of tangent directions of cl::dual_double.</summary>
+#   define CL_DUAL_DIRECTIONS 4
+#endif
+
+namespace cl
+{
+    /// <summary>Forward mode dual number without a tape: the value and its
+    /// derivatives along N tangent directions are propagated together by every
+    /// operation. The directions are fixed at compile time, so the tangents live
+    /// on the stack and the loops over them unroll. Designed to serve as a
+    /// drop-in replacement to native double like tape_wrapper, for the first
+    /// order sensitivities of calculations with a few inputs.</summary>
+    template <typename Scalar, size_t N>
+    class dual
+    {
+    public:
+        typedef Scalar value_type;
+        typedef dual<Scalar, N> dual_type;
+        typedef std::array<Scalar, N> tangent_type;
+
+        /// <summary>Number of tangent directions.</summary>
+        static const size_t directions = N;
+
+    public: // CONSTRUCTORS
+
+        inline dual()
+            : value_()
+            , tangent_()
+        {}
+
+        /// <summary>Implicit constructor from native scalar, a constant.</summary>
+        inline dual(Scalar value)
+            : value_(value)
+            , tangent_()
+        {}
+
+        /// <summary>Implicit constructor from arithmetic types other than Scalar.</summary>
+        template <typename Type
+            , typename = typename std::enable_if<std::is_arithmetic<Type>::value>::type>
+        inline dual(Type value)
+            : value_(static_cast<Scalar>(value))
+            , tangent_()
+        {}
+
+        /// <summary>Input variable which is the tangent direction k.</summary>
+        inline dual(Scalar value, size_t k)
+            : value_(value)
+            , tangent_()
+        {
+            if (k >= N)
+            {
+                throw std::out_of_range("Dual number direction is out of range.");
+            }
+            tangent_[k] = Scalar(1);
+        }
+
+        /// <summary>Value with the given tangents.</summary>
+        inline dual(Scalar value, tangent_type const& tangent)
+            : value_(value)
+            , tangent_(tangent)
+        {}
+
+        inline dual(dual_type const&) = default;
+        inline dual(dual_type&&) = default;
+        inline dual_type& operator=(dual_type const&) = default;
+        inline dual_type& operator=(dual_type&&) = default;
+
+        /// <summary>Copy of a volatile variable, which native double code
+        /// uses to avoid extended precision registers. Only the value needs
+        /// the volatile read, std::array has no volatile element access.</summary>
+        inline dual(dual_type const volatile& other)
+            : value_(other.value_)
+            , tangent_(const_cast<tangent_type const&>(other.tangent_))
+        {}
+
+    public: // METHODS
+
+        /// <summary>Value without the derivatives.</summary>
+        inline Scalar value() const { return value_; }
+
+        /// <summary>Derivative along the tangent direction k.</summary>
+        inline Scalar derivative(size_t k) const { return tangent_[k]; }
+
+        /// <summary>Derivatives along all tangent directions.</summary>
+        inline tangent_type const& tangent() const { return tangent_; }
+
+        /// <summary>Derivatives along all tangent directions.</summary>
+        inline tangent_type& tangent() { return tangent_; }
+
+        /// <summary>Explicit conversion to arithmetic types drops the derivatives.</summary>
+        template <typename Type
+            , typename = typename std::enable_if<std::is_arithmetic<Type>::value>::type>
+        inline explicit operator Type() const
+        {
+            return static_cast<Type>(value_);
+        }
+
+    public: // OPERATORS
+
+        /// <summary>Negation operator.</summary>
+        inline bool operator!() const { return value_ == Scalar(0); }
+
+        /// <summary>Adds rhs to self.</summary>
+        inline dual_type& operator+=(dual_type const& rhs)
+        {
+            value_ += rhs.value_;
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent_[k] += rhs.tangent_[k];
+            }
+            return *this;
+        }
+
+        /// <summary>Subtracts rhs from self.</summary>
+        inline dual_type& operator-=(dual_type const& rhs)
+        {
+            value_ -= rhs.value_;
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent_[k] -= rhs.tangent_[k];
+            }
+            return *this;
+        }
+
+        /// <summary>Multiplies self by rhs.</summary>
+        inline dual_type& operator*=(dual_type const& rhs)
+        {
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent_[k] = tangent_[k] * rhs.value_ + value_ * rhs.tangent_[k];
+            }
+            value_ *= rhs.value_;
+            return *this;
+        }
+
+        /// <summary>Divides self by rhs.</summary>
+        inline dual_type& operator/=(dual_type const& rhs)
+        {
+            value_ /= rhs.value_;
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent_[k] = (tangent_[k] - value_ * rhs.tangent_[k]) / rhs.value_;
+            }
+            return *this;
+        }
+
+        /// <summary>Adds rhs to self.</summary>
+        inline dual_type& operator+=(Scalar rhs) { value_ += rhs; return *this; }
+
+        /// <summary>Subtracts rhs from self.</summary>
+        inline dual_type& operator-=(Scalar rhs) { value_ -= rhs; return *this; }
+
+        /// <summary>Multiplies self by rhs.</summary>
+        inline dual_type& operator*=(Scalar rhs)
+        {
+            value_ *= rhs;
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent_[k] *= rhs;
+            }
+            return *this;
+        }
+
+        /// <summary>Divides self by rhs.</summary>
+        inline dual_type& operator/=(Scalar rhs)
+        {
+            value_ /= rhs;
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent_[k] /= rhs;
+            }
+            return *this;
+        }
+
+        /// <summary>Returns a copy of self.</summary>
+        inline dual_type operator+() const { return *this; }
+
+        /// <summary>Returns the negative of self.</summary>
+        inline dual_type operator-() const
+        {
+            dual_type result(-value_);
+            for (size_t k = 0; k < N; k++)
+            {
+                result.tangent_[k] = -tangent_[k];
+            }
+            return result;
+        }
+
+        /// <summary>Prefix incrementation.</summary>
+        inline dual_type& operator++() { value_ += Scalar(1); return *this; }
+
+        /// <summary>Postfix incrementation.</summary>
+        inline dual_type operator++(int) { dual_type result(*this); ++(*this); return result; }
+
+        /// <summary>Prefix decrementation.</summary>
+        inline dual_type& operator--() { value_ -= Scalar(1); return *this; }
+
+        /// <summary>Postfix decrementation.</summary>
+        inline dual_type operator--(int) { dual_type result(*this); --(*this); return result; }
+
+        // Binary operators are friends found by argument dependent lookup, so that
+        // the implicit conversions to dual, e.g. from Null<dual>, apply to them.
+
+        /// <summary>Returns the result of addition of two dual objects.</summary>
+        friend inline dual_type operator+(dual_type lhs, dual_type const& rhs) { return lhs += rhs; }
+
+        /// <summary>Returns the result of subtraction of two dual objects.</summary>
+        friend inline dual_type operator-(dual_type lhs, dual_type const& rhs) { return lhs -= rhs; }
+
+        /// <summary>Returns the result of multiplication of two dual objects.</summary>
+        friend inline dual_type operator*(dual_type lhs, dual_type const& rhs) { return lhs *= rhs; }
+
+        /// <summary>Returns the result of division of two dual objects.</summary>
+        friend inline dual_type operator/(dual_type lhs, dual_type const& rhs) { return lhs /= rhs; }
+
+        /// <summary>Returns the result of addition of dual and scalar.</summary>
+        friend inline dual_type operator+(dual_type lhs, Scalar rhs) { return lhs += rhs; }
+
+        /// <summary>Returns the result of subtraction of dual and scalar.</summary>
+        friend inline dual_type operator-(dual_type lhs, Scalar rhs) { return lhs -= rhs; }
+
+        /// <summary>Returns the result of multiplication of dual and scalar.</summary>
+        friend inline dual_type operator*(dual_type lhs, Scalar rhs) { return lhs *= rhs; }
+
+        /// <summary>Returns the result of division of dual and scalar.</summary>
+        friend inline dual_type operator/(dual_type lhs, Scalar rhs) { return lhs /= rhs; }
+
+        /// <summary>Returns the result of addition of scalar and dual.</summary>
+        friend inline dual_type operator+(Scalar lhs, dual_type rhs) { return rhs += lhs; }
+
+        /// <summary>Returns the result of subtraction of scalar and dual.</summary>
+        friend inline dual_type operator-(Scalar lhs, dual_type const& rhs) { return (-rhs) += lhs; }
+
+        /// <summary>Returns the result of multiplication of scalar and dual.</summary>
+        friend inline dual_type operator*(Scalar lhs, dual_type rhs) { return rhs *= lhs; }
+
+        /// <summary>Returns the result of division of scalar and dual.</summary>
+        friend inline dual_type operator/(Scalar lhs, dual_type const& rhs)
+        {
+            dual_type result(lhs / rhs.value_);
+            for (size_t k = 0; k < N; k++)
+            {
+                result.tangent_[k] = -result.value_ * rhs.tangent_[k] / rhs.value_;
+            }
+            return result;
+        }
+
+        // Comparisons use the values only, as the tape_wrapper ones do.
+        friend inline bool operator==(dual_type const& lhs, dual_type const& rhs) { return lhs.value_ == rhs.value_; }
+        friend inline bool operator!=(dual_type const& lhs, dual_type const& rhs) { return lhs.value_ != rhs.value_; }
+        friend inline bool operator<(dual_type const& lhs, dual_type const& rhs) { return lhs.value_ < rhs.value_; }
+        friend inline bool operator<=(dual_type const& lhs, dual_type const& rhs) { return lhs.value_ <= rhs.value_; }
+        friend inline bool operator>(dual_type const& lhs, dual_type const& rhs) { return lhs.value_ > rhs.value_; }
+        friend inline bool operator>=(dual_type const& lhs, dual_type const& rhs) { return lhs.value_ >= rhs.value_; }
+
+        friend inline bool operator==(dual_type const& lhs, Scalar rhs) { return lhs.value_ == rhs; }
+        friend inline bool operator!=(dual_type const& lhs, Scalar rhs) { return lhs.value_ != rhs; }
+        friend inline bool operator<(dual_type const& lhs, Scalar rhs) { return lhs.value_ < rhs; }
+        friend inline bool operator<=(dual_type const& lhs, Scalar rhs) { return lhs.value_ <= rhs; }
+        friend inline bool operator>(dual_type const& lhs, Scalar rhs) { return lhs.value_ > rhs; }
+        friend inline bool operator>=(dual_type const& lhs, Scalar rhs) { return lhs.value_ >= rhs; }
+
+        friend inline bool operator==(Scalar lhs, dual_type const& rhs) { return lhs == rhs.value_; }
+        friend inline bool operator!=(Scalar lhs, dual_type const& rhs) { return lhs != rhs.value_; }
+        friend inline bool operator<(Scalar lhs, dual_type const& rhs) { return lhs < rhs.value_; }
+        friend inline bool operator<=(Scalar lhs, dual_type const& rhs) { return lhs <= rhs.value_; }
+        friend inline bool operator>(Scalar lhs, dual_type const& rhs) { return lhs > rhs.value_; }
+        friend inline bool operator>=(Scalar lhs, dual_type const& rhs) { return lhs >= rhs.value_; }
+
+    private: // FIELDS
+
+        Scalar value_;
+        tangent_type tangent_;
+    };
+
+    /// <summary>Dual number replacement of native double.</summary>
+    typedef dual<double, CL_DUAL_DIRECTIONS> dual_double;
+
+    namespace tapescript
+    {
+        /// <summary>Result of a function f of x given f(x) and f'(x), by the chain rule.</summary>
+        template <typename Scalar, size_t N>
+        inline dual<Scalar, N> chain(dual<Scalar, N> const& x, Scalar f, Scalar df)
+        {
+            typename dual<Scalar, N>::tangent_type tangent;
+            for (size_t k = 0; k < N; k++)
+            {
+                tangent[k] = df * x.tangent()[k];
+            }
+            return dual<Scalar, N>(f, tangent);
+        }
+
+        /// <summary>Enables the math functions mixing dual and arithmetic types.</summary>
+        template <typename Type, typename Result>
+        using enable_if_arithmetic = typename std::enable_if<std::is_arithmetic<Type>::value, Result>::type;
+    }
+
+    /// <summary>Serialize the value to stream.</summary>
+    template <typename Scalar, size_t N>
+    inline std::ostream& operator<<(std::ostream& output, dual<Scalar, N> const& v) { return output << v.value(); }
+
+    /// <summary>Deserialize the value from stream, the derivatives are zero.</summary>
+    template <typename Scalar, size_t N>
+    inline std::istream& operator>>(std::istream& input, dual<Scalar, N>& v)
+    {
+        Scalar value;
+        input >> value;
+        v = dual<Scalar, N>(value);
+        return input;
+    }
+}
+
+namespace boost { namespace lambda { namespace detail
+{
+    // foreign declaration of promote code
+    template <typename > struct promote_code;
+
+    // Ranks dual above the native real types, so that the arithmetic of
+    // lambda expressions mixing them returns dual.
+    template <typename Scalar, size_t N>
+    struct promote_code<cl::dual<Scalar, N> >
+    {
+        static const int value = 750;
+    };
+}}}
+
+#endif // cl_tape_impl_dual_dual_hpp
@@ -0,0 +1,79 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_dual_duallimits_hpp
+#define cl_tape_impl_dual_duallimits_hpp
+
+#include <cl/tape/impl/dual/dual.hpp>
+#include <limits>
+
+namespace std
+{
+    /// <summary>Provides numeric limits for dual, those of the scalar type.</summary>
+    template <typename Scalar, size_t N>
+    class numeric_limits<cl::dual<Scalar, N>>
+    {
+    public:
+        typedef cl::dual<Scalar, N> dual_type;
+
+        static const bool is_specialized = true;
+
+        static dual_type min() throw() { return numeric_limits<Scalar>::min(); }
+        static dual_type max() throw() { return numeric_limits<Scalar>::max(); }
+        static dual_type lowest() throw() { return numeric_limits<Scalar>::lowest(); }
+
+        static const int digits = numeric_limits<Scalar>::digits;
+        static const int digits10 = numeric_limits<Scalar>::digits10;
+        static const int max_digits10 = numeric_limits<Scalar>::max_digits10;
+
+        static const bool is_signed = numeric_limits<Scalar>::is_signed;
+        static const bool is_integer = numeric_limits<Scalar>::is_integer;
+        static const bool is_exact = numeric_limits<Scalar>::is_exact;
+        static const int radix = numeric_limits<Scalar>::radix;
+        static dual_type epsilon() throw() { return numeric_limits<Scalar>::epsilon(); }
+        static dual_type round_error() throw() { return numeric_limits<Scalar>::round_error(); }
+
+        static const int min_exponent = numeric_limits<Scalar>::min_exponent;
+        static const int min_exponent10 = numeric_limits<Scalar>::min_exponent10;
+        static const int max_exponent = numeric_limits<Scalar>::max_exponent;
+        static const int max_exponent10 = numeric_limits<Scalar>::max_exponent10;
+
+        static const bool has_infinity = numeric_limits<Scalar>::has_infinity;
+        static const bool has_quiet_NaN = numeric_limits<Scalar>::has_quiet_NaN;
+        static const bool has_signaling_NaN = numeric_limits<Scalar>::has_signaling_NaN;
+        static const float_denorm_style has_denorm = numeric_limits<Scalar>::has_denorm;
+        static const bool has_denorm_loss = numeric_limits<Scalar>::has_denorm_loss;
+
+        static dual_type infinity() throw() { return numeric_limits<Scalar>::infinity(); }
+        static dual_type quiet_NaN() throw() { return numeric_limits<Scalar>::quiet_NaN(); }
+        static dual_type signaling_NaN() throw() { return numeric_limits<Scalar>::signaling_NaN(); }
+        static dual_type denorm_min() throw() { return numeric_limits<Scalar>::denorm_min(); }
+
+        static const bool is_iec559 = numeric_limits<Scalar>::is_iec559;
+        static const bool is_bounded = numeric_limits<Scalar>::is_bounded;
+        static const bool is_modulo = numeric_limits<Scalar>::is_modulo;
+
+        static const bool traps = numeric_limits<Scalar>::traps;
+        static const bool tinyness_before = numeric_limits<Scalar>::tinyness_before;
+        static const float_round_style round_style = numeric_limits<Scalar>::round_style;
+    };
+}
+
+#endif // cl_tape_impl_dual_duallimits_hpp
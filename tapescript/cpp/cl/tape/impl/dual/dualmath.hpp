@@ -0,0 +1,364 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_dual_dualmath_hpp
+#define cl_tape_impl_dual_dualmath_hpp
+
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <numeric>
+#include <cl/tape/impl/dual/dual.hpp>
+
+/// <summary>Provides math functions for dual, each one applies the chain rule
+/// to the derivative of the native function.</summary>
+namespace std
+{
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> fabs(cl::dual<Scalar, N> x)
+    {
+        return x.value() < Scalar(0) ? -x : x;
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> abs(cl::dual<Scalar, N> x)
+    {
+        return std::fabs(x);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> floor(cl::dual<Scalar, N> x)
+    {
+        // Piecewise constant, the derivatives are zero.
+        return cl::dual<Scalar, N>(std::floor(x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> ceil(cl::dual<Scalar, N> x)
+    {
+        return cl::dual<Scalar, N>(std::ceil(x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> sqrt(cl::dual<Scalar, N> x)
+    {
+        Scalar f = std::sqrt(x.value());
+        return cl::tapescript::chain(x, f, Scalar(0.5) / f);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> exp(cl::dual<Scalar, N> x)
+    {
+        Scalar f = std::exp(x.value());
+        return cl::tapescript::chain(x, f, f);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> log(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::log(x.value()), Scalar(1) / x.value());
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> log10(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::log10(x.value())
+            , Scalar(1) / (x.value() * std::log(Scalar(10))));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> pow(cl::dual<Scalar, N> x, cl::dual<Scalar, N> y)
+    {
+        Scalar f = std::pow(x.value(), y.value());
+
+        // d(x^y) = y x^(y-1) dx + x^y log(x) dy, the second term only where y varies.
+        typename cl::dual<Scalar, N>::tangent_type tangent;
+        Scalar dx = y.value() * std::pow(x.value(), y.value() - Scalar(1));
+        Scalar dy = x.value() > Scalar(0) ? f * std::log(x.value()) : Scalar(0);
+        for (size_t k = 0; k < N; k++)
+        {
+            tangent[k] = dx * x.tangent()[k] + dy * y.tangent()[k];
+        }
+        return cl::dual<Scalar, N>(f, tangent);
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    pow(cl::dual<Scalar, N> x, Type y)
+    {
+        Scalar p = Scalar(y);
+        return cl::tapescript::chain(x, std::pow(x.value(), p)
+            , p * std::pow(x.value(), p - Scalar(1)));
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    pow(Type x, cl::dual<Scalar, N> y)
+    {
+        Scalar f = std::pow(Scalar(x), y.value());
+        return cl::tapescript::chain(y, f, f * std::log(Scalar(x)));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> sin(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::sin(x.value()), std::cos(x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> cos(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::cos(x.value()), -std::sin(x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> tan(cl::dual<Scalar, N> x)
+    {
+        Scalar f = std::tan(x.value());
+        return cl::tapescript::chain(x, f, Scalar(1) + f * f);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> asin(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::asin(x.value())
+            , Scalar(1) / std::sqrt(Scalar(1) - x.value() * x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> acos(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::acos(x.value())
+            , -Scalar(1) / std::sqrt(Scalar(1) - x.value() * x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> atan(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::atan(x.value())
+            , Scalar(1) / (Scalar(1) + x.value() * x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> atan2(cl::dual<Scalar, N> y, cl::dual<Scalar, N> x)
+    {
+        // d atan2(y, x) = (x dy - y dx) / (x^2 + y^2)
+        Scalar r = x.value() * x.value() + y.value() * y.value();
+        typename cl::dual<Scalar, N>::tangent_type tangent;
+        for (size_t k = 0; k < N; k++)
+        {
+            tangent[k] = (x.value() * y.tangent()[k] - y.value() * x.tangent()[k]) / r;
+        }
+        return cl::dual<Scalar, N>(std::atan2(y.value(), x.value()), tangent);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> sinh(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::sinh(x.value()), std::cosh(x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> cosh(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::cosh(x.value()), std::sinh(x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> tanh(cl::dual<Scalar, N> x)
+    {
+        Scalar f = std::tanh(x.value());
+        return cl::tapescript::chain(x, f, Scalar(1) - f * f);
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    atan2(cl::dual<Scalar, N> y, Type x)
+    {
+        return std::atan2(y, cl::dual<Scalar, N>(x));
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    atan2(Type y, cl::dual<Scalar, N> x)
+    {
+        return std::atan2(cl::dual<Scalar, N>(y), x);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> asinh(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::asinh(x.value())
+            , Scalar(1) / std::sqrt(x.value() * x.value() + Scalar(1)));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> acosh(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::acosh(x.value())
+            , Scalar(1) / std::sqrt(x.value() * x.value() - Scalar(1)));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> atanh(cl::dual<Scalar, N> x)
+    {
+        return cl::tapescript::chain(x, std::atanh(x.value())
+            , Scalar(1) / (Scalar(1) - x.value() * x.value()));
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> fmod(cl::dual<Scalar, N> x, cl::dual<Scalar, N> y)
+    {
+        // x - n y with the integer n = trunc(x / y) held constant.
+        Scalar n = (x.value() - std::fmod(x.value(), y.value())) / y.value();
+        return x - n * y;
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    fmod(cl::dual<Scalar, N> x, Type y)
+    {
+        return std::fmod(x, cl::dual<Scalar, N>(y));
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    fmod(Type x, cl::dual<Scalar, N> y)
+    {
+        return std::fmod(cl::dual<Scalar, N>(x), y);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> modf(cl::dual<Scalar, N> x, cl::dual<Scalar, N>* iptr)
+    {
+        // The integral part is piecewise constant, the fractional part has the derivatives.
+        Scalar intpart;
+        Scalar fractpart = std::modf(x.value(), &intpart);
+        *iptr = cl::dual<Scalar, N>(intpart);
+        return cl::dual<Scalar, N>(fractpart, x.tangent());
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> ldexp(cl::dual<Scalar, N> x, int exp)
+    {
+        return x * std::ldexp(Scalar(1), exp);
+    }
+
+    template <typename Scalar, size_t N>
+    inline cl::dual<Scalar, N> frexp(cl::dual<Scalar, N> x, int* exp)
+    {
+        std::frexp(x.value(), exp);
+        return x * std::ldexp(Scalar(1), -*exp);
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    min(cl::dual<Scalar, N> const& x, Type y)
+    {
+        return y < x ? cl::dual<Scalar, N>(y) : x;
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    min(Type x, cl::dual<Scalar, N> const& y)
+    {
+        return y < x ? y : cl::dual<Scalar, N>(x);
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    max(cl::dual<Scalar, N> const& x, Type y)
+    {
+        return x < y ? cl::dual<Scalar, N>(y) : x;
+    }
+
+    template <typename Scalar, size_t N, typename Type>
+    inline cl::tapescript::enable_if_arithmetic<Type, cl::dual<Scalar, N>>
+    max(Type x, cl::dual<Scalar, N> const& y)
+    {
+        return x < y ? y : cl::dual<Scalar, N>(x);
+    }
+
+    /// <summary>Inner product of dual ranges with a native initial value,
+    /// which is promoted to dual as for native double.</summary>
+    template <typename In1, typename In2>
+    inline typename std::iterator_traits<In1>::value_type::dual_type
+    inner_product(In1 first1, In1 last1, In2 first2, double value)
+    {
+        return std::inner_product(first1, last1, first2
+            , typename std::iterator_traits<In1>::value_type(value));
+    }
+
+    // Arithmetics for std::complex<cl::dual> and native types, which the
+    // templates of std::complex do not convert.
+#define CL_DUAL_COMPLEX_OPERATOR(Op)                                                           \
+    template <typename Scalar, size_t N, typename Type>                                         \
+    inline cl::tapescript::enable_if_arithmetic<Type, std::complex<cl::dual<Scalar, N>>>       \
+    operator Op(std::complex<cl::dual<Scalar, N>> const& lhs, Type rhs)                         \
+    {                                                                                           \
+        return lhs Op cl::dual<Scalar, N>(rhs);                                                 \
+    }                                                                                           \
+                                                                                                \
+    template <typename Scalar, size_t N, typename Type>                                         \
+    inline cl::tapescript::enable_if_arithmetic<Type, std::complex<cl::dual<Scalar, N>>>       \
+    operator Op(Type lhs, std::complex<cl::dual<Scalar, N>> const& rhs)                         \
+    {                                                                                           \
+        return cl::dual<Scalar, N>(lhs) Op rhs;                                                 \
+    }
+
+    CL_DUAL_COMPLEX_OPERATOR(+)
+    CL_DUAL_COMPLEX_OPERATOR(-)
+    CL_DUAL_COMPLEX_OPERATOR(*)
+    CL_DUAL_COMPLEX_OPERATOR(/)
+
+#undef CL_DUAL_COMPLEX_OPERATOR
+
+    template <typename Scalar, size_t N>
+    inline bool isnan(cl::dual<Scalar, N> x)
+    {
+        return std::isnan(x.value());
+    }
+
+    template <typename Scalar, size_t N>
+    inline bool isinf(cl::dual<Scalar, N> x)
+    {
+        return std::isinf(x.value());
+    }
+
+    template <typename Scalar, size_t N>
+    inline bool isfinite(cl::dual<Scalar, N> x)
+    {
+        return std::isfinite(x.value());
+    }
+}
+
+namespace cl
+{
+    // Argument dependent lookup of dual finds the math functions above,
+    // so that the unqualified calls of native double code apply to it.
+    using std::fabs; using std::abs; using std::floor; using std::ceil;
+    using std::sqrt; using std::exp; using std::log; using std::log10; using std::pow;
+    using std::sin; using std::cos; using std::tan; using std::asin; using std::acos; using std::atan; using std::atan2;
+    using std::sinh; using std::cosh; using std::tanh; using std::asinh; using std::acosh; using std::atanh;
+    using std::fmod; using std::modf; using std::ldexp; using std::frexp;
+    using std::isnan; using std::isinf; using std::isfinite;
+}
+
+#endif // cl_tape_impl_dual_dualmath_hpp
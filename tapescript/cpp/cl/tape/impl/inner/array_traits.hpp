@@ -22,6 +22,8 @@ limitations under the License.
 #define cl_tape_impl_tape_inner_traits_hpp
 
 #include <limits>
+#include <algorithm>
+#include <vector>
 #include <valarray>
 #include <sstream>
 
@@ -30,6 +32,8 @@ limitations under the License.
 #endif
 
 #include <cl/tape/impl/tape_fwd.hpp>
+#include <cl/tape/impl/thread_local.hpp>
+#include <cl/tape/impl/inner/lanes.hpp>
 
 namespace cl
 {
@@ -38,7 +42,191 @@ namespace cl
     typedef tape_inner<Eigen::ArrayXd> tape_valueXd;
 #endif
 
-    /// <summary>Traits of array type for using it as tape_inner template parameter.</summary>
+    typedef tape_inner<lanes<double, 4>> tape_value4d;
+    typedef tape_inner<lanes<double, 8>> tape_value8d;
+    typedef tape_inner<lanes<double, 16>> tape_value16d;
+
+    namespace tapescript
+    {
+        /// <summary>Pool of lane buffers of the array type. tape_inner values give
+        /// the storage of their array value back to the pool of the calling thread
+        /// when they are destroyed or resized, and new array values of the same size
+        /// take it from there, so once the pool is warmed up the temporaries of
+        /// tape_inner arithmetic do not allocate. The pool keeps at most max_size
+        /// buffers, further buffers are freed.
+        ///
+        /// A pool is owned by the object which sweeps, e.g. tape_context, and is
+        /// the pool of the calling thread while a scope of it is open. The thread
+        /// only keeps a pointer to it, so nothing is left to free at thread exit.
+        /// Outside of scopes values allocate and free their storage.</summary>
+        template <class Array>
+        class lane_buffer_pool
+        {
+        public:
+            static const size_t max_size = 256;
+
+            /// <summary>Makes the pool the one of the calling thread until the
+            /// scope is closed. Scopes nest, the previous pool is restored.</summary>
+            class scope
+            {
+            public:
+                explicit scope(lane_buffer_pool& pool)
+                    : previous_(current())
+                {
+                    current() = &pool;
+                }
+
+                ~scope()
+                {
+                    current() = previous_;
+                }
+
+            private:
+                scope(scope const&);
+                scope& operator=(scope const&);
+
+                lane_buffer_pool* previous_;
+            };
+
+            lane_buffer_pool()
+                : buffers_()
+            {}
+
+            // The buffers are a cache of the owner, copies start empty.
+            lane_buffer_pool(lane_buffer_pool const&)
+                : buffers_()
+            {}
+
+            lane_buffer_pool& operator=(lane_buffer_pool const&)
+            {
+                return *this;
+            }
+
+            /// <summary>Buffer of count lanes, the values are unspecified.</summary>
+            static Array acquire(size_t count)
+            {
+                lane_buffer_pool* pool = count ? current() : 0;
+                if (pool)
+                {
+                    std::vector<Array>& buffers = pool->buffers_;
+                    for (size_t i = buffers.size(); i-- > 0;)
+                    {
+                        if (size_t(buffers[i].size()) == count)
+                        {
+                            Array result(std::move(buffers[i]));
+                            if (i + 1 != buffers.size())
+                            {
+                                buffers[i] = std::move(buffers.back());
+                            }
+                            buffers.pop_back();
+                            return result;
+                        }
+                    }
+                }
+                if (count)
+                {
+                    allocation_count()++;
+                }
+                return Array(count);
+            }
+
+            /// <summary>Takes the storage of the buffer, which is left empty.</summary>
+            static void release(Array& val)
+            {
+                if (val.size() == 0)
+                {
+                    return;
+                }
+                lane_buffer_pool* pool = current();
+                if (pool && pool->buffers_.size() < max_size)
+                {
+                    if (pool->buffers_.capacity() == 0)
+                    {
+                        pool->buffers_.reserve(max_size);
+                    }
+                    pool->buffers_.push_back(std::move(val));
+                }
+                val = Array();
+            }
+
+            /// <summary>Number of buffers kept by the pool of the calling thread.</summary>
+            static size_t size()
+            {
+                lane_buffer_pool* pool = current();
+                return pool ? pool->buffers_.size() : 0;
+            }
+
+            /// <summary>Number of buffers acquire allocated on the calling thread,
+            /// inside or outside of scopes.</summary>
+            static size_t allocations()
+            {
+                return allocation_count();
+            }
+
+        private:
+            static lane_buffer_pool*& current()
+            {
+                static CL_THREAD_LOCAL lane_buffer_pool* pool = 0;
+                return pool;
+            }
+
+            static size_t& allocation_count()
+            {
+                static CL_THREAD_LOCAL size_t count = 0;
+                return count;
+            }
+
+            std::vector<Array> buffers_;
+        };
+
+        /// <summary>Lane buffers of the values of type Base, owned by objects
+        /// which sweep them. Only array values of tape_inner are pooled, for
+        /// other types the scope does nothing.</summary>
+        template <class Base>
+        struct lane_buffers
+        {
+            struct scope
+            {
+                explicit scope(lane_buffers&) {}
+            };
+        };
+
+        template <class Array>
+        struct lane_buffers<tape_inner<Array>>
+            : lane_buffer_pool<Array>
+        {};
+
+        /// <summary>Lane i of an array, a scalar is the same in every lane.</summary>
+        template <class Scalar>
+        inline Scalar const& lane_at(Scalar const& x, size_t)
+        {
+            return x;
+        }
+
+        template <class Scalar>
+        inline Scalar const& lane_at(std::valarray<Scalar> const& x, size_t i)
+        {
+            return x[i];
+        }
+
+        /// <summary>Number of lanes of an array, zero for a scalar.</summary>
+        template <class Scalar>
+        inline size_t lane_size(Scalar const&)
+        {
+            return 0;
+        }
+
+        template <class Scalar>
+        inline size_t lane_size(std::valarray<Scalar> const& x)
+        {
+            return x.size();
+        }
+    }
+
+    /// <summary>Traits of array type for using it as tape_inner template parameter.
+    /// Besides the functions returning a new array, every math function has a form
+    /// which writes the result to an array of the same size, and acquire and release
+    /// give and take the storage of array values.</summary>
     template <class Array>
     struct array_traits;
 
@@ -46,6 +234,27 @@ namespace cl
     static inline array_type Name(const array_type& x)      \
     {                                                       \
     return Qualifier Name(x);                           \
+    }                                                       \
+                                                            \
+    static inline void Name(const array_type& x, array_type& result) \
+    {                                                       \
+    result = Qualifier Name(x);                         \
+    }
+
+// The result of std:: functions of std::valarray is a new valarray,
+// the in-place form computes the lanes one by one.
+#define CL_INNER_VALARRAY_FUNCTION_TRAITS(Name)             \
+    static inline array_type Name(const array_type& x)      \
+    {                                                       \
+    return std::Name(x);                                \
+    }                                                       \
+                                                            \
+    static inline void Name(const array_type& x, array_type& result) \
+    {                                                       \
+    for (size_t i = 0; i < x.size(); i++)               \
+    {                                                   \
+    result[i] = std::Name(x[i]);                    \
+    }                                                   \
     }
 
 #define CL_INNER_ARRAY_FUNCTION_NOT_DEF(Array, Name)                        \
@@ -53,6 +262,11 @@ namespace cl
     {                                                                       \
     cl::throw_("The function " #Name " is not implemented for " Array); \
     return x;                                                           \
+    }                                                                       \
+                                                                            \
+    static inline void Name(const array_type& x, array_type& result)        \
+    {                                                                       \
+    cl::throw_("The function " #Name " is not implemented for " Array); \
     }
 
     /// <summary>Array traits of std::valaray.</summary>
@@ -65,7 +279,19 @@ namespace cl
 
         static inline array_type get_const(size_t count, scalar_type const& val)
         {
-            return std::valarray<scalar_type>(val, count);
+            array_type result = acquire(count);
+            result = val;
+            return result;
+        }
+
+        static inline array_type acquire(size_t count)
+        {
+            return tapescript::lane_buffer_pool<array_type>::acquire(count);
+        }
+
+        static inline void release(array_type& val)
+        {
+            tapescript::lane_buffer_pool<array_type>::release(val);
         }
 
         static inline array_type get_from_init_list(std::initializer_list<scalar_type> il)
@@ -76,40 +302,40 @@ namespace cl
         template <class Ty1, class Ty2>
         static inline bool operator_Ne(Ty1&& x, Ty2&& y)
         {
-            return all_true(std::forward<Ty1>(x) != std::forward<Ty2>(y));
+            return all_lanes(x, y, [](scalar_type a, scalar_type b) { return a != b; });
         }
 
         template <class Ty1, class Ty2>
         static inline bool operator_Eq(Ty1&& x, Ty2&& y)
         {
-            return all_true(std::forward<Ty1>(x) == std::forward<Ty2>(y));
+            return all_lanes(x, y, [](scalar_type a, scalar_type b) { return a == b; });
         }
 
         template <class Ty1, class Ty2>
         static inline bool operator_Lt(Ty1&& x, Ty2&& y)
         {
-            return all_true(std::forward<Ty1>(x) < std::forward<Ty2>(y));
+            return all_lanes(x, y, [](scalar_type a, scalar_type b) { return a < b; });
         }
 
         template <class Ty1, class Ty2>
         static inline bool operator_Le(Ty1&& x, Ty2&& y)
         {
-            return all_true(std::forward<Ty1>(x) <= std::forward<Ty2>(y));
+            return all_lanes(x, y, [](scalar_type a, scalar_type b) { return a <= b; });
         }
 
-        CL_INNER_ARRAY_FUNCTION_TRAITS(std::, abs)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, acos)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, sqrt)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, asin)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, atan)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, cos)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, sin)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, cosh)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, sinh)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, exp)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, log)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, tan)
-            CL_INNER_ARRAY_FUNCTION_TRAITS(std::, tanh)
+        CL_INNER_VALARRAY_FUNCTION_TRAITS(abs)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(acos)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(sqrt)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(asin)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(atan)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(cos)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(sin)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(cosh)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(sinh)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(exp)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(log)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(tan)
+            CL_INNER_VALARRAY_FUNCTION_TRAITS(tanh)
 
             template <class Ty1, class Ty2>
         static inline array_type pow(const Ty1& x, const Ty2& y)
@@ -117,15 +343,107 @@ namespace cl
             return std::pow(x, y);
         }
 
+        template <class Ty1, class Ty2>
+        static inline void pow(const Ty1& x, const Ty2& y, array_type& result)
+        {
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                result[i] = std::pow(tapescript::lane_at(x, i), tapescript::lane_at(y, i));
+            }
+        }
+
     private:
-        static inline bool all_true(std::valarray<bool> const& val)
+        // True if the comparison holds in every lane, without a valarray<bool> temporary.
+        template <class Ty1, class Ty2, class Cmp>
+        static inline bool all_lanes(Ty1 const& x, Ty2 const& y, Cmp cmp)
         {
-            bool result = true;
-            for (bool item : val)
+            size_t n = std::max(tapescript::lane_size(x), tapescript::lane_size(y));
+            for (size_t i = 0; i < n; i++)
             {
-                result &= item;
+                if (!cmp(tapescript::lane_at(x, i), tapescript::lane_at(y, i)))
+                {
+                    return false;
+                }
             }
-            return result;
+            return true;
+        }
+    };
+
+    /// <summary>Array traits of cl::lanes.</summary>
+    template <class Scalar, size_t N>
+    struct array_traits<lanes<Scalar, N>>
+    {
+        typedef Scalar scalar_type;
+        typedef lanes<Scalar, N> array_type;
+        typedef size_t size_type;
+
+        static inline array_type get_const(size_t count, scalar_type const& val)
+        {
+            return array_type(val, count);
+        }
+
+        // Lanes are stored inline, there is nothing to pool.
+        static inline array_type acquire(size_t count)
+        {
+            return array_type(count);
+        }
+
+        static inline void release(array_type&)
+        {}
+
+        static inline array_type get_from_init_list(std::initializer_list<scalar_type> il)
+        {
+            return array_type(il);
+        }
+
+        template <class Ty1, class Ty2>
+        static inline bool operator_Ne(Ty1&& x, Ty2&& y)
+        {
+            return (std::forward<Ty1>(x) != std::forward<Ty2>(y)).all();
+        }
+
+        template <class Ty1, class Ty2>
+        static inline bool operator_Eq(Ty1&& x, Ty2&& y)
+        {
+            return (std::forward<Ty1>(x) == std::forward<Ty2>(y)).all();
+        }
+
+        template <class Ty1, class Ty2>
+        static inline bool operator_Lt(Ty1&& x, Ty2&& y)
+        {
+            return (std::forward<Ty1>(x) < std::forward<Ty2>(y)).all();
+        }
+
+        template <class Ty1, class Ty2>
+        static inline bool operator_Le(Ty1&& x, Ty2&& y)
+        {
+            return (std::forward<Ty1>(x) <= std::forward<Ty2>(y)).all();
+        }
+
+        CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, abs)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, acos)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, sqrt)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, asin)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, atan)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, cos)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, sin)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, cosh)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, sinh)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, exp)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, log)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, tan)
+            CL_INNER_ARRAY_FUNCTION_TRAITS(cl::, tanh)
+
+            template <class Ty1, class Ty2>
+        static inline array_type pow(const Ty1& x, const Ty2& y)
+        {
+            return cl::pow(x, y);
+        }
+
+        template <class Ty1, class Ty2>
+        static inline void pow(const Ty1& x, const Ty2& y, array_type& result)
+        {
+            result = cl::pow(x, y);
         }
     };
 
@@ -143,7 +461,19 @@ namespace cl
 
         static inline array_type get_const(size_t count, scalar_type const& val)
         {
-            return array_type::Constant(count, val);
+            array_type result = acquire(count);
+            result.setConstant(val);
+            return result;
+        }
+
+        static inline array_type acquire(size_t count)
+        {
+            return tapescript::lane_buffer_pool<array_type>::acquire(count);
+        }
+
+        static inline void release(array_type& val)
+        {
+            tapescript::lane_buffer_pool<array_type>::release(val);
         }
 
         static inline array_type get_from_init_list(std::initializer_list<scalar_type> il)
@@ -200,6 +530,17 @@ namespace cl
         {
             return Eigen::exp(std::log(x) * y);
         }
+
+        template <class Ty>
+        static inline void pow(const array_type& x, const Ty& y, array_type& result)
+        {
+            result = Eigen::pow(x, y);
+        }
+
+        static inline void pow(const scalar_type& x, const array_type& y, array_type& result)
+        {
+            result = Eigen::exp(std::log(x) * y);
+        }
     };
 #endif // CL_EIGEN_ENABLED
 }
@@ -48,7 +48,8 @@ namespace CppAD
 
         size_t size = left.is_array() ? left.size() : right.size();
 
-        typename cl::tape_inner<Array>::array_type result(size);
+        cl::tape_inner<Array> result;
+        result.reserve_lanes(size);
 
         for (size_t i = 0; i < size; i++)
         {
@@ -75,7 +76,8 @@ namespace CppAD
 
         size_t size = left.is_array() ? left.size() : right.size();
 
-        typename cl::tape_inner<Array>::array_type result(size);
+        cl::tape_inner<Array> result;
+        result.reserve_lanes(size);
 
         for (size_t i = 0; i < size; i++)
         {
@@ -191,7 +193,7 @@ namespace CppAD
     template <class Array>
     inline bool abs_geq(const cl::tape_inner<Array>& x, const cl::tape_inner<Array>& y)
     {
-        return std::abs(x) >= std::abs(y);
+        return cl::tapescript::abs(x) >= cl::tapescript::abs(y);
     }
 
 #define CL_ARRAY_CPPAD_STANDARD_MATH_UNARY(Fun) \
@@ -0,0 +1,749 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Polynomial approximations of exp and log are taken from the Cephes
+Mathematical Library, Copyright (C) 1984-2000 Stephen L. Moshier.
+*/
+
+#ifndef cl_tape_impl_inner_lanes_hpp
+#define cl_tape_impl_inner_lanes_hpp
+
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <initializer_list>
+
+#if defined __AVX2__ || defined __AVX512F__
+#   include <immintrin.h>
+#endif
+
+namespace cl
+{
+    /// <summary>Result of lane-wise comparison, bit i is set if the comparison is true for lane i.</summary>
+    template <size_t N>
+    struct lanes_mask
+    {
+        static_assert(N <= 64, "lanes_mask supports up to 64 lanes.");
+
+        lanes_mask(std::uint64_t bits = 0)
+            : bits_(bits)
+        {}
+
+        bool operator[](size_t i) const
+        {
+            return ((bits_ >> i) & 1) != 0;
+        }
+
+        // Returns true if the comparison is true for every lane.
+        bool all() const
+        {
+            return bits_ == (N == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << N) - 1);
+        }
+
+        // Returns true if the comparison is true for some lane.
+        bool any() const
+        {
+            return bits_ != 0;
+        }
+
+        std::uint64_t bits_;
+    };
+
+    namespace lanes_impl
+    {
+        /// <summary>Register of W scalars with the operations used by lanes.
+        /// W = 1 is the portable implementation, wider registers are defined
+        /// for double when AVX2 or AVX-512 code generation is enabled.</summary>
+        template <class Scalar, size_t W>
+        struct simd;
+
+        template <class Scalar>
+        struct simd<Scalar, 1>
+        {
+            typedef Scalar reg;
+
+            static inline reg load(const Scalar* p) { return *p; }
+            static inline void store(Scalar* p, reg x) { *p = x; }
+            static inline reg set1(Scalar x) { return x; }
+
+            static inline reg add(reg x, reg y) { return x + y; }
+            static inline reg sub(reg x, reg y) { return x - y; }
+            static inline reg mul(reg x, reg y) { return x * y; }
+            static inline reg div(reg x, reg y) { return x / y; }
+            static inline reg neg(reg x) { return -x; }
+            static inline reg abs(reg x) { return std::abs(x); }
+            static inline reg sqrt(reg x) { return std::sqrt(x); }
+            static inline reg exp(reg x) { return std::exp(x); }
+            static inline reg log(reg x) { return std::log(x); }
+            static inline reg pow(reg x, reg y) { return std::pow(x, y); }
+
+            static inline std::uint64_t ne(reg x, reg y) { return x != y; }
+            static inline std::uint64_t eq(reg x, reg y) { return x == y; }
+            static inline std::uint64_t lt(reg x, reg y) { return x < y; }
+            static inline std::uint64_t le(reg x, reg y) { return x <= y; }
+        };
+
+        // Coefficients of the Cephes approximations.
+        struct cephes
+        {
+            static double exp_hi() { return 709.78271289338399678773; }
+            static double exp_lo() { return -708.39641853226410621632; }
+            static double log2e() { return 1.4426950408889634073599; }
+            static double exp_c1() { return 6.93145751953125E-1; }
+            static double exp_c2() { return 1.42860682030941723212E-6; }
+
+            static const double* exp_p()
+            {
+                static const double p[] = { 1.26177193074810590878E-4, 3.02994407707441961300E-2, 9.99999999999999999910E-1 };
+                return p;
+            }
+
+            static const double* exp_q()
+            {
+                static const double q[] = { 3.00198505138664455042E-6, 2.52448340349684104192E-3
+                    , 2.27265548208155028766E-1, 2.00000000000000000009E0 };
+                return q;
+            }
+
+            static double sqrth() { return 0.70710678118654752440; }
+            static double log_c1() { return 2.121944400546905827679E-4; }
+            static double log_c2() { return 0.693359375; }
+
+            static const double* log_p()
+            {
+                static const double p[] = { 1.01875663804580931796E-4, 4.97494994976747001425E-1, 4.70579119878881725854E0
+                    , 1.44989225341610930846E1, 1.79368678507819816313E1, 7.70838733755885391666E0 };
+                return p;
+            }
+
+            // Leading coefficient is one.
+            static const double* log_q()
+            {
+                static const double q[] = { 1.12873587189167450590E1, 4.52279145837532221105E1, 8.29875266912776603211E1
+                    , 7.11544750618563894466E1, 2.31251620126765340583E1 };
+                return q;
+            }
+        };
+
+        // exp and log of a register, shared by AVX2 and AVX-512 implementations.
+        template <class Simd>
+        struct simd_math
+        {
+            typedef typename Simd::reg reg;
+
+            static inline reg polevl(reg x, const double* c, size_t degree)
+            {
+                reg result = Simd::set1(c[0]);
+                for (size_t i = 1; i <= degree; i++)
+                {
+                    result = Simd::add(Simd::mul(result, x), Simd::set1(c[i]));
+                }
+                return result;
+            }
+
+            static inline reg p1evl(reg x, const double* c, size_t degree)
+            {
+                reg result = Simd::add(x, Simd::set1(c[0]));
+                for (size_t i = 1; i < degree; i++)
+                {
+                    result = Simd::add(Simd::mul(result, x), Simd::set1(c[i]));
+                }
+                return result;
+            }
+
+            static inline reg exp(reg x)
+            {
+                reg arg = x;
+                x = Simd::min(Simd::max(x, Simd::set1(cephes::exp_lo())), Simd::set1(cephes::exp_hi()));
+
+                // exp(x) = exp(g) 2^n, |g| <= ln(2) / 2
+                reg n = Simd::round(Simd::mul(x, Simd::set1(cephes::log2e())));
+                x = Simd::sub(x, Simd::mul(n, Simd::set1(cephes::exp_c1())));
+                x = Simd::sub(x, Simd::mul(n, Simd::set1(cephes::exp_c2())));
+
+                // exp(g) = 1 + 2 g P(g^2) / (Q(g^2) - g P(g^2))
+                reg xx = Simd::mul(x, x);
+                reg px = Simd::mul(x, polevl(xx, cephes::exp_p(), 2));
+                reg qx = polevl(xx, cephes::exp_q(), 3);
+                x = Simd::div(px, Simd::sub(qx, px));
+                x = Simd::add(Simd::set1(1.0), Simd::add(x, x));
+
+                x = Simd::scale(x, n);
+                x = Simd::select(Simd::gt(arg, Simd::set1(cephes::exp_hi())), Simd::set1(std::numeric_limits<double>::infinity()), x);
+                x = Simd::select(Simd::lt_reg(arg, Simd::set1(cephes::exp_lo())), Simd::set1(0.0), x);
+                return Simd::select(Simd::unordered(arg), arg, x);
+            }
+
+            static inline reg log(reg x)
+            {
+                reg arg = x;
+
+                // x = m 2^e, 0.5 <= m < 1
+                reg e;
+                reg m = Simd::frexp(x, e);
+
+                // m < sqrt(1/2): x = 2m - 1, e = e - 1; otherwise x = m - 1
+                auto small = Simd::lt_reg(m, Simd::set1(cephes::sqrth()));
+                e = Simd::sub(e, Simd::select(small, Simd::set1(1.0), Simd::set1(0.0)));
+                x = Simd::sub(Simd::add(m, Simd::select(small, m, Simd::set1(0.0))), Simd::set1(1.0));
+
+                reg z = Simd::mul(x, x);
+                reg y = Simd::div(Simd::mul(x, Simd::mul(z, polevl(x, cephes::log_p(), 5)))
+                    , p1evl(x, cephes::log_q(), 5));
+                y = Simd::sub(y, Simd::mul(e, Simd::set1(cephes::log_c1())));
+                y = Simd::sub(y, Simd::mul(z, Simd::set1(0.5)));
+                z = Simd::add(x, y);
+                z = Simd::add(z, Simd::mul(e, Simd::set1(cephes::log_c2())));
+
+                // log(+inf) = +inf, log(0) = -inf, log(x < 0) = nan, log(nan) = nan
+                z = Simd::select(Simd::eq_reg(arg, Simd::set1(std::numeric_limits<double>::infinity())), arg, z);
+                z = Simd::select(Simd::eq_reg(arg, Simd::set1(0.0)), Simd::set1(-std::numeric_limits<double>::infinity()), z);
+                z = Simd::select(Simd::lt_reg(arg, Simd::set1(0.0)), Simd::set1(std::numeric_limits<double>::quiet_NaN()), z);
+                return Simd::select(Simd::unordered(arg), arg, z);
+            }
+        };
+
+#if defined __AVX2__
+        /// <summary>Four doubles in AVX2 register.</summary>
+        template <>
+        struct simd<double, 4>
+        {
+            typedef __m256d reg;
+
+            static inline reg load(const double* p) { return _mm256_loadu_pd(p); }
+            static inline void store(double* p, reg x) { _mm256_storeu_pd(p, x); }
+            static inline reg set1(double x) { return _mm256_set1_pd(x); }
+
+            static inline reg add(reg x, reg y) { return _mm256_add_pd(x, y); }
+            static inline reg sub(reg x, reg y) { return _mm256_sub_pd(x, y); }
+            static inline reg mul(reg x, reg y) { return _mm256_mul_pd(x, y); }
+            static inline reg div(reg x, reg y) { return _mm256_div_pd(x, y); }
+            static inline reg min(reg x, reg y) { return _mm256_min_pd(x, y); }
+            static inline reg max(reg x, reg y) { return _mm256_max_pd(x, y); }
+            static inline reg neg(reg x) { return _mm256_xor_pd(x, _mm256_set1_pd(-0.0)); }
+            static inline reg abs(reg x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+            static inline reg sqrt(reg x) { return _mm256_sqrt_pd(x); }
+            static inline reg round(reg x) { return _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+            // Comparisons returning register masks.
+            static inline reg gt(reg x, reg y) { return _mm256_cmp_pd(x, y, _CMP_GT_OQ); }
+            static inline reg lt_reg(reg x, reg y) { return _mm256_cmp_pd(x, y, _CMP_LT_OQ); }
+            static inline reg eq_reg(reg x, reg y) { return _mm256_cmp_pd(x, y, _CMP_EQ_OQ); }
+            static inline reg unordered(reg x) { return _mm256_cmp_pd(x, x, _CMP_UNORD_Q); }
+            static inline reg select(reg mask, reg x, reg y) { return _mm256_blendv_pd(y, x, mask); }
+
+            // Comparisons returning lane bits.
+            static inline std::uint64_t ne(reg x, reg y) { return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_NEQ_UQ)); }
+            static inline std::uint64_t eq(reg x, reg y) { return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ)); }
+            static inline std::uint64_t lt(reg x, reg y) { return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_LT_OQ)); }
+            static inline std::uint64_t le(reg x, reg y) { return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_LE_OQ)); }
+
+            // x 2^n for integer valued n, |n| <= 1024.
+            static inline reg scale(reg x, reg n)
+            {
+                // 2^n is split in two factors to cover subnormal results
+                __m128i n1 = _mm256_cvtpd_epi32(_mm256_mul_pd(n, _mm256_set1_pd(0.5)));
+                __m128i n2 = _mm_sub_epi32(_mm256_cvtpd_epi32(n), n1);
+                return _mm256_mul_pd(_mm256_mul_pd(x, pow2(n1)), pow2(n2));
+            }
+
+            // Mantissa in [0.5, 1) and exponent of x > 0.
+            static inline reg frexp(reg x, reg& e)
+            {
+                // subnormal numbers are normalized first
+                reg subnormal = _mm256_cmp_pd(x, _mm256_set1_pd(std::numeric_limits<double>::min()), _CMP_LT_OQ);
+                x = select(subnormal, _mm256_mul_pd(x, _mm256_set1_pd(18014398509481984.0)), x);
+
+                __m256i bits = _mm256_castpd_si256(x);
+                __m256i exponent = _mm256_and_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x7ff));
+
+                // exponent as double: 2^52 + k has k in the low bits
+                reg k = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(exponent, _mm256_set1_epi64x(0x4330000000000000))), _mm256_set1_pd(4503599627370496.0));
+                e = _mm256_sub_pd(k, _mm256_set1_pd(1022.0));
+                e = _mm256_sub_pd(e, select(subnormal, _mm256_set1_pd(54.0), _mm256_setzero_pd()));
+
+                __m256i mantissa = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x800fffffffffffff)), _mm256_set1_epi64x(0x3fe0000000000000));
+                return _mm256_castsi256_pd(mantissa);
+            }
+
+            static inline reg exp(reg x) { return simd_math<simd>::exp(x); }
+            static inline reg log(reg x) { return simd_math<simd>::log(x); }
+
+        private:
+            // 2^n for four int32 values.
+            static inline reg pow2(__m128i n)
+            {
+                __m256i biased = _mm256_add_epi64(_mm256_cvtepi32_epi64(n), _mm256_set1_epi64x(1023));
+                return _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+            }
+        };
+#endif
+
+#if defined __AVX512F__
+        /// <summary>Eight doubles in AVX-512 register.</summary>
+        template <>
+        struct simd<double, 8>
+        {
+            typedef __m512d reg;
+
+            static inline reg load(const double* p) { return _mm512_loadu_pd(p); }
+            static inline void store(double* p, reg x) { _mm512_storeu_pd(p, x); }
+            static inline reg set1(double x) { return _mm512_set1_pd(x); }
+
+            static inline reg add(reg x, reg y) { return _mm512_add_pd(x, y); }
+            static inline reg sub(reg x, reg y) { return _mm512_sub_pd(x, y); }
+            static inline reg mul(reg x, reg y) { return _mm512_mul_pd(x, y); }
+            static inline reg div(reg x, reg y) { return _mm512_div_pd(x, y); }
+            static inline reg min(reg x, reg y) { return _mm512_min_pd(x, y); }
+            static inline reg max(reg x, reg y) { return _mm512_max_pd(x, y); }
+            static inline reg neg(reg x) { return _mm512_sub_pd(_mm512_setzero_pd(), x); }
+            static inline reg abs(reg x) { return _mm512_abs_pd(x); }
+            static inline reg sqrt(reg x) { return _mm512_sqrt_pd(x); }
+            static inline reg round(reg x) { return _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+            // Lane masks are used as register masks.
+            struct mask
+            {
+                __mmask8 bits_;
+            };
+
+            static inline mask gt(reg x, reg y) { return mask{ _mm512_cmp_pd_mask(x, y, _CMP_GT_OQ) }; }
+            static inline mask lt_reg(reg x, reg y) { return mask{ _mm512_cmp_pd_mask(x, y, _CMP_LT_OQ) }; }
+            static inline mask eq_reg(reg x, reg y) { return mask{ _mm512_cmp_pd_mask(x, y, _CMP_EQ_OQ) }; }
+            static inline mask unordered(reg x) { return mask{ _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q) }; }
+            static inline reg select(mask m, reg x, reg y) { return _mm512_mask_blend_pd(m.bits_, y, x); }
+
+            static inline std::uint64_t ne(reg x, reg y) { return _mm512_cmp_pd_mask(x, y, _CMP_NEQ_UQ); }
+            static inline std::uint64_t eq(reg x, reg y) { return _mm512_cmp_pd_mask(x, y, _CMP_EQ_OQ); }
+            static inline std::uint64_t lt(reg x, reg y) { return _mm512_cmp_pd_mask(x, y, _CMP_LT_OQ); }
+            static inline std::uint64_t le(reg x, reg y) { return _mm512_cmp_pd_mask(x, y, _CMP_LE_OQ); }
+
+            // x 2^n, subnormal and overflowing results are handled by scalef.
+            static inline reg scale(reg x, reg n) { return _mm512_scalef_pd(x, n); }
+
+            // Mantissa in [0.5, 1) and exponent of x > 0, getexp handles subnormal numbers.
+            static inline reg frexp(reg x, reg& e)
+            {
+                e = _mm512_add_pd(_mm512_getexp_pd(x), _mm512_set1_pd(1.0));
+                return _mm512_getmant_pd(x, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_zero);
+            }
+
+            static inline reg exp(reg x) { return simd_math<simd>::exp(x); }
+            static inline reg log(reg x) { return simd_math<simd>::log(x); }
+        };
+#endif
+
+        /// <summary>Widest register which divides the number of lanes.</summary>
+        template <class Scalar, size_t N>
+        struct simd_width
+        {
+            static const size_t value = 1;
+        };
+
+        template <size_t N>
+        struct simd_width<double, N>
+        {
+#if defined __AVX512F__
+            static const size_t value = N % 8 == 0 ? 8 : (N % 4 == 0 ? 4 : 1);
+#elif defined __AVX2__
+            static const size_t value = N % 4 == 0 ? 4 : 1;
+#else
+            static const size_t value = 1;
+#endif
+        };
+
+        /// <summary>Lane loops over registers of simd_width.</summary>
+        template <class Scalar, size_t N>
+        struct kernels
+        {
+            static const size_t W = simd_width<Scalar, N>::value;
+            typedef simd<Scalar, W> simd_type;
+            typedef typename simd_type::reg reg;
+
+            template <class Op>
+            static inline void unary(const Scalar* x, Scalar* r, Op op)
+            {
+                for (size_t i = 0; i < N; i += W)
+                {
+                    simd_type::store(r + i, op(simd_type::load(x + i)));
+                }
+            }
+
+            template <class Op>
+            static inline void binary(const Scalar* x, const Scalar* y, Scalar* r, Op op)
+            {
+                for (size_t i = 0; i < N; i += W)
+                {
+                    simd_type::store(r + i, op(simd_type::load(x + i), simd_type::load(y + i)));
+                }
+            }
+
+            template <class Op>
+            static inline void binary(const Scalar* x, Scalar y, Scalar* r, Op op)
+            {
+                reg yy = simd_type::set1(y);
+                for (size_t i = 0; i < N; i += W)
+                {
+                    simd_type::store(r + i, op(simd_type::load(x + i), yy));
+                }
+            }
+
+            template <class Op>
+            static inline void binary(Scalar x, const Scalar* y, Scalar* r, Op op)
+            {
+                reg xx = simd_type::set1(x);
+                for (size_t i = 0; i < N; i += W)
+                {
+                    simd_type::store(r + i, op(xx, simd_type::load(y + i)));
+                }
+            }
+
+            template <class Cmp>
+            static inline std::uint64_t compare(const Scalar* x, const Scalar* y, Cmp cmp)
+            {
+                std::uint64_t bits = 0;
+                for (size_t i = 0; i < N; i += W)
+                {
+                    bits |= cmp(simd_type::load(x + i), simd_type::load(y + i)) << i;
+                }
+                return bits;
+            }
+
+            template <class Cmp>
+            static inline std::uint64_t compare(const Scalar* x, Scalar y, Cmp cmp)
+            {
+                std::uint64_t bits = 0;
+                reg yy = simd_type::set1(y);
+                for (size_t i = 0; i < N; i += W)
+                {
+                    bits |= cmp(simd_type::load(x + i), yy) << i;
+                }
+                return bits;
+            }
+
+            template <class Cmp>
+            static inline std::uint64_t compare(Scalar x, const Scalar* y, Cmp cmp)
+            {
+                std::uint64_t bits = 0;
+                reg xx = simd_type::set1(x);
+                for (size_t i = 0; i < N; i += W)
+                {
+                    bits |= cmp(xx, simd_type::load(y + i)) << i;
+                }
+                return bits;
+            }
+        };
+    }
+
+    /// <summary>Fixed number N of scalar lanes stored inline.
+    /// Used as tape_inner array type instead of std::valarray, values do
+    /// not allocate and lane loops are compiled to AVX2 or AVX-512 code
+    /// when the corresponding instruction set is enabled for the compiler.
+    /// The storage is not over-aligned because CppAD containers do not
+    /// respect extended alignment, unaligned loads are used instead.</summary>
+    template <class Scalar, size_t N>
+    class lanes
+    {
+        typedef lanes_impl::kernels<Scalar, N> kernels;
+        typedef typename kernels::simd_type simd;
+        typedef typename kernels::reg reg;
+
+    public:
+        typedef Scalar value_type;
+
+        lanes()
+        {
+            std::fill(data_, data_ + N, Scalar());
+        }
+
+        // Zero lanes, count must be equal N.
+        explicit lanes(size_t count)
+        {
+            assert(count == N);
+            std::fill(data_, data_ + N, Scalar());
+        }
+
+        // All lanes are equal val, count must be equal N.
+        lanes(Scalar const& val, size_t count)
+        {
+            assert(count == N);
+            std::fill(data_, data_ + N, val);
+        }
+
+        // Lanes from initializer list of N elements.
+        lanes(std::initializer_list<Scalar> il)
+        {
+            assert(il.size() == N);
+            std::copy(il.begin(), il.end(), data_);
+        }
+
+        // Lanes from N elements of the buffer.
+        explicit lanes(const Scalar* p)
+        {
+            std::copy(p, p + N, data_);
+        }
+
+        static size_t size()
+        {
+            return N;
+        }
+
+        // Number of lanes is fixed, the values are set to zero as std::valarray::resize does.
+        void resize(size_t count, Scalar const& val = Scalar())
+        {
+            assert(count == N);
+            std::fill(data_, data_ + N, val);
+        }
+
+        Scalar& operator[](size_t i) { return data_[i]; }
+        Scalar const& operator[](size_t i) const { return data_[i]; }
+
+        Scalar* begin() { return data_; }
+        Scalar const* begin() const { return data_; }
+        Scalar* end() { return data_ + N; }
+        Scalar const* end() const { return data_ + N; }
+
+        Scalar sum() const
+        {
+            Scalar result = Scalar();
+            for (size_t i = 0; i < N; i++)
+            {
+                result += data_[i];
+            }
+            return result;
+        }
+
+        lanes operator-() const
+        {
+            lanes result;
+            kernels::unary(data_, result.data_, [](reg x) { return simd::neg(x); });
+            return result;
+        }
+
+        lanes& operator=(Scalar const& val)
+        {
+            std::fill(data_, data_ + N, val);
+            return *this;
+        }
+
+#define CL_LANES_ASSIGN_OPERATOR(Op, Name)                                                      \
+        lanes& operator Op##=(lanes const& y)                                                   \
+        {                                                                                       \
+            kernels::binary(data_, y.data_, data_, [](reg a, reg b) { return simd::Name(a, b); }); \
+            return *this;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        lanes& operator Op##=(Scalar const& y)                                                  \
+        {                                                                                       \
+            kernels::binary(data_, y, data_, [](reg a, reg b) { return simd::Name(a, b); });    \
+            return *this;                                                                       \
+        }
+        CL_LANES_ASSIGN_OPERATOR(+, add)
+        CL_LANES_ASSIGN_OPERATOR(-, sub)
+        CL_LANES_ASSIGN_OPERATOR(*, mul)
+        CL_LANES_ASSIGN_OPERATOR(/, div)
+#undef CL_LANES_ASSIGN_OPERATOR
+
+        // Lane-wise function of one argument.
+        template <class Op>
+        lanes map(Op op) const
+        {
+            lanes result;
+            kernels::unary(data_, result.data_, op);
+            return result;
+        }
+
+        // Lane-wise function of two arguments, each of them is lanes or scalar.
+        template <class X, class Y, class Op>
+        static lanes zip(X const& x, Y const& y, Op op)
+        {
+            lanes result;
+            kernels::binary(ptr(x), ptr(y), result.data_, op);
+            return result;
+        }
+
+        // Lane-wise comparison, each argument is lanes or scalar.
+        template <class X, class Y, class Cmp>
+        static lanes_mask<N> compare(X const& x, Y const& y, Cmp cmp)
+        {
+            return lanes_mask<N>(kernels::compare(ptr(x), ptr(y), cmp));
+        }
+
+    private:
+        static const Scalar* ptr(lanes const& x) { return x.data_; }
+        static Scalar ptr(Scalar const& x) { return x; }
+
+        Scalar data_[N];
+    };
+
+    template <class Scalar, size_t N>
+    inline Scalar* begin(lanes<Scalar, N>& x) { return x.begin(); }
+
+    template <class Scalar, size_t N>
+    inline Scalar const* begin(lanes<Scalar, N> const& x) { return x.begin(); }
+
+    template <class Scalar, size_t N>
+    inline Scalar* end(lanes<Scalar, N>& x) { return x.end(); }
+
+    template <class Scalar, size_t N>
+    inline Scalar const* end(lanes<Scalar, N> const& x) { return x.end(); }
+
+    // Arithmetic binary operations.
+#define CL_LANES_BIN_OPERATOR(Op, Name)                                                         \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes<Scalar, N> operator Op(lanes<Scalar, N> const& x, lanes<Scalar, N> const& y)   \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return lanes<Scalar, N>::zip(x, y, [](reg a, reg b) { return simd::Name(a, b); });     \
+    }                                                                                           \
+                                                                                                \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes<Scalar, N> operator Op(lanes<Scalar, N> const& x, Scalar const& y)             \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return lanes<Scalar, N>::zip(x, y, [](reg a, reg b) { return simd::Name(a, b); });     \
+    }                                                                                           \
+                                                                                                \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes<Scalar, N> operator Op(Scalar const& x, lanes<Scalar, N> const& y)             \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return lanes<Scalar, N>::zip(x, y, [](reg a, reg b) { return simd::Name(a, b); });     \
+    }
+    CL_LANES_BIN_OPERATOR(+, add)
+    CL_LANES_BIN_OPERATOR(-, sub)
+    CL_LANES_BIN_OPERATOR(*, mul)
+    CL_LANES_BIN_OPERATOR(/, div)
+#undef CL_LANES_BIN_OPERATOR
+
+    // Lane-wise comparisons.
+#define CL_LANES_CMP_OPERATOR(Op, Name, Swap)                                                   \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes_mask<N> operator Op(lanes<Scalar, N> const& x, lanes<Scalar, N> const& y)      \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return lanes<Scalar, N>::compare(Swap(x, y), [](reg a, reg b) { return simd::Name(a, b); }); \
+    }                                                                                           \
+                                                                                                \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes_mask<N> operator Op(lanes<Scalar, N> const& x, Scalar const& y)                \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return lanes<Scalar, N>::compare(Swap(x, y), [](reg a, reg b) { return simd::Name(a, b); }); \
+    }                                                                                           \
+                                                                                                \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes_mask<N> operator Op(Scalar const& x, lanes<Scalar, N> const& y)                \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return lanes<Scalar, N>::compare(Swap(x, y), [](reg a, reg b) { return simd::Name(a, b); }); \
+    }
+#define CL_LANES_ARGS(x, y) x, y
+#define CL_LANES_SWAP(x, y) y, x
+    CL_LANES_CMP_OPERATOR(!=, ne, CL_LANES_ARGS)
+    CL_LANES_CMP_OPERATOR(==, eq, CL_LANES_ARGS)
+    CL_LANES_CMP_OPERATOR(< , lt, CL_LANES_ARGS)
+    CL_LANES_CMP_OPERATOR(<=, le, CL_LANES_ARGS)
+    CL_LANES_CMP_OPERATOR(> , lt, CL_LANES_SWAP)
+    CL_LANES_CMP_OPERATOR(>=, le, CL_LANES_SWAP)
+#undef CL_LANES_SWAP
+#undef CL_LANES_ARGS
+#undef CL_LANES_CMP_OPERATOR
+
+    // Math functions with register implementation.
+#define CL_LANES_FUNCTION(Name)                                                                 \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes<Scalar, N> Name(lanes<Scalar, N> const& x)                                     \
+    {                                                                                           \
+        typedef typename lanes_impl::kernels<Scalar, N>::simd_type simd;                        \
+        typedef typename simd::reg reg;                                                         \
+        return x.map([](reg a) { return simd::Name(a); });                                     \
+    }
+    CL_LANES_FUNCTION(abs)
+    CL_LANES_FUNCTION(sqrt)
+    CL_LANES_FUNCTION(exp)
+    CL_LANES_FUNCTION(log)
+#undef CL_LANES_FUNCTION
+
+    // Math functions evaluated lane by lane.
+#define CL_LANES_STD_FUNCTION(Name)                                                             \
+    template <class Scalar, size_t N>                                                           \
+    inline lanes<Scalar, N> Name(lanes<Scalar, N> const& x)                                     \
+    {                                                                                           \
+        lanes<Scalar, N> result;                                                                \
+        for (size_t i = 0; i < N; i++)                                                          \
+        {                                                                                       \
+            result[i] = std::Name(x[i]);                                                        \
+        }                                                                                       \
+        return result;                                                                          \
+    }
+    CL_LANES_STD_FUNCTION(acos)
+    CL_LANES_STD_FUNCTION(asin)
+    CL_LANES_STD_FUNCTION(atan)
+    CL_LANES_STD_FUNCTION(cos)
+    CL_LANES_STD_FUNCTION(sin)
+    CL_LANES_STD_FUNCTION(cosh)
+    CL_LANES_STD_FUNCTION(sinh)
+    CL_LANES_STD_FUNCTION(tan)
+    CL_LANES_STD_FUNCTION(tanh)
+#undef CL_LANES_STD_FUNCTION
+
+    // Power x^y = exp(y log(x)) in registers for positive finite x, relative error
+    // grows as |y log(x)| times machine epsilon. Other bases and lanes without
+    // register implementation are evaluated by std::pow lane by lane.
+    template <class Scalar, size_t N>
+    inline lanes<Scalar, N> pow(lanes<Scalar, N> const& x, lanes<Scalar, N> const& y)
+    {
+        bool positive = lanes_impl::simd_width<Scalar, N>::value > 1
+            && (x > Scalar(0)).all() && (x < std::numeric_limits<Scalar>::infinity()).all();
+        if (positive)
+        {
+            return exp(y * log(x));
+        }
+
+        lanes<Scalar, N> result;
+        for (size_t i = 0; i < N; i++)
+        {
+            result[i] = std::pow(x[i], y[i]);
+        }
+        return result;
+    }
+
+    template <class Scalar, size_t N>
+    inline lanes<Scalar, N> pow(lanes<Scalar, N> const& x, Scalar const& y)
+    {
+        return pow(x, lanes<Scalar, N>(y, N));
+    }
+
+    template <class Scalar, size_t N>
+    inline lanes<Scalar, N> pow(Scalar const& x, lanes<Scalar, N> const& y)
+    {
+        return pow(lanes<Scalar, N>(x, N), y);
+    }
+}
+
+#endif // cl_tape_impl_inner_lanes_hpp
@@ -40,6 +40,9 @@ namespace cl
         typedef typename traits::array_type array_type;
         typedef typename traits::size_type size_type;
 
+        // Scalar type of the lanes under the name CppAD::epsilon expects.
+        typedef scalar_type value_type;
+
         enum Mode
         {
             ScalarMode = 1 << 0
@@ -54,14 +57,33 @@ namespace cl
             , array_value_()
         {}
 
-        tape_inner(const tape_inner&) = default;
+        // Array storage of the copy is taken from the lane buffer pool.
+        tape_inner(const tape_inner& other)
+            : mode_(other.mode_)
+            , scalar_value_(other.scalar_value_)
+            , array_value_()
+        {
+            if (other.is_array())
+            {
+                array_value_ = traits::acquire(other.size());
+                array_value_ = other.array_value_;
+            }
+        }
+
+        tape_inner(tape_inner&& other)
+            : mode_(other.mode_)
+            , scalar_value_(other.scalar_value_)
+            , array_value_(std::move(other.array_value_))
+        {}
 
         // Array mode is used for array value storage.
         tape_inner(const array_type& v)
             : mode_(ArrayMode)
             , scalar_value_()
-            , array_value_(v)
-        {}
+            , array_value_(traits::acquire(v.size()))
+        {
+            array_value_ = v;
+        }
 
         tape_inner(array_type&& v)
             : mode_(ArrayMode)
@@ -83,6 +105,40 @@ namespace cl
             , array_value_(traits::get_from_init_list(il))
         {}
 
+        // Array storage goes back to the lane buffer pool.
+        ~tape_inner()
+        {
+            traits::release(array_value_);
+        }
+
+        // The array storage of the left side is kept if it has the size of the right side.
+        tape_inner& operator=(const tape_inner& right)
+        {
+            if (this != &right)
+            {
+                if (right.is_array())
+                {
+                    reserve_lanes(right.size());
+                    array_value_ = right.array_value_;
+                }
+                mode_ = right.mode_;
+                scalar_value_ = right.scalar_value_;
+            }
+            return *this;
+        }
+
+        // The array storages are swapped, the right side frees the old one.
+        tape_inner& operator=(tape_inner&& right)
+        {
+            if (this != &right)
+            {
+                std::swap(array_value_, right.array_value_);
+                mode_ = right.mode_;
+                scalar_value_ = right.scalar_value_;
+            }
+            return *this;
+        }
+
         // Returns true if scalar mode used (ordinary or intrusive).
         bool is_scalar() const
         {
@@ -134,7 +190,13 @@ namespace cl
             {
                 return -scalar_value_;
             }
-            return tape_inner(-array_value_);
+            tape_inner result;
+            result.reserve_lanes(size());
+            for (size_t i = 0; i < size(); i++)
+            {
+                result.array_value_[i] = -array_value_[i];
+            }
+            return result;
         }
 
         // Returns a new tape_inner of the same size with values which are acquired
@@ -145,10 +207,11 @@ namespace cl
             {
                 return func(scalar_value_);
             }
-            array_type result(array_value_.size());
-            for (size_type i = 0; i < result.size(); i++)
+            tape_inner result;
+            result.reserve_lanes(size());
+            for (size_t i = 0; i < size(); i++)
             {
-                result[i] = func(array_value_[i]);
+                result.array_value_[i] = func(array_value_[i]);
             }
             return result;
         }
@@ -171,8 +234,10 @@ namespace cl
             }                                                                                   \
             else if (is_scalar() && right.is_array())                                           \
             {                                                                                   \
-                array_value_ = scalar_value_ Op right.array_value_;                             \
-                mode_ = ArrayMode;                                                              \
+                scalar_type left = scalar_value_;                                               \
+                reserve_lanes(right.size());                                                    \
+                array_value_ = left;                                                            \
+                array_value_ Op##= right.array_value_;                                          \
             }                                                                                   \
             else if (is_array() && right.is_array())                                            \
             {                                                                                   \
@@ -224,8 +289,24 @@ namespace cl
 
         void resize(size_t size)
         {
+            reserve_lanes(size);
+            for (size_t i = 0; i < size; i++)
+            {
+                array_value_[i] = scalar_type(0);
+            }
+        }
+
+        // Switches to array mode with the given number of lanes whose values are
+        // unspecified. The array storage is kept if it has this size and is
+        // exchanged with the lane buffer pool otherwise.
+        void reserve_lanes(size_t size)
+        {
+            if (size_t(array_value_.size()) != size)
+            {
+                traits::release(array_value_);
+                array_value_ = traits::acquire(size);
+            }
             mode_ = ArrayMode;
-            array_value_.resize(size);
         }
 
         scalar_type* begin()
@@ -296,59 +377,212 @@ namespace cl
     }
 
 
-    // Arithmetic binary operations.
-#define CL_BIN_INNER_ARRAY_OPERATOR(Op)                                                         \
+    namespace tapescript
+    {
+        // Arithmetic operations writing to the existing value z, which is not one
+        // of the arguments. The array storage of z is reused if it has the size
+        // of the result, so the sweeps compute into their Taylor rows in place.
+#define CL_INNER_ARRAY_ASSIGN_FUNCTION(Name, Op)                                                \
+        template <class Array>                                                                  \
+        inline void Name(                                                                       \
+            tape_inner<Array>& z                                                                \
+            , const tape_inner<Array>& x                                                        \
+            , const tape_inner<Array>& y)                                                       \
+        {                                                                                       \
+            assert(&z != &x && &z != &y);                                                       \
+            if (x.is_scalar() && y.is_scalar())                                                 \
+            {                                                                                   \
+                z.mode_ = tape_inner<Array>::ScalarMode;                                        \
+                z.scalar_value_ = x.scalar_value_ Op y.scalar_value_;                           \
+            }                                                                                   \
+            else if (x.is_array())                                                              \
+            {                                                                                   \
+                z.reserve_lanes(x.size());                                                      \
+                z.array_value_ = x.array_value_;                                                \
+                if (y.is_array())                                                               \
+                {                                                                               \
+                    z.array_value_ Op##= y.array_value_;                                        \
+                }                                                                               \
+                else                                                                            \
+                {                                                                               \
+                    z.array_value_ Op##= y.scalar_value_;                                       \
+                }                                                                               \
+            }                                                                                   \
+            else                                                                                \
+            {                                                                                   \
+                z.reserve_lanes(y.size());                                                      \
+                z.array_value_ = x.scalar_value_;                                               \
+                z.array_value_ Op##= y.array_value_;                                            \
+            }                                                                                   \
+        }
+        CL_INNER_ARRAY_ASSIGN_FUNCTION(assign_sum, +)
+        CL_INNER_ARRAY_ASSIGN_FUNCTION(assign_difference, -)
+        CL_INNER_ARRAY_ASSIGN_FUNCTION(assign_product, *)
+        CL_INNER_ARRAY_ASSIGN_FUNCTION(assign_quotient, /)
+#undef CL_INNER_ARRAY_ASSIGN_FUNCTION
+
+        /// <summary>Calls apply(i, f(x_i, y_i)) for the n lanes, a scalar argument
+        /// is the same in every lane.</summary>
+        template <class Scalar, class Func, class Apply>
+        inline void for_lanes(size_t n, const Scalar* x, bool x_array, const Scalar* y, bool y_array
+            , Func f, Apply apply)
+        {
+            if (x_array && y_array)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    apply(i, f(x[i], y[i]));
+                }
+            }
+            else if (x_array)
+            {
+                Scalar y0 = *y;
+                for (size_t i = 0; i < n; i++)
+                {
+                    apply(i, f(x[i], y0));
+                }
+            }
+            else
+            {
+                Scalar x0 = *x;
+                for (size_t i = 0; i < n; i++)
+                {
+                    apply(i, f(x0, y[i]));
+                }
+            }
+        }
+
+        /// <summary>Adds f(x, y) to z lane by lane without temporaries, a scalar
+        /// argument is the same in every lane. An intrusive scalar z is
+        /// increased by the sum of the lanes, as by operator+=.</summary>
+        template <class Array, class Func>
+        inline void update_lanes(
+            tape_inner<Array>& z
+            , const tape_inner<Array>& x
+            , const tape_inner<Array>& y
+            , Func f)
+        {
+            typedef typename tape_inner<Array>::scalar_type scalar_type;
+
+            bool x_array = x.is_array();
+            bool y_array = y.is_array();
+            scalar_type xs = x.scalar_value_;
+            scalar_type ys = y.scalar_value_;
+            if (!x_array && !y_array)
+            {
+                scalar_type value = f(xs, ys);
+                if (z.is_scalar())
+                {
+                    z.scalar_value_ += value;
+                }
+                else
+                {
+                    z.array_value_ += value;
+                }
+                return;
+            }
+
+            size_t n = x_array ? x.size() : y.size();
+            const scalar_type* px = x_array ? x.begin() : &xs;
+            const scalar_type* py = y_array ? y.begin() : &ys;
+            if (z.is_intrusive())
+            {
+                scalar_type sum = scalar_type(0);
+                for_lanes(n, px, x_array, py, y_array, f
+                    , [&sum](size_t, scalar_type v) { sum += v; });
+                z.scalar_value_ += sum;
+            }
+            else if (z.is_scalar())
+            {
+                scalar_type zs = z.scalar_value_;
+                z.reserve_lanes(n);
+                scalar_type* pz = z.begin();
+                for_lanes(n, px, x_array, py, y_array, f
+                    , [pz, zs](size_t i, scalar_type v) { pz[i] = zs + v; });
+            }
+            else
+            {
+                scalar_type* pz = z.begin();
+                for_lanes(n, px, x_array, py, y_array, f
+                    , [pz](size_t i, scalar_type v) { pz[i] += v; });
+            }
+        }
+
+        // z += x * y
+        template <class Array>
+        inline void add_product(tape_inner<Array>& z, const tape_inner<Array>& x, const tape_inner<Array>& y)
+        {
+            typedef typename tape_inner<Array>::scalar_type scalar_type;
+            update_lanes(z, x, y, [](scalar_type a, scalar_type b) { return a * b; });
+        }
+
+        // z -= x * y
+        template <class Array>
+        inline void subtract_product(tape_inner<Array>& z, const tape_inner<Array>& x, const tape_inner<Array>& y)
+        {
+            typedef typename tape_inner<Array>::scalar_type scalar_type;
+            update_lanes(z, x, y, [](scalar_type a, scalar_type b) { return -(a * b); });
+        }
+
+        // z += x / y
+        template <class Array>
+        inline void add_quotient(tape_inner<Array>& z, const tape_inner<Array>& x, const tape_inner<Array>& y)
+        {
+            typedef typename tape_inner<Array>::scalar_type scalar_type;
+            update_lanes(z, x, y, [](scalar_type a, scalar_type b) { return a / b; });
+        }
+    }
+
+
+    // Arithmetic binary operations, array results are computed in place
+    // in storage from the lane buffer pool.
+#define CL_BIN_INNER_ARRAY_OPERATOR(Op, Name)                                                   \
     template <class Array>                                                                      \
-    inline tape_inner<Array> operator Op(                                                      \
-        const tape_inner<Array>& x                                                             \
-        , const tape_inner<Array>& y)                                                          \
+    inline tape_inner<Array> operator Op(                                                       \
+        const tape_inner<Array>& x                                                              \
+        , const tape_inner<Array>& y)                                                           \
     {                                                                                           \
         if (x.is_scalar() && y.is_scalar())                                                     \
         {                                                                                       \
             return x.scalar_value_ Op y.scalar_value_;                                          \
         }                                                                                       \
-        else if (x.is_array() && y.is_scalar())                                                 \
-        {                                                                                       \
-            return tape_inner<Array>(x.array_value_ Op y.scalar_value_);                        \
-        }                                                                                       \
-        else if (x.is_scalar() && y.is_array())                                                 \
-        {                                                                                       \
-            return tape_inner<Array>(x.scalar_value_ Op y.array_value_);                        \
-        }                                                                                       \
-        else /* (x.is_array() && y.is_array()) */                                               \
-        {                                                                                       \
-            return tape_inner<Array>(x.array_value_ Op y.array_value_);                         \
-        }                                                                                       \
+        tape_inner<Array> result;                                                               \
+        tapescript::Name(result, x, y);                                                         \
+        return result;                                                                          \
     }                                                                                           \
                                                                                                 \
     template <class Array>                                                                      \
-    inline tape_inner<Array> operator Op(                                                      \
-        const tape_inner<Array>& x                                                             \
-        , const typename tape_inner<Array>::scalar_type& y)                                    \
+    inline tape_inner<Array> operator Op(                                                       \
+        const tape_inner<Array>& x                                                              \
+        , const typename tape_inner<Array>::scalar_type& y)                                     \
     {                                                                                           \
         if (x.is_scalar())                                                                      \
         {                                                                                       \
             return x.scalar_value_ Op y;                                                        \
         }                                                                                       \
-        return tape_inner<Array>(x.array_value_ Op y);                                          \
+        tape_inner<Array> result;                                                               \
+        tapescript::Name(result, x, tape_inner<Array>(y));                                      \
+        return result;                                                                          \
     }                                                                                           \
                                                                                                 \
     template <class Array>                                                                      \
-    inline tape_inner<Array> operator Op(                                                      \
-        const typename tape_inner<Array>::scalar_type& x                                       \
-        , const tape_inner<Array>& y)                                                          \
+    inline tape_inner<Array> operator Op(                                                       \
+        const typename tape_inner<Array>::scalar_type& x                                        \
+        , const tape_inner<Array>& y)                                                           \
     {                                                                                           \
         if (y.is_scalar())                                                                      \
         {                                                                                       \
             return x Op y.scalar_value_;                                                        \
         }                                                                                       \
-        return tape_inner<Array>(x Op y.array_value_);                                          \
+        tape_inner<Array> result;                                                               \
+        tapescript::Name(result, tape_inner<Array>(x), y);                                      \
+        return result;                                                                          \
     }
 
-    CL_BIN_INNER_ARRAY_OPERATOR(-)
-    CL_BIN_INNER_ARRAY_OPERATOR(*)
-    CL_BIN_INNER_ARRAY_OPERATOR(/)
-    CL_BIN_INNER_ARRAY_OPERATOR(+)
+    CL_BIN_INNER_ARRAY_OPERATOR(-, assign_difference)
+    CL_BIN_INNER_ARRAY_OPERATOR(*, assign_product)
+    CL_BIN_INNER_ARRAY_OPERATOR(/, assign_quotient)
+    CL_BIN_INNER_ARRAY_OPERATOR(+, assign_sum)
 #undef CL_BIN_INNER_ARRAY_OPERATOR
 
 
@@ -444,13 +678,16 @@ namespace cl
         // Standart math functions.
 #define CL_INNER_ARRAY_FUNCTION(Name)                                                           \
         template <class Array>                                                                  \
-        inline cl::tape_inner<Array> Name(const cl::tape_inner<Array>& x)                     \
+        inline cl::tape_inner<Array> Name(const cl::tape_inner<Array>& x)                       \
         {                                                                                       \
             if (x.is_scalar())                                                                  \
             {                                                                                   \
                 return std::Name(x.scalar_value_);                                              \
             }                                                                                   \
-            return cl::tape_inner<Array>::traits::Name(x.array_value_);                        \
+            cl::tape_inner<Array> result;                                                       \
+            result.reserve_lanes(x.size());                                                     \
+            cl::tape_inner<Array>::traits::Name(x.array_value_, result.array_value_);           \
+            return result;                                                                      \
         }
         CL_INNER_ARRAY_FUNCTION(abs)
         CL_INNER_ARRAY_FUNCTION(acos)
@@ -478,18 +715,22 @@ namespace cl
             {
                 return std::pow(left.scalar_value_, right.scalar_value_);
             }
-            else if (left.is_array() && right.is_scalar())
+
+            cl::tape_inner<Array> result;
+            result.reserve_lanes(left.is_array() ? left.size() : right.size());
+            if (left.is_array() && right.is_scalar())
             {
-                return traits::pow(left.array_value_, right.scalar_value_);
+                traits::pow(left.array_value_, right.scalar_value_, result.array_value_);
             }
             else if (left.is_scalar() && right.is_array())
             {
-                return traits::pow(left.scalar_value_, right.array_value_);
+                traits::pow(left.scalar_value_, right.array_value_, result.array_value_);
             }
             else // (left.is_array() && right.is_array())
             {
-                return traits::pow(left.array_value_, right.array_value_);
+                traits::pow(left.array_value_, right.array_value_, result.array_value_);
             }
+            return result;
         }
 
         // Math power functioon.
@@ -503,7 +744,10 @@ namespace cl
             {
                 return std::pow(left.scalar_value_, right);
             }
-            return traits::pow(left.array_value_, right);
+            cl::tape_inner<Array> result;
+            result.reserve_lanes(left.size());
+            traits::pow(left.array_value_, right, result.array_value_);
+            return result;
         }
 
         // Math power functioon.
@@ -517,7 +761,10 @@ namespace cl
             {
                 return std::pow(left, right.scalar_value_);
             }
-            return traits::pow(left, right.array_value_);
+            cl::tape_inner<Array> result;
+            result.reserve_lanes(right.size());
+            traits::pow(left, right.array_value_, result.array_value_);
+            return result;
         }
 
         template <class T>
@@ -532,6 +779,22 @@ namespace cl
             }
         }
 
+        /// <summary>Sets partial value to zero in the mode set_intrusive gives it for the model.
+        /// Array storage of the value is kept to be reused by the next accumulation.</summary>
+        template <class T>
+        void reset_partial(T& val, const T& = T())
+        {
+            val = T(0);
+        }
+
+        template <class Array>
+        void reset_partial(tape_inner<Array>& val, const tape_inner<Array>& model = tape_inner<Array>())
+        {
+            typedef tape_inner<Array> inner_type;
+            val.mode_ = model.is_scalar() ? inner_type::IntrusiveScalar : inner_type::ScalarMode;
+            val.scalar_value_ = typename inner_type::scalar_type(0);
+        }
+
         template <class T>
         void set_not_intrusive(T& val){}
 
@@ -70,12 +70,13 @@ namespace QuantLib {
     template <class T>
     T PlainVanillaPayoff_T<T>::operator()(const T& price) const
     {
+        // cl::select_* keeps the choice lane-wise for vector AAD.
         switch (type_)
         {
         case Option::Call:
-            return std::max(price - strike_, 0.0);
+            return cl::select_gt(price, strike_, price - strike_, T(0.0));
         case Option::Put:
-            return std::max(strike_ - price, 0.0);
+            return cl::select_lt(price, strike_, strike_ - price, T(0.0));
         default:
             QL_FAIL("unknown/illegal option type");
         }
@@ -91,6 +92,84 @@ namespace QuantLib {
         else
             Payoff_T::accept(v);
     }
+
+    //! Binary cash-or-nothing payoff
+    template <class T>
+    class CashOrNothingPayoff_T : public StrikedTypePayoff_T<T> {
+    public:
+        CashOrNothingPayoff_T(Option::Type type, T strike, T cashPayoff)
+            : StrikedTypePayoff_T<T>(type, strike), cashPayoff_(cashPayoff) {}
+
+        std::string name() const { return "CashOrNothing"; }
+        T operator()(const T& price) const;
+        virtual void accept(AcyclicVisitor&);
+        T cashPayoff() const { return cashPayoff_; }
+
+    protected:
+        T cashPayoff_;
+    };
+
+    template <class T>
+    T CashOrNothingPayoff_T<T>::operator()(const T& price) const
+    {
+        switch (type_)
+        {
+        case Option::Call:
+            return cl::select_gt(price, strike_, cashPayoff_, T(0.0));
+        case Option::Put:
+            return cl::select_lt(price, strike_, cashPayoff_, T(0.0));
+        default:
+            QL_FAIL("unknown/illegal option type");
+        }
+    }
+
+    template <class T>
+    void CashOrNothingPayoff_T<T>::accept(AcyclicVisitor& v)
+    {
+        Visitor<CashOrNothingPayoff_T>* v1 =
+            dynamic_cast<Visitor<CashOrNothingPayoff_T>*>(&v);
+        if (v1 != 0)
+            v1->visit(*this);
+        else
+            Payoff_T::accept(v);
+    }
+
+    //! Binary asset-or-nothing payoff
+    template <class T>
+    class AssetOrNothingPayoff_T : public StrikedTypePayoff_T<T> {
+    public:
+        AssetOrNothingPayoff_T(Option::Type type, T strike)
+            : StrikedTypePayoff_T<T>(type, strike) {}
+
+        std::string name() const { return "AssetOrNothing"; }
+        T operator()(const T& price) const;
+        virtual void accept(AcyclicVisitor&);
+    };
+
+    template <class T>
+    T AssetOrNothingPayoff_T<T>::operator()(const T& price) const
+    {
+        switch (type_)
+        {
+        case Option::Call:
+            return cl::select_gt(price, strike_, price, T(0.0));
+        case Option::Put:
+            return cl::select_lt(price, strike_, price, T(0.0));
+        default:
+            QL_FAIL("unknown/illegal option type");
+        }
+    }
+
+    template <class T>
+    void AssetOrNothingPayoff_T<T>::accept(AcyclicVisitor& v)
+    {
+        Visitor<AssetOrNothingPayoff_T>* v1 =
+            dynamic_cast<Visitor<AssetOrNothingPayoff_T>*>(&v);
+        if (v1 != 0)
+            v1->visit(*this);
+        else
+            Payoff_T::accept(v);
+    }
 }
 
 #endif
@@ -0,0 +1,718 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+# if !defined cl_tape_impl_tape_archive_tape_codegen_hpp
+# define cl_tape_impl_tape_archive_tape_codegen_hpp
+
+# include <algorithm>
+# include <cmath>
+# include <cstdint>
+# include <cstdlib>
+# include <fstream>
+# include <limits>
+# include <memory>
+# include <sstream>
+# include <stdexcept>
+# include <string>
+# include <type_traits>
+# include <vector>
+
+# if defined _WIN32
+#   if !defined NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+# else
+#   include <dlfcn.h>
+# endif
+
+namespace cl
+{
+    /// <summary>Version of the interface of compiled tapes, libraries
+    /// of another version are rejected.</summary>
+    const std::uint32_t tape_codegen_abi_version = 1;
+
+    struct tape_codegen_options
+    {
+        tape_codegen_options(std::string const& command = default_command()
+            , size_t chunk = 4096)
+            : command_(command)
+            , chunk_(chunk)
+        {}
+
+        // Command which compiles {source} to the shared library {library}, the
+        // placeholders are replaced by the paths as they are, so they are quoted
+        // in the command. The generated code is straight-line, -O1 runs as fast
+        // as -O2 with it and compiles in about half the time.
+        std::string command_;
+
+        // Number of operations per generated C function, very long
+        // functions take the compilers disproportionately long.
+        size_t chunk_;
+
+        // The command in the environment variable CL_TAPE_CODEGEN_COMMAND if it
+        // is set, otherwise the C compiler of the platform, which must be on PATH.
+        static std::string default_command()
+        {
+            char const* command = std::getenv("CL_TAPE_CODEGEN_COMMAND");
+            if (command != nullptr && *command != 0)
+            {
+                return command;
+            }
+#   if defined _WIN32
+            return "cl /nologo /O2 /LD \"{source}\" /Fo\"{library}.obj\" /Fe\"{library}\" > NUL";
+#   else
+            return "cc -O1 -shared -fPIC -o \"{library}\" \"{source}\" -lm";
+#   endif
+        }
+
+        // True if the program which the command runs, its first word, exists:
+        // a path is checked as a file, a name is looked up on PATH by the shell.
+        // compile_tape fails if it is not available.
+        bool available() const
+        {
+            size_t begin = command_.find_first_not_of(" \t");
+            if (begin == std::string::npos || std::system(nullptr) == 0)
+            {
+                return false;
+            }
+
+            std::string program;
+            if (command_[begin] == '"')
+            {
+                size_t end = command_.find('"', begin + 1);
+                program = command_.substr(begin + 1, end == std::string::npos ? end : end - begin - 1);
+            }
+            else
+            {
+                size_t end = command_.find_first_of(" \t", begin);
+                program = command_.substr(begin, end == std::string::npos ? end : end - begin);
+            }
+
+            if (program.find_first_of("/\\") != std::string::npos)
+            {
+                return std::ifstream(program.c_str()).good();
+            }
+#   if defined _WIN32
+            return std::system(("where " + program + " > NUL 2>&1").c_str()) == 0;
+#   else
+            return std::system(("command -v " + program + " > /dev/null 2>&1").c_str()) == 0;
+#   endif
+        }
+
+        static std::string library_suffix()
+        {
+#   if defined _WIN32
+            return ".dll";
+#   else
+            return ".so";
+#   endif
+        }
+
+        // Command with the placeholders replaced by the paths.
+        std::string command(std::string const& source, std::string const& library) const
+        {
+            std::string result = command_;
+            replace(result, "{source}", source);
+            replace(result, "{library}", library);
+            return result;
+        }
+
+    private:
+        static void replace(std::string& s, std::string const& what, std::string const& with)
+        {
+            for (size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + with.size()))
+            {
+                s.replace(pos, what.size(), with);
+            }
+        }
+    };
+
+    namespace tapescript
+    {
+        /// <summary>Value as a C literal.</summary>
+        inline std::string c_literal(double value)
+        {
+            if (std::isnan(value))
+            {
+                return "NAN";
+            }
+            if (std::isinf(value))
+            {
+                return value > 0 ? "INFINITY" : "(-INFINITY)";
+            }
+
+            std::ostringstream literal;
+            literal.precision(std::numeric_limits<double>::max_digits10);
+            literal << value;
+            std::string result = literal.str();
+            if (result.find_first_of(".e") == std::string::npos)
+            {
+                result += ".0";
+            }
+            return value < 0 ? "(" + result + ")" : result;
+        }
+
+        /// <summary>C expression in double with the arithmetic and math functions
+        /// of the unary operation table (unary_op_value, unary_op_derivative), which
+        /// gives the generated code the same formulas as the sweeps of the tapes.</summary>
+        struct c_expression
+        {
+            explicit c_expression(double value)
+                : text_(c_literal(value))
+            {}
+
+            explicit c_expression(std::string const& text)
+                : text_(text)
+            {}
+
+            std::string text_;
+
+            friend c_expression operator+(c_expression const& l, c_expression const& r) { return binary(l, " + ", r); }
+            friend c_expression operator-(c_expression const& l, c_expression const& r) { return binary(l, " - ", r); }
+            friend c_expression operator*(c_expression const& l, c_expression const& r) { return binary(l, " * ", r); }
+            friend c_expression operator/(c_expression const& l, c_expression const& r) { return binary(l, " / ", r); }
+            friend c_expression operator-(c_expression const& x) { return c_expression("(-" + x.text_ + ")"); }
+
+            friend c_expression unary_sign(c_expression const& x)
+            {
+                return c_expression("(double)((" + x.text_ + " > 0.0) - (" + x.text_ + " < 0.0))");
+            }
+
+            friend c_expression fabs(c_expression const& x) { return call("fabs", x); }
+            friend c_expression exp(c_expression const& x) { return call("exp", x); }
+            friend c_expression log(c_expression const& x) { return call("log", x); }
+            friend c_expression sqrt(c_expression const& x) { return call("sqrt", x); }
+            friend c_expression sin(c_expression const& x) { return call("sin", x); }
+            friend c_expression cos(c_expression const& x) { return call("cos", x); }
+            friend c_expression tan(c_expression const& x) { return call("tan", x); }
+            friend c_expression asin(c_expression const& x) { return call("asin", x); }
+            friend c_expression acos(c_expression const& x) { return call("acos", x); }
+            friend c_expression atan(c_expression const& x) { return call("atan", x); }
+            friend c_expression sinh(c_expression const& x) { return call("sinh", x); }
+            friend c_expression cosh(c_expression const& x) { return call("cosh", x); }
+            friend c_expression tanh(c_expression const& x) { return call("tanh", x); }
+            friend c_expression erf(c_expression const& x) { return call("erf", x); }
+
+        private:
+            static c_expression binary(c_expression const& l, char const* op, c_expression const& r)
+            {
+                return c_expression("(" + l.text_ + op + r.text_ + ")");
+            }
+
+            static c_expression call(char const* function, c_expression const& x)
+            {
+                return c_expression(std::string(function) + "(" + x.text_ + ")");
+            }
+        };
+
+        /// <summary>Translates the operation sequence of a scalar tape to C.
+        /// Every variable of the tape is an element of the work array v, the
+        /// zero order sweep assigns each one once, in the order of the tape.
+        /// The first order reverse sweep visits the operations backwards and
+        /// accumulates the adjoints in a, the second half of the work array,
+        /// from the values left in v.</summary>
+        template <class Base>
+        class tape_codegen_writer
+        {
+        public:
+            explicit tape_codegen_writer(tape_function_base<Base> const& f)
+                : f_(f)
+                , forward_()
+                , reverse_()
+            {
+                translate();
+            }
+
+            void write(std::ostream& out, size_t chunk) const
+            {
+                size_t num_var = f_.num_var_tape_;
+                size_t chunks = (forward_.size() + chunk - 1) / chunk;
+
+                out << "/* Generated from a recorded tape, do not edit. */\n"
+                    << "#include <math.h>\n"
+                    << "#include <stddef.h>\n"
+                    << "#include <string.h>\n"
+                    << "\n"
+                    << "#if defined _WIN32\n"
+                    << "#   define CL_TAPE_EXPORT __declspec(dllexport)\n"
+                    << "#else\n"
+                    << "#   define CL_TAPE_EXPORT\n"
+                    << "#endif\n"
+                    << "\n";
+
+                for (size_t k = 0; k < chunks; k++)
+                {
+                    out << "static void forward_" << k << "(const double* x, double* v)\n{\n";
+                    for (size_t i = k * chunk; i < std::min(forward_.size(), (k + 1) * chunk); i++)
+                    {
+                        out << forward_[i];
+                    }
+                    out << "}\n\n";
+
+                    out << "static void reverse_" << k << "(const double* v, double* a)\n{\n";
+                    for (size_t i = std::min(reverse_.size(), (k + 1) * chunk); i-- > k * chunk;)
+                    {
+                        out << reverse_[i];
+                    }
+                    out << "}\n\n";
+                }
+
+                out << "CL_TAPE_EXPORT unsigned cl_tape_abi_version(void) { return " << tape_codegen_abi_version << "u; }\n"
+                    << "CL_TAPE_EXPORT size_t cl_tape_domain(void) { return " << f_.ind_taddr_.size() << "; }\n"
+                    << "CL_TAPE_EXPORT size_t cl_tape_range(void) { return " << f_.dep_taddr_.size() << "; }\n"
+                    << "CL_TAPE_EXPORT size_t cl_tape_work_size(void) { return " << 2 * num_var << "; }\n"
+                    << "\n";
+
+                out << "CL_TAPE_EXPORT void cl_tape_forward(const double* x, double* y, double* work)\n{\n"
+                    << "    double* v = work;\n";
+                for (size_t k = 0; k < chunks; k++)
+                {
+                    out << "    forward_" << k << "(x, v);\n";
+                }
+                for (size_t i = 0; i < f_.dep_taddr_.size(); i++)
+                {
+                    out << "    y[" << i << "] = v[" << f_.dep_taddr_[i] << "];\n";
+                }
+                out << "}\n\n";
+
+                out << "CL_TAPE_EXPORT void cl_tape_reverse(const double* x, const double* w, double* y, double* dw, double* work)\n{\n"
+                    << "    double* a = work + " << num_var << ";\n"
+                    << "    cl_tape_forward(x, y, work);\n"
+                    << "    memset(a, 0, " << num_var << " * sizeof(double));\n";
+                // Two dependent variables can point to the same location.
+                for (size_t i = 0; i < f_.dep_taddr_.size(); i++)
+                {
+                    out << "    a[" << f_.dep_taddr_[i] << "] += w[" << i << "];\n";
+                }
+                for (size_t k = chunks; k-- > 0;)
+                {
+                    out << "    reverse_" << k << "(work, a);\n";
+                }
+                for (size_t j = 0; j < f_.ind_taddr_.size(); j++)
+                {
+                    out << "    dw[" << j << "] = a[" << f_.ind_taddr_[j] << "];\n";
+                }
+                out << "}\n";
+            }
+
+        private:
+            std::string v(size_t i) const
+            {
+                return "v[" + std::to_string(i) + "]";
+            }
+
+            std::string a(size_t i) const
+            {
+                return "a[" + std::to_string(i) + "]";
+            }
+
+            // Parameter as a C literal.
+            std::string p(size_t i) const
+            {
+                return c_literal(static_cast<double>(f_.play_.par_rec_[i]));
+            }
+
+            // Argument j of an operation which is a variable if the flag is set.
+            std::string operand(CppAD::addr_t const* arg, size_t j, bool variable) const
+            {
+                return variable ? v(arg[j]) : p(arg[j]);
+            }
+
+            void add(std::string const& forward, std::string const& reverse)
+            {
+                forward_.push_back(forward);
+                reverse_.push_back(reverse);
+            }
+
+            // z = f(x) with the value and derivative of the unary operation table.
+            void unary(CppAD::OpCode op, size_t z, CppAD::addr_t const* arg)
+            {
+                c_expression x(v(arg[0]));
+                std::string forward = "    " + v(z) + " = " + unary_op_value(op, x).text_ + ";\n";
+                if (op == CppAD::SignOp)
+                {
+                    // The derivative is zero.
+                    add(forward, "");
+                    return;
+                }
+
+                // arg[2] of ErfOp is the parameter 2 / sqrt(pi).
+                c_expression c(op == CppAD::ErfOp ? p(arg[2]) : std::string("0.0"));
+                add(forward, "    " + a(arg[0]) + " += " + a(z) + " * "
+                    + unary_op_derivative(op, x, c_expression(v(z)), c).text_ + ";\n");
+            }
+
+            void translate()
+            {
+                using namespace CppAD;
+
+                size_t i_ind = 0;
+                for_each_op(f_.play_, [&](OpCode op, addr_t const* arg, size_t z)
+                {
+                    switch (op)
+                    {
+                    case BeginOp:
+                    case EndOp:
+                    case PriOp:
+                    case CSkipOp:
+                    case EqpvOp: case EqvvOp:
+                    case LepvOp: case LevpOp: case LevvOp:
+                    case LtpvOp: case LtvpOp: case LtvvOp:
+                    case NepvOp: case NevvOp:
+                        // All operations are evaluated, comparisons only count changes.
+                        break;
+
+                    case InvOp:
+                        add("    " + v(z) + " = x[" + std::to_string(i_ind++) + "];\n", "");
+                        break;
+
+                    case ParOp:
+                        add("    " + v(z) + " = " + p(arg[0]) + ";\n", "");
+                        break;
+
+                    case AddvvOp:
+                        add("    " + v(z) + " = " + v(arg[0]) + " + " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + ";\n"
+                            + "    " + a(arg[1]) + " += " + a(z) + ";\n");
+                        break;
+
+                    case AddpvOp:
+                        add("    " + v(z) + " = " + p(arg[0]) + " + " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[1]) + " += " + a(z) + ";\n");
+                        break;
+
+                    case SubvvOp:
+                        add("    " + v(z) + " = " + v(arg[0]) + " - " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + ";\n"
+                            + "    " + a(arg[1]) + " -= " + a(z) + ";\n");
+                        break;
+
+                    case SubpvOp:
+                        add("    " + v(z) + " = " + p(arg[0]) + " - " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[1]) + " -= " + a(z) + ";\n");
+                        break;
+
+                    case SubvpOp:
+                        add("    " + v(z) + " = " + v(arg[0]) + " - " + p(arg[1]) + ";\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + ";\n");
+                        break;
+
+                    case MulvvOp:
+                        add("    " + v(z) + " = " + v(arg[0]) + " * " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + " * " + v(arg[1]) + ";\n"
+                            + "    " + a(arg[1]) + " += " + a(z) + " * " + v(arg[0]) + ";\n");
+                        break;
+
+                    case MulpvOp:
+                        add("    " + v(z) + " = " + p(arg[0]) + " * " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[1]) + " += " + a(z) + " * " + p(arg[0]) + ";\n");
+                        break;
+
+                    case DivvvOp:
+                        add("    " + v(z) + " = " + v(arg[0]) + " / " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + " / " + v(arg[1]) + ";\n"
+                            + "    " + a(arg[1]) + " -= " + a(z) + " * " + v(z) + " / " + v(arg[1]) + ";\n");
+                        break;
+
+                    case DivpvOp:
+                        add("    " + v(z) + " = " + p(arg[0]) + " / " + v(arg[1]) + ";\n"
+                            , "    " + a(arg[1]) + " -= " + a(z) + " * " + v(z) + " / " + v(arg[1]) + ";\n");
+                        break;
+
+                    case DivvpOp:
+                        add("    " + v(z) + " = " + v(arg[0]) + " / " + p(arg[1]) + ";\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + " / " + p(arg[1]) + ";\n");
+                        break;
+
+                    case AbsOp: case SignOp: case ExpOp: case LogOp: case SqrtOp:
+                    case SinOp: case CosOp: case TanOp: case AsinOp: case AcosOp: case AtanOp:
+                    case SinhOp: case CoshOp: case TanhOp: case ErfOp:
+                        unary(op, z, arg);
+                        break;
+
+                    case PowvvOp:
+                        add("    " + v(z) + " = pow(" + v(arg[0]) + ", " + v(arg[1]) + ");\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + " * " + v(arg[1]) + " * pow(" + v(arg[0]) + ", " + v(arg[1]) + " - 1.0);\n"
+                            + "    " + a(arg[1]) + " += " + a(z) + " * " + v(z) + " * log(" + v(arg[0]) + ");\n");
+                        break;
+
+                    case PowpvOp:
+                        add("    " + v(z) + " = pow(" + p(arg[0]) + ", " + v(arg[1]) + ");\n"
+                            , "    " + a(arg[1]) + " += " + a(z) + " * " + v(z) + " * log(" + p(arg[0]) + ");\n");
+                        break;
+
+                    case PowvpOp:
+                        add("    " + v(z) + " = pow(" + v(arg[0]) + ", " + p(arg[1]) + ");\n"
+                            , "    " + a(arg[0]) + " += " + a(z) + " * " + p(arg[1]) + " * pow(" + v(arg[0]) + ", " + p(arg[1]) + " - 1.0);\n");
+                        break;
+
+                    case CSumOp:
+                    {
+                        // arg[0] added and arg[1] subtracted variables follow the parameter arg[2].
+                        std::string forward = "    " + v(z) + " = " + p(arg[2]);
+                        std::string reverse;
+                        for (addr_t j = 0; j < arg[0] + arg[1]; j++)
+                        {
+                            char const* sign = j < arg[0] ? "+" : "-";
+                            forward += std::string(" ") + sign + " " + v(arg[3 + j]);
+                            reverse += "    " + a(arg[3 + j]) + " " + sign + "= " + a(z) + ";\n";
+                        }
+                        add(forward + ";\n", reverse);
+                        break;
+                    }
+
+                    case CExpOp:
+                    {
+                        static char const* const compare[] = { "<", "<=", "==", ">=", ">", "!=" };
+                        std::string condition = "(" + operand(arg, 2, (arg[1] & 1) != 0)
+                            + " " + compare[arg[0]] + " " + operand(arg, 3, (arg[1] & 2) != 0) + ")";
+                        std::string reverse;
+                        if (arg[1] & 4)
+                        {
+                            reverse += "    if " + condition + " " + a(arg[4]) + " += " + a(z) + ";\n";
+                        }
+                        if (arg[1] & 8)
+                        {
+                            reverse += "    if (!" + condition + ") " + a(arg[5]) + " += " + a(z) + ";\n";
+                        }
+                        add("    " + v(z) + " = " + condition + " ? " + operand(arg, 4, (arg[1] & 4) != 0)
+                            + " : " + operand(arg, 5, (arg[1] & 8) != 0) + ";\n", reverse);
+                        break;
+                    }
+
+                    default:
+                        // Discrete functions, VecAD and atomic operations.
+                        throw std::runtime_error(std::string("Code generation does not support the tape operation ")
+                            + OpName(op) + ".");
+                    }
+                });
+            }
+
+            tape_function_base<Base> const& f_;
+            // C statements of the zero order sweep, one per operation.
+            std::vector<std::string> forward_;
+            // C statements of the reverse sweep, in the order of the operations.
+            std::vector<std::string> reverse_;
+        };
+    }
+
+    /// <summary>Writes the C source of the zero order forward sweep and the first
+    /// order reverse sweep of the function recorded in f. The source defines
+    /// the functions of the interface loaded by compiled_tape_function.</summary>
+    template <class Base>
+    inline void write_tape_source(tape_function_base<Base> const& f, std::ostream& out, size_t chunk = 4096)
+    {
+        static_assert(std::is_arithmetic<Base>::value
+            , "Code generation is limited to tapes with a native Base.");
+
+        tapescript::tape_codegen_writer<Base>(f).write(out, chunk == 0 ? 1 : chunk);
+    }
+
+    /// <summary>Tape compiled to native code and loaded from a shared library.
+    /// The library exports, with C linkage:
+    ///     unsigned cl_tape_abi_version(void);
+    ///     size_t cl_tape_domain(void);
+    ///     size_t cl_tape_range(void);
+    ///     size_t cl_tape_work_size(void);
+    ///     void cl_tape_forward(const double* x, double* y, double* work);
+    ///     void cl_tape_reverse(const double* x, const double* w, double* y, double* dw, double* work);
+    /// Each object owns its work array, so one object must not be called from
+    /// several threads at once; load one per thread instead.</summary>
+    class compiled_tape_function
+    {
+    public:
+        explicit compiled_tape_function(std::string const& path)
+            : path_(path)
+            , library_(nullptr)
+            , domain_(0)
+            , range_(0)
+            , forward_(nullptr)
+            , reverse_(nullptr)
+            , work_()
+        {
+#   if defined _WIN32
+            library_ = LoadLibraryA(path.c_str());
+#   else
+            // Without a slash dlopen searches the library path instead.
+            std::string local = path.find('/') == std::string::npos ? "./" + path : path;
+            library_ = ::dlopen(local.c_str(), RTLD_NOW | RTLD_LOCAL);
+#   endif
+            if (library_ == nullptr)
+            {
+                throw std::runtime_error("Cannot load compiled tape " + path + ".");
+            }
+
+            typedef unsigned(*version_function)();
+            typedef size_t(*size_function)();
+            version_function version = reinterpret_cast<version_function>(symbol("cl_tape_abi_version"));
+            if (version() != tape_codegen_abi_version)
+            {
+                close();
+                throw std::runtime_error("Compiled tape " + path + " has an incompatible interface version.");
+            }
+
+            domain_ = reinterpret_cast<size_function>(symbol("cl_tape_domain"))();
+            range_ = reinterpret_cast<size_function>(symbol("cl_tape_range"))();
+            work_.resize(reinterpret_cast<size_function>(symbol("cl_tape_work_size"))());
+            forward_ = reinterpret_cast<forward_function>(symbol("cl_tape_forward"));
+            reverse_ = reinterpret_cast<reverse_function>(symbol("cl_tape_reverse"));
+        }
+
+        ~compiled_tape_function()
+        {
+            close();
+        }
+
+        /// <summary>Number of independent variables.</summary>
+        size_t domain() const
+        {
+            return domain_;
+        }
+
+        /// <summary>Number of dependent variables.</summary>
+        size_t range() const
+        {
+            return range_;
+        }
+
+        /// <summary>Path of the shared library.</summary>
+        std::string const& path() const
+        {
+            return path_;
+        }
+
+        /// <summary>Values y of the function at x.</summary>
+        void forward(double const* x, double* y)
+        {
+            forward_(x, y, work_.data());
+        }
+
+        /// <summary>Values y of the function and derivatives dw of w^T y at x.</summary>
+        void reverse(double const* x, double const* w, double* y, double* dw)
+        {
+            reverse_(x, w, y, dw, work_.data());
+        }
+
+        /// <summary>Values of the function at x.</summary>
+        std::vector<double> forward(std::vector<double> const& x)
+        {
+            check(x.size(), domain_, "Arguments do not match the domain size.");
+            std::vector<double> y(range_);
+            forward(x.data(), y.data());
+            return y;
+        }
+
+        /// <summary>Derivatives of w^T y with respect to x at x.</summary>
+        std::vector<double> reverse(std::vector<double> const& x, std::vector<double> const& w)
+        {
+            check(x.size(), domain_, "Arguments do not match the domain size.");
+            check(w.size(), range_, "Weights do not match the range size.");
+            std::vector<double> y(range_);
+            std::vector<double> dw(domain_);
+            reverse(x.data(), w.data(), y.data(), dw.data());
+            return dw;
+        }
+
+    private:
+        compiled_tape_function(compiled_tape_function const&);
+        compiled_tape_function& operator=(compiled_tape_function const&);
+
+        typedef void(*forward_function)(double const*, double*, double*);
+        typedef void(*reverse_function)(double const*, double const*, double*, double*, double*);
+
+        static void check(size_t size, size_t expected, char const* what)
+        {
+            if (size != expected)
+            {
+                throw std::runtime_error(what);
+            }
+        }
+
+        void* symbol(char const* name)
+        {
+#   if defined _WIN32
+            void* result = reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library_), name));
+#   else
+            void* result = ::dlsym(library_, name);
+#   endif
+            if (result == nullptr)
+            {
+                close();
+                throw std::runtime_error("Compiled tape " + path_ + " does not export " + name + ".");
+            }
+            return result;
+        }
+
+        void close()
+        {
+            if (library_ != nullptr)
+            {
+#   if defined _WIN32
+                FreeLibrary(static_cast<HMODULE>(library_));
+#   else
+                ::dlclose(library_);
+#   endif
+            }
+            library_ = nullptr;
+        }
+
+        std::string path_;
+        void* library_;
+        size_t domain_;
+        size_t range_;
+        forward_function forward_;
+        reverse_function reverse_;
+        std::vector<double> work_;
+    };
+
+    /// <summary>Generates the C source of the function recorded in f, compiles it
+    /// with the command of the options and loads the result; check
+    /// tape_codegen_options::available first where the compiler may be missing.
+    /// The source is written to path + ".c" and the library to path + ".so"
+    /// (".dll" on Windows); a library stays loaded under its path, so every
+    /// compiled tape needs its own one.</summary>
+    template <class Base>
+    inline std::unique_ptr<compiled_tape_function>
+    compile_tape(tape_function_base<Base> const& f, std::string const& path
+        , tape_codegen_options const& options = tape_codegen_options())
+    {
+        std::string source = path + ".c";
+        std::string library = path + tape_codegen_options::library_suffix();
+        {
+            std::ofstream out(source.c_str());
+            if (!out)
+            {
+                throw std::runtime_error("Cannot write generated tape source " + source + ".");
+            }
+            write_tape_source(f, out, options.chunk_);
+        }
+
+        std::string command = options.command(source, library);
+        if (std::system(command.c_str()) != 0)
+        {
+            throw std::runtime_error("Compilation of generated tape failed, the compiler command"
+                " can be set in CL_TAPE_CODEGEN_COMMAND: " + command);
+        }
+        return std::unique_ptr<compiled_tape_function>(new compiled_tape_function(library));
+    }
+}
+
+# endif // cl_tape_impl_tape_archive_tape_codegen_hpp
@@ -0,0 +1,480 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+# if !defined cl_tape_impl_tape_archive_tape_flat_hpp
+# define cl_tape_impl_tape_archive_tape_flat_hpp
+
+# include <cstdint>
+# include <cstring>
+# include <fstream>
+# include <memory>
+# include <stdexcept>
+# include <string>
+# include <type_traits>
+# include <vector>
+
+# if defined _WIN32
+#   if !defined NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+# else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+# endif
+
+namespace cl
+{
+    /// <summary>Version of the flat tape layout, files of another version are rejected.</summary>
+    const std::uint32_t tape_flat_version = 1;
+
+    /// <summary>Location of one buffer in a flat tape file.</summary>
+    struct tape_flat_section
+    {
+        // Byte offset from the start of the file.
+        std::uint64_t offset_;
+        // Number of elements.
+        std::uint64_t size_;
+    };
+
+    /// <summary>Header at the start of a flat tape file. The buffers of the
+    /// operation sequence follow the header, each one at an offset aligned
+    /// to tape_flat_header::alignment, so they can be used in place.</summary>
+    struct tape_flat_header
+    {
+        enum { alignment = 64 };
+
+        // Flags.
+        enum { optimized = 1 };
+
+        // "cltape" followed by two zero characters.
+        char magic_[8];
+        std::uint32_t version_;
+        // 0x01020304 as written, detects a file of another byte order.
+        std::uint32_t byte_order_;
+        // Sizes of the stored types, detect a file of another platform or Base.
+        std::uint32_t base_size_;
+        std::uint32_t addr_size_;
+        std::uint32_t op_code_size_;
+        std::uint32_t flags_;
+
+        std::uint64_t num_var_;
+        std::uint64_t num_load_op_;
+        std::uint64_t num_vecad_vec_;
+
+        // Buffers of the player, used in place.
+        tape_flat_section op_;
+        tape_flat_section op_arg_;
+        tape_flat_section par_;
+        tape_flat_section text_;
+        tape_flat_section vecad_ind_;
+
+        // Addresses of the independent and dependent variables, copied on load.
+        tape_flat_section ind_taddr_;
+        tape_flat_section dep_taddr_;
+        tape_flat_section dep_parameter_;
+    };
+
+    namespace tapescript
+    {
+        // Places a section of size elements of Ty_ after offset.
+        template <class Ty_>
+        inline tape_flat_section flat_section(std::uint64_t& offset, size_t size)
+        {
+            tape_flat_section section;
+            section.offset_ = (offset + tape_flat_header::alignment - 1)
+                / tape_flat_header::alignment * tape_flat_header::alignment;
+            section.size_ = size;
+            offset = section.offset_ + size * sizeof(Ty_);
+            return section;
+        }
+
+        // Writes a section at its offset, the gap after pos is zero filled.
+        template <class Ty_>
+        inline void write_flat_section(std::ostream& os, std::uint64_t& pos
+            , tape_flat_section const& section, Ty_ const* data)
+        {
+            static const char zeros[tape_flat_header::alignment] = {};
+            os.write(zeros, static_cast<std::streamsize>(section.offset_ - pos));
+
+            std::uint64_t bytes = section.size_ * sizeof(Ty_);
+            if (bytes > 0)
+            {
+                os.write(reinterpret_cast<char const*>(data), static_cast<std::streamsize>(bytes));
+            }
+            pos = section.offset_ + bytes;
+        }
+
+        // Checks that a section lies inside the file and is aligned for Ty_.
+        template <class Ty_>
+        inline void check_flat_section(tape_flat_section const& section, size_t file_size, std::string const& path)
+        {
+            if (section.offset_ % std::alignment_of<Ty_>::value != 0
+                || section.offset_ > file_size
+                || section.size_ > (file_size - section.offset_) / sizeof(Ty_))
+            {
+                throw std::runtime_error("Flat tape " + path + " is truncated or corrupted.");
+            }
+        }
+
+        // Points v to size elements stored at data, the elements are not owned.
+        // pod_vector only releases memory it has allocated (capacity_ > 0),
+        // a later extend allocates and copies, so the stored elements are never written.
+        template <class Ty_>
+        inline void attach_flat_section(CppAD::pod_vector<Ty_>& v, char const* data, tape_flat_section const& section)
+        {
+            v.free();
+            v.data_ = const_cast<Ty_*>(reinterpret_cast<Ty_ const*>(data + section.offset_));
+            v.length_ = static_cast<size_t>(section.size_);
+        }
+    }
+
+    /// <summary>Writes the operation sequence stored in f to path in the flat
+    /// tape layout, which tape_mapped_file maps and mapped_tape_function sweeps
+    /// without copying. Taylor coefficients are not stored.</summary>
+    template <class Base>
+    inline void save_flat_tape(tape_function_base<Base> const& f, std::string const& path)
+    {
+        static_assert(std::is_pod<Base>::value
+            , "Flat tapes store plain values, use tape_archive for this Base.");
+
+        CppAD::player<Base> const& play = f.play_;
+
+        std::vector<std::uint64_t> ind_taddr(f.ind_taddr_.size());
+        for (size_t j = 0; j < ind_taddr.size(); j++)
+        {
+            ind_taddr[j] = f.ind_taddr_[j];
+        }
+        std::vector<std::uint64_t> dep_taddr(f.dep_taddr_.size());
+        std::vector<std::uint8_t> dep_parameter(f.dep_parameter_.size());
+        for (size_t i = 0; i < dep_taddr.size(); i++)
+        {
+            dep_taddr[i] = f.dep_taddr_[i];
+            dep_parameter[i] = f.dep_parameter_[i];
+        }
+
+        tape_flat_header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic_, "cltape\0", 8);
+        header.version_ = tape_flat_version;
+        header.byte_order_ = 0x01020304;
+        header.base_size_ = sizeof(Base);
+        header.addr_size_ = sizeof(CppAD::addr_t);
+        header.op_code_size_ = sizeof(CPPAD_OP_CODE_TYPE);
+        header.flags_ = f.has_been_optimized_ ? tape_flat_header::optimized : 0;
+        header.num_var_ = play.num_var_rec_;
+        header.num_load_op_ = play.num_load_op_rec_;
+        header.num_vecad_vec_ = play.num_vecad_vec_rec_;
+
+        std::uint64_t offset = sizeof(tape_flat_header);
+        header.op_ = tapescript::flat_section<CPPAD_OP_CODE_TYPE>(offset, play.op_rec_.size());
+        header.op_arg_ = tapescript::flat_section<CppAD::addr_t>(offset, play.op_arg_rec_.size());
+        header.par_ = tapescript::flat_section<Base>(offset, play.par_rec_.size());
+        header.text_ = tapescript::flat_section<char>(offset, play.text_rec_.size());
+        header.vecad_ind_ = tapescript::flat_section<CppAD::addr_t>(offset, play.vecad_ind_rec_.size());
+        header.ind_taddr_ = tapescript::flat_section<std::uint64_t>(offset, ind_taddr.size());
+        header.dep_taddr_ = tapescript::flat_section<std::uint64_t>(offset, dep_taddr.size());
+        header.dep_parameter_ = tapescript::flat_section<std::uint8_t>(offset, dep_parameter.size());
+
+        std::ofstream os(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!os)
+        {
+            throw std::runtime_error("Cannot open flat tape " + path + " for writing.");
+        }
+
+        os.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        std::uint64_t pos = sizeof(tape_flat_header);
+        tapescript::write_flat_section(os, pos, header.op_, play.op_rec_.data());
+        tapescript::write_flat_section(os, pos, header.op_arg_, play.op_arg_rec_.data());
+        tapescript::write_flat_section(os, pos, header.par_, play.par_rec_.data());
+        tapescript::write_flat_section(os, pos, header.text_, play.text_rec_.data());
+        tapescript::write_flat_section(os, pos, header.vecad_ind_, play.vecad_ind_rec_.data());
+        tapescript::write_flat_section(os, pos, header.ind_taddr_, ind_taddr.data());
+        tapescript::write_flat_section(os, pos, header.dep_taddr_, dep_taddr.data());
+        tapescript::write_flat_section(os, pos, header.dep_parameter_, dep_parameter.data());
+
+        if (!os.flush())
+        {
+            throw std::runtime_error("Cannot write flat tape " + path + ".");
+        }
+    }
+
+    /// <summary>Read-only memory mapping of a flat tape file. The pages are
+    /// shared by every process which maps the same file.</summary>
+    class tape_mapped_file
+    {
+    public:
+        explicit tape_mapped_file(std::string const& path)
+            : path_(path)
+            , data_(nullptr)
+            , size_(0)
+#   if defined _WIN32
+            , file_(INVALID_HANDLE_VALUE)
+            , mapping_(NULL)
+#   endif
+        {
+#   if defined _WIN32
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ
+                , NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            LARGE_INTEGER size;
+            if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size))
+            {
+                close();
+                throw std::runtime_error("Cannot open flat tape " + path + ".");
+            }
+            size_ = static_cast<size_t>(size.QuadPart);
+
+            mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping_ != NULL)
+            {
+                data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            }
+            if (data_ == nullptr)
+            {
+                close();
+                throw std::runtime_error("Cannot map flat tape " + path + ".");
+            }
+#   else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            struct stat st;
+            if (fd < 0 || ::fstat(fd, &st) != 0)
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+                throw std::runtime_error("Cannot open flat tape " + path + ".");
+            }
+            size_ = static_cast<size_t>(st.st_size);
+
+            void* data = size_ > 0 ? ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if (data == MAP_FAILED)
+            {
+                throw std::runtime_error("Cannot map flat tape " + path + ".");
+            }
+            data_ = data;
+#   endif
+        }
+
+        ~tape_mapped_file()
+        {
+            close();
+        }
+
+        /// <summary>Start of the mapped file.</summary>
+        char const* data() const
+        {
+            return static_cast<char const*>(data_);
+        }
+
+        /// <summary>Size of the mapped file in bytes.</summary>
+        size_t size() const
+        {
+            return size_;
+        }
+
+        /// <summary>Path of the mapped file.</summary>
+        std::string const& path() const
+        {
+            return path_;
+        }
+
+        /// <summary>Reads every page of the file into memory, so that sweeps
+        /// over the mapped buffers do not wait for the disk.</summary>
+        void prefetch() const
+        {
+            char const volatile* data = static_cast<char const volatile*>(data_);
+            char sum = 0;
+            for (size_t i = 0; i < size_; i += 4096)
+            {
+                sum ^= data[i];
+            }
+            (void)sum;
+        }
+
+    private:
+        tape_mapped_file(tape_mapped_file const&);
+        tape_mapped_file& operator=(tape_mapped_file const&);
+
+        void close()
+        {
+#   if defined _WIN32
+            if (data_ != nullptr)
+            {
+                UnmapViewOfFile(data_);
+            }
+            if (mapping_ != NULL)
+            {
+                CloseHandle(mapping_);
+            }
+            if (file_ != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(file_);
+            }
+            mapping_ = NULL;
+            file_ = INVALID_HANDLE_VALUE;
+#   else
+            if (data_ != nullptr)
+            {
+                ::munmap(data_, size_);
+            }
+#   endif
+            data_ = nullptr;
+        }
+
+        std::string path_;
+        void* data_;
+        size_t size_;
+#   if defined _WIN32
+        HANDLE file_;
+        HANDLE mapping_;
+#   endif
+    };
+
+    /// <summary>Makes f sweep the operation sequence stored in the mapped file.
+    /// Operators, arguments and parameters are used in place, only the per
+    /// function state (Taylor coefficients, skip flags) is allocated. The file
+    /// must stay mapped while f holds this operation sequence; recording,
+    /// optimizing or assigning to f replaces it with an owned copy.</summary>
+    template <class Base>
+    inline void attach_flat_tape(tape_function_base<Base>& f, tape_mapped_file const& file)
+    {
+        static_assert(std::is_pod<Base>::value
+            , "Flat tapes store plain values, use tape_archive for this Base.");
+
+        std::string const& path = file.path();
+        if (file.size() < sizeof(tape_flat_header))
+        {
+            throw std::runtime_error("Flat tape " + path + " is truncated or corrupted.");
+        }
+
+        tape_flat_header const& header = *reinterpret_cast<tape_flat_header const*>(file.data());
+        if (std::memcmp(header.magic_, "cltape\0", 8) != 0)
+        {
+            throw std::runtime_error(path + " is not a flat tape.");
+        }
+        if (header.version_ != tape_flat_version)
+        {
+            throw std::runtime_error("Flat tape " + path + " has unsupported version.");
+        }
+        if (header.byte_order_ != 0x01020304
+            || header.base_size_ != sizeof(Base)
+            || header.addr_size_ != sizeof(CppAD::addr_t)
+            || header.op_code_size_ != sizeof(CPPAD_OP_CODE_TYPE))
+        {
+            throw std::runtime_error("Flat tape " + path + " was written for another platform or value type.");
+        }
+
+        tapescript::check_flat_section<CPPAD_OP_CODE_TYPE>(header.op_, file.size(), path);
+        tapescript::check_flat_section<CppAD::addr_t>(header.op_arg_, file.size(), path);
+        tapescript::check_flat_section<Base>(header.par_, file.size(), path);
+        tapescript::check_flat_section<char>(header.text_, file.size(), path);
+        tapescript::check_flat_section<CppAD::addr_t>(header.vecad_ind_, file.size(), path);
+        tapescript::check_flat_section<std::uint64_t>(header.ind_taddr_, file.size(), path);
+        tapescript::check_flat_section<std::uint64_t>(header.dep_taddr_, file.size(), path);
+        tapescript::check_flat_section<std::uint8_t>(header.dep_parameter_, file.size(), path);
+
+        // Function state as set by Dependent.
+        f.has_been_optimized_ = (header.flags_ & tape_flat_header::optimized) != 0;
+        f.compare_change_count_ = 1;
+        f.compare_change_number_ = 0;
+        f.compare_change_op_index_ = 0;
+        f.num_order_taylor_ = 0;
+        f.num_direction_taylor_ = 0;
+        f.cap_order_taylor_ = 0;
+        f.num_var_tape_ = static_cast<size_t>(header.num_var_);
+        f.taylor_.erase();
+
+        f.cskip_op_.erase();
+        f.cskip_op_.extend(static_cast<size_t>(header.op_.size_));
+        f.load_op_.erase();
+        f.load_op_.extend(static_cast<size_t>(header.num_load_op_));
+
+        CppAD::player<Base>& play = f.play_;
+        play.num_var_rec_ = static_cast<size_t>(header.num_var_);
+        play.num_load_op_rec_ = static_cast<size_t>(header.num_load_op_);
+        play.num_vecad_vec_rec_ = static_cast<size_t>(header.num_vecad_vec_);
+        tapescript::attach_flat_section(play.op_rec_, file.data(), header.op_);
+        tapescript::attach_flat_section(play.op_arg_rec_, file.data(), header.op_arg_);
+        tapescript::attach_flat_section(play.par_rec_, file.data(), header.par_);
+        tapescript::attach_flat_section(play.text_rec_, file.data(), header.text_);
+        tapescript::attach_flat_section(play.vecad_ind_rec_, file.data(), header.vecad_ind_);
+
+        std::uint64_t const* ind_taddr = reinterpret_cast<std::uint64_t const*>(file.data() + header.ind_taddr_.offset_);
+        f.ind_taddr_.resize(static_cast<size_t>(header.ind_taddr_.size_));
+        for (size_t j = 0; j < f.ind_taddr_.size(); j++)
+        {
+            f.ind_taddr_[j] = static_cast<size_t>(ind_taddr[j]);
+        }
+
+        std::uint64_t const* dep_taddr = reinterpret_cast<std::uint64_t const*>(file.data() + header.dep_taddr_.offset_);
+        std::uint8_t const* dep_parameter = reinterpret_cast<std::uint8_t const*>(file.data() + header.dep_parameter_.offset_);
+        f.dep_taddr_.resize(static_cast<size_t>(header.dep_taddr_.size_));
+        f.dep_parameter_.resize(f.dep_taddr_.size());
+        for (size_t i = 0; i < f.dep_taddr_.size(); i++)
+        {
+            f.dep_taddr_[i] = static_cast<size_t>(dep_taddr[i]);
+            f.dep_parameter_[i] = dep_parameter[i] != 0;
+        }
+
+        f.for_jac_sparse_pack_.resize(0, 0);
+        f.for_jac_sparse_set_.resize(0, 0);
+    }
+
+    /// <summary>Tape function which sweeps a flat tape file in place. The mapping
+    /// is shared with the functions created from the same tape_mapped_file,
+    /// and stays alive as long as one of them does.</summary>
+    template <class Base>
+    class mapped_tape_function
+        : public tape_function<Base>
+    {
+    public:
+        explicit mapped_tape_function(std::string const& path)
+            : tape_function<Base>()
+            , file_(std::make_shared<tape_mapped_file>(path))
+        {
+            attach_flat_tape<Base>(*this, *file_);
+        }
+
+        explicit mapped_tape_function(std::shared_ptr<tape_mapped_file const> const& file)
+            : tape_function<Base>()
+            , file_(file)
+        {
+            attach_flat_tape<Base>(*this, *file_);
+        }
+
+        /// <summary>Mapping of the flat tape file.</summary>
+        std::shared_ptr<tape_mapped_file const> const& file() const
+        {
+            return file_;
+        }
+
+    private:
+        mapped_tape_function(mapped_tape_function const&);
+        mapped_tape_function& operator=(mapped_tape_function const&);
+
+        std::shared_ptr<tape_mapped_file const> file_;
+    };
+}
+
+# endif // cl_tape_impl_tape_archive_tape_flat_hpp
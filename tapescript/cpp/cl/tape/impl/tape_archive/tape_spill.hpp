@@ -0,0 +1,319 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+# if !defined cl_tape_impl_tape_archive_tape_spill_hpp
+# define cl_tape_impl_tape_archive_tape_spill_hpp
+
+# include <cstdio>
+# include <deque>
+# include <future>
+# include <memory>
+# include <random>
+# include <sstream>
+# include <stdexcept>
+# include <string>
+# include <vector>
+
+# include <cl/tape/impl/tape_archive/tape_flat.hpp>
+
+namespace cl
+{
+    struct tape_spill_options
+    {
+        tape_spill_options(std::string const& directory = "."
+            , size_t memory_budget = size_t(1) << 30
+            , size_t prefetch = 2)
+            : directory_(directory)
+            , memory_budget_(memory_budget)
+            , prefetch_(prefetch)
+        {}
+
+        // Directory of the segment files, should be on a local disk.
+        std::string directory_;
+
+        // Bytes of recorded segments held in memory. While recording the oldest
+        // segments are written to disk above it, the reverse sweep reads ahead
+        // within it.
+        size_t memory_budget_;
+
+        // Number of segments read ahead by the reverse sweep.
+        size_t prefetch_;
+    };
+
+    /// <summary>Recording of a long calculation as a chain of segments, for tapes
+    /// which do not fit in memory. Each segment y = f_k(x) is recorded to its own
+    /// tape between begin and end, its results are the arguments of the next segment.
+    /// Recorded segments stay in memory up to the budget, above it the oldest ones
+    /// are written to disk in the flat tape layout. The reverse sweep runs over the
+    /// segments from the last to the first, the segment files are read back in this
+    /// order by a background thread ahead of the sweep and are used in place.
+    /// Taylor coefficients are not stored, the zero order of each segment is
+    /// recomputed from its argument values before its reverse sweep.</summary>
+    template <class Base>
+    class tape_spill
+    {
+    public:
+        typedef std::vector<cl::tape_wrapper<Base>> tape_vector;
+
+        explicit tape_spill(tape_spill_options const& options = tape_spill_options())
+            : options_(options)
+            , segments_()
+            , x_()
+            , id_()
+            , resident_bytes_(0)
+            , spilled_bytes_(0)
+            , recording_(false)
+        {
+            std::random_device random;
+            std::ostringstream id;
+            id << std::hex << random() << random();
+            id_ = id.str();
+        }
+
+        ~tape_spill()
+        {
+            for (segment const& s : segments_)
+            {
+                if (!s.path_.empty())
+                {
+                    std::remove(s.path_.c_str());
+                }
+            }
+        }
+
+        /// <summary>Starts the recording of the next segment with x as its arguments.
+        /// For all but the first segment x are the results of the previous one.</summary>
+        void begin(tape_vector& x)
+        {
+            if (recording_)
+            {
+                throw std::runtime_error("Segment recording is already started.");
+            }
+            if (!segments_.empty() && segments_.back().range_ != x.size())
+            {
+                throw std::runtime_error("Segment arguments do not match the results of the previous segment.");
+            }
+
+            auto const ax = tapescript::adapt(x);
+            x_.resize(ax.size());
+            for (size_t j = 0; j < x_.size(); j++)
+            {
+                x_[j] = CppAD::Value(ax[j]);
+            }
+
+            cl::Independent(x);
+            recording_ = true;
+        }
+
+        /// <summary>Stops the recording of the segment started with x, y are its results.
+        /// Segments above the memory budget are written to disk.</summary>
+        void end(tape_vector const& x, tape_vector const& y)
+        {
+            if (!recording_)
+            {
+                throw std::runtime_error("Segment recording is not started.");
+            }
+            recording_ = false;
+
+            segment s;
+            s.f_.reset(new tape_function<Base>(x, y));
+            // Zero order coefficients are recomputed by the reverse sweep.
+            s.f_->capacity_order(0);
+            s.x_.swap(x_);
+            s.range_ = y.size();
+            s.bytes_ = bytes(tape_size(*s.f_));
+
+            segments_.push_back(std::move(s));
+            resident_bytes_ += segments_.back().bytes_;
+
+            // The oldest segments are the last ones needed by the reverse sweep.
+            for (size_t k = 0; k < segments_.size() && resident_bytes_ > options_.memory_budget_; k++)
+            {
+                if (segments_[k].f_)
+                {
+                    spill(k);
+                }
+            }
+        }
+
+        /// <summary>Derivatives of w^T y with respect to the arguments
+        /// of the first segment, where y are the results of the last one.</summary>
+        std::vector<Base> reverse(std::vector<Base> const& w)
+        {
+            if (segments_.empty() || segments_.back().range_ != w.size())
+            {
+                throw std::runtime_error("Weights do not match the results of the last segment.");
+            }
+
+            // Files read ahead, in the order of the sweep.
+            std::deque<std::future<std::shared_ptr<tape_mapped_file const>>> ahead;
+            size_t ahead_bytes = 0;
+            // Segments below next are not read ahead yet.
+            size_t next = segments_.size();
+
+            std::vector<Base> dw = w;
+            for (size_t k = segments_.size(); k-- > 0;)
+            {
+                while (next > 0 && ahead.size() <= options_.prefetch_)
+                {
+                    segment const& s = segments_[next - 1];
+                    if (s.f_)
+                    {
+                        --next;
+                        continue;
+                    }
+                    if (!ahead.empty() && ahead_bytes + s.bytes_ > options_.memory_budget_)
+                    {
+                        break;
+                    }
+                    ahead.push_back(std::async(std::launch::async, &tape_spill::read, s.path_));
+                    ahead_bytes += s.bytes_;
+                    --next;
+                }
+
+                segment& s = segments_[k];
+                if (s.f_)
+                {
+                    s.f_->Forward(0, s.x_);
+                    dw = s.f_->Reverse(1, dw);
+                    s.f_->capacity_order(0);
+                }
+                else
+                {
+                    // Function state is allocated by this thread, the reading thread
+                    // only maps the file because thread_alloc is not in parallel mode.
+                    mapped_tape_function<Base> f(ahead.front().get());
+                    ahead.pop_front();
+                    ahead_bytes -= s.bytes_;
+
+                    f.Forward(0, s.x_);
+                    dw = f.Reverse(1, dw);
+                }
+            }
+            return dw;
+        }
+
+        /// <summary>Number of recorded segments.</summary>
+        size_t size() const
+        {
+            return segments_.size();
+        }
+
+        /// <summary>Number of segments written to disk.</summary>
+        size_t spilled() const
+        {
+            size_t result = 0;
+            for (segment const& s : segments_)
+            {
+                result += s.f_ ? 0 : 1;
+            }
+            return result;
+        }
+
+        /// <summary>Bytes of the segments held in memory.</summary>
+        size_t resident_bytes() const
+        {
+            return resident_bytes_;
+        }
+
+        /// <summary>Bytes of the segments written to disk.</summary>
+        size_t spilled_bytes() const
+        {
+            return spilled_bytes_;
+        }
+
+    private:
+        tape_spill(tape_spill const&);
+        tape_spill& operator=(tape_spill const&);
+
+        struct segment
+        {
+            segment()
+                : f_()
+                , x_()
+                , path_()
+                , range_(0)
+                , bytes_(0)
+            {}
+
+            segment(segment&& other)
+                : f_(std::move(other.f_))
+                , x_(std::move(other.x_))
+                , path_(std::move(other.path_))
+                , range_(other.range_)
+                , bytes_(other.bytes_)
+            {}
+
+            // Recorded function, null once the segment is written to disk.
+            std::unique_ptr<tape_function<Base>> f_;
+            // Argument values at recording.
+            std::vector<Base> x_;
+            // File of the segment written to disk.
+            std::string path_;
+            // Number of results.
+            size_t range_;
+            // Bytes of the operation sequence.
+            size_t bytes_;
+        };
+
+        // Memory of an operation sequence and of its skip flags.
+        static size_t bytes(tape_capacity const& c)
+        {
+            return c.num_op_ * (sizeof(CPPAD_OP_CODE_TYPE) + sizeof(bool))
+                + (c.num_op_arg_ + c.num_vec_ind_) * sizeof(CppAD::addr_t)
+                + c.num_par_ * sizeof(Base)
+                + c.num_text_;
+        }
+
+        static std::shared_ptr<tape_mapped_file const> read(std::string const& path)
+        {
+            std::shared_ptr<tape_mapped_file> file = std::make_shared<tape_mapped_file>(path);
+            file->prefetch();
+            return file;
+        }
+
+        void spill(size_t k)
+        {
+            segment& s = segments_[k];
+
+            std::ostringstream path;
+            path << options_.directory_ << "/cl_tape_spill_" << id_ << "_" << k << ".flat";
+            s.path_ = path.str();
+
+            save_flat_tape(*s.f_, s.path_);
+            s.f_.reset();
+
+            resident_bytes_ -= s.bytes_;
+            spilled_bytes_ += s.bytes_;
+        }
+
+        tape_spill_options options_;
+        std::vector<segment> segments_;
+        // Argument values of the segment being recorded.
+        std::vector<Base> x_;
+        // Name part of the segment files unique to this recording.
+        std::string id_;
+        size_t resident_bytes_;
+        size_t spilled_bytes_;
+        bool recording_;
+    };
+}
+
+# endif // cl_tape_impl_tape_archive_tape_spill_hpp
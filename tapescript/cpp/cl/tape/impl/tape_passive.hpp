@@ -0,0 +1,117 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_tape_passive_hpp
+#define cl_tape_impl_tape_passive_hpp
+
+#include <cl/tape/impl/thread_local.hpp>
+
+// The arithmetic of tape_wrapper checks for passive scopes only if this switch
+// is defined. It is set here rather than in the project files so that every
+// translation unit including the tape sees the same operators; removing it
+// compiles the check out of all of them and makes the scopes record again.
+#if !defined CL_TAPE_PASSIVE_ENABLED
+#   define CL_TAPE_PASSIVE_ENABLED
+#endif
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Number of passive scopes open on the calling thread.</summary>
+        inline unsigned& passive_depth()
+        {
+            static CL_THREAD_LOCAL unsigned depth = 0;
+            return depth;
+        }
+
+#if defined CL_TAPE_PASSIVE_ENABLED
+        /// <summary>True if the calling thread is inside a passive scope.</summary>
+        inline bool passive()
+        {
+            return passive_depth() != 0;
+        }
+#else
+        /// <summary>The operators do not check for passive scopes, the check
+        /// is a constant and costs nothing.</summary>
+        inline bool passive()
+        {
+            return false;
+        }
+#endif
+
+        /// <summary>Plain value of a non AD type.</summary>
+        template <typename Type>
+        inline Type const& passive_value(Type const& x)
+        {
+            return x;
+        }
+
+#if defined CL_TAPE_CPPAD
+        /// <summary>Plain value of x, also if x is a variable of the recording.</summary>
+        template <typename Base>
+        inline Base passive_value(CppAD::AD<Base> const& x)
+        {
+            return CppAD::Value(CppAD::Var2Par(x));
+        }
+#endif
+    }
+
+    /// <summary>Scope of passive computations, e.g. day count fractions and
+    /// schedules which do not depend on the market inputs. While the scope is
+    /// open on the calling thread the arithmetic operators, exp, log, sqrt and
+    /// pow of tape_wrapper compute on plain values: nothing is recorded and
+    /// the tape lookup of every operation is skipped, results are parameters
+    /// of the recording. Derivatives of values computed inside the scope with
+    /// respect to variables of the recording are lost, so the scope
+    /// must only enclose code whose results are constant for the tape.
+    /// Comparisons and the other math functions are not affected. Scopes nest.
+    ///
+    /// The check costs a thread local read and a branch in every operation,
+    /// so the operators only compute on plain values when
+    /// CL_TAPE_PASSIVE_ENABLED is defined, which this header does for all
+    /// translation units. Otherwise everything is recorded, but scopes are
+    /// still counted and active() tells whether one is open.</summary>
+    class tape_passive_scope
+    {
+    public:
+        tape_passive_scope()
+        {
+            tapescript::passive_depth()++;
+        }
+
+        ~tape_passive_scope()
+        {
+            tapescript::passive_depth()--;
+        }
+
+        /// <summary>True if the calling thread is inside a passive scope.</summary>
+        static bool active()
+        {
+            return tapescript::passive_depth() != 0;
+        }
+
+    private:
+        tape_passive_scope(tape_passive_scope const&);
+        tape_passive_scope& operator=(tape_passive_scope const&);
+    };
+}
+
+#endif // cl_tape_impl_tape_passive_hpp
@@ -0,0 +1,37 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_thread_local_hpp
+#define cl_tape_impl_thread_local_hpp
+
+/// Storage class of thread local variables. Visual C++ 2013 has no
+/// thread_local, its __declspec(thread) only takes POD types with constant
+/// initializers, so CL_THREAD_LOCAL is only used for such variables, e.g.
+/// counters and flags. Objects with constructors or destructors are kept
+/// in boost::thread_specific_ptr instead.
+#if !defined CL_THREAD_LOCAL
+#   if defined _MSC_VER && _MSC_VER < 1900
+#       define CL_THREAD_LOCAL __declspec(thread)
+#   else
+#       define CL_THREAD_LOCAL thread_local
+#   endif
+#endif
+
+#endif // cl_tape_impl_thread_local_hpp
@@ -0,0 +1,196 @@
+/*
+Copyright (C) 2015-present CompatibL
+
+Performance test results and finance-specific examples are available at:
+
+http://www.tapescript.org
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef cl_tape_impl_worker_pool_hpp
+#define cl_tape_impl_worker_pool_hpp
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include <cl/tape/impl/thread_local.hpp>
+
+namespace cl
+{
+    namespace tapescript
+    {
+        /// <summary>Persistent threads shared by the parallel sweeps and recordings.
+        /// run(num_tasks, work) calls work(t) once for every task t, task zero on
+        /// the calling thread and the others on the workers, and returns when all
+        /// tasks are done. Workers are started on first use and kept until the end
+        /// of the program, so a job costs a wake up rather than a thread start.
+        ///
+        /// One job runs at a time, jobs of other threads wait. A job started from
+        /// inside a task, e.g. a lane sweep within a parallel recording, runs its
+        /// tasks one after the other on the calling thread. The first exception
+        /// of a task is rethrown by run after all tasks have finished.</summary>
+        class worker_pool
+        {
+        public:
+            /// <summary>Pool of the program.</summary>
+            static worker_pool& instance()
+            {
+                static worker_pool pool;
+                return pool;
+            }
+
+            ~worker_pool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                wake_.notify_all();
+                for (auto& worker : workers_)
+                {
+                    worker.join();
+                }
+            }
+
+            /// <summary>Number of worker threads started so far.</summary>
+            size_t size()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return workers_.size();
+            }
+
+            /// <summary>Calls work(t) for t in [0, num_tasks) on num_tasks threads.</summary>
+            void run(size_t num_tasks, std::function<void(size_t)> const& work)
+            {
+                if (num_tasks <= 1 || in_task())
+                {
+                    for (size_t t = 0; t < num_tasks; t++)
+                    {
+                        work(t);
+                    }
+                    return;
+                }
+
+                std::lock_guard<std::mutex> job(job_mutex_);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    while (workers_.size() + 1 < num_tasks)
+                    {
+                        workers_.push_back(std::thread(&worker_pool::loop, this));
+                    }
+                    work_ = &work;
+                    error_ = std::exception_ptr();
+                    num_tasks_ = num_tasks;
+                    next_task_ = 1;
+                    pending_ = num_tasks - 1;
+                }
+                wake_.notify_all();
+
+                execute(work, 0);
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_.wait(lock, [this] { return pending_ == 0; });
+                work_ = 0;
+                if (error_)
+                {
+                    std::exception_ptr error = error_;
+                    error_ = std::exception_ptr();
+                    std::rethrow_exception(error);
+                }
+            }
+
+        private:
+            worker_pool()
+                : work_(0)
+                , num_tasks_(0)
+                , next_task_(0)
+                , pending_(0)
+                , stop_(false)
+            {}
+
+            worker_pool(worker_pool const&);
+            worker_pool& operator=(worker_pool const&);
+
+            // True on the workers and on a thread which runs task zero.
+            static bool& in_task()
+            {
+                static CL_THREAD_LOCAL bool value = false;
+                return value;
+            }
+
+            void execute(std::function<void(size_t)> const& work, size_t t)
+            {
+                bool nested = in_task();
+                in_task() = true;
+                try
+                {
+                    work(t);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_)
+                    {
+                        error_ = std::current_exception();
+                    }
+                }
+                in_task() = nested;
+            }
+
+            // Takes tasks of the current job until the pool is stopped.
+            void loop()
+            {
+                in_task() = true;
+                std::unique_lock<std::mutex> lock(mutex_);
+                for (;;)
+                {
+                    wake_.wait(lock, [this] { return stop_ || next_task_ < num_tasks_; });
+                    if (stop_)
+                    {
+                        return;
+                    }
+
+                    size_t t = next_task_++;
+                    std::function<void(size_t)> const& work = *work_;
+                    lock.unlock();
+                    execute(work, t);
+                    lock.lock();
+
+                    if (--pending_ == 0)
+                    {
+                        done_.notify_one();
+                    }
+                }
+            }
+
+            std::mutex job_mutex_;
+            std::mutex mutex_;
+            std::condition_variable wake_;
+            std::condition_variable done_;
+            std::vector<std::thread> workers_;
+            std::function<void(size_t)> const* work_;
+            std::exception_ptr error_;
+            size_t num_tasks_;
+            size_t next_task_;
+            size_t pending_;
+            bool stop_;
+        };
+    }
+}
+
+#endif // cl_tape_impl_worker_pool_hpp
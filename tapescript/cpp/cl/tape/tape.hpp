@@ -43,6 +43,13 @@ namespace cl
 
 // block fun reverse
 #   define CPPAD_REVERSE_INCLUDED
+
+// pod_vector storage is attached to mapped tapes
+#   include <cppad/local/declare_ad.hpp>
+#   include <cppad/local/op_code.hpp>
+#   define private public
+#   include <cppad/local/pod_vector.hpp>
+#   undef private
 #endif
 
 // Lock undef include
@@ -63,6 +70,11 @@ namespace cl
 #   include <iostream>
 
 #   include <cl/tape/impl/tape_fwd.hpp>
+#   if defined CL_TAPE_INNER_ARRAY_ENABLED
+#       include <cl/tape/impl/ad/tape_cskip_op.hpp>
+#       include <cl/tape/impl/ad/tape_comp_op.hpp>
+#       include <cl/tape/impl/ad/tape_inner_op.hpp>
+#   endif
 #   include <cl/tape/impl/ad/tape_forward0sweep.hpp>
 #   include <cl/tape/impl/ad/tape_forward1sweep.hpp>
 #   include <cl/tape/impl/ad/tape_reverse_sweep.hpp>
@@ -85,6 +97,17 @@ namespace cl
 #   undef private
 
 #   include <cl/tape/impl/ad/tape_reverse.hpp>
+#   include <cl/tape/impl/ad/tape_arena.hpp>
+#   include <cl/tape/impl/ad/tape_optimize.hpp>
+#   include <cl/tape/impl/ad/tape_reverse_workspace.hpp>
+#   include <cl/tape/impl/ad/tape_lane_sweep.hpp>
+#   include <cl/tape/impl/ad/tape_multi_reverse.hpp>
+#   include <cl/tape/impl/ad/tape_sparsity.hpp>
+#   include <cl/tape/impl/ad/tape_hessian.hpp>
+#   include <cl/tape/impl/ad/tape_context.hpp>
+#   include <cl/tape/impl/ad/tape_op_stream.hpp>
+#   include <cl/tape/impl/ad/tape_profile.hpp>
+#   include <cl/tape/impl/ad/tape_fused.hpp>
 
 
 //#   if defined CL_BASE_SERIALIZER_OPEN
@@ -134,6 +157,20 @@ namespace ext
 #include <cl/tape/impl/doublemath.hpp>
 #include <cl/tape/impl/doubleoperators.hpp>
 
+#if defined CL_TAPE_CPPAD
+#   include <cl/tape/impl/ad/tape_checkpoint.hpp>
+#   include <cl/tape/impl/ad/tape_recording.hpp>
+#   include <cl/tape/impl/ad/tape_implicit.hpp>
+#   include <cl/tape/impl/ad/tape_jacobian.hpp>
+#   include <cl/tape/impl/ad/tape_parallel.hpp>
+#endif
+
+#if defined CL_TAPE_CPPAD && !defined CL_USE_NATIVE_FORWARD
+#   include <cl/tape/impl/tape_archive/tape_flat.hpp>
+#   include <cl/tape/impl/tape_archive/tape_spill.hpp>
+#   include <cl/tape/impl/tape_archive/tape_codegen.hpp>
+#endif
+
 #if defined CL_TAPE_COMPLEX_ENABLED
 #   include <cl/tape/impl/traits.hpp>
 #endif
@@ -113,6 +113,302 @@ bool AdjointArrayTest::testInnerArray()
     return ok;
 }
 
+bool AdjointArrayTest::testReverseWorkspace()
+{
+    BOOST_TEST_MESSAGE("Testing repeated reverse sweeps with persistent workspace...");
+
+    // Initializations...
+    InnerArrayTestData td;
+    Size n = 5;
+    InnerArrayTest test(n, &td.outPerform_);
+    std::vector<cl::tape_object> X = { test.X_[0] };
+
+    // Declare an independent variable.
+    cl::Independent(X);
+
+    // Use only one function call to calculate the whole vector.
+    std::vector<cl::tape_object> Y = { TARGET_FUNCTION(X[0]) };
+
+    // Declare a tape function and stop the tape recording.
+    cl::tape_function<cl::tape_value> f(X, Y);
+
+    // Reverse mode calculation with a new partial matrix.
+    cl::tape_value rev = f.Reverse(1, std::vector<cl::tape_value>{ 1.0 })[0];
+
+    // Repeated reverse mode calculations reuse the same workspace and result buffer.
+    bool ok = true;
+    std::vector<cl::tape_value> dw;
+    for (Size k = 0; k < 3; k++)
+    {
+        f.reverse(1, std::vector<cl::tape_value>{ 1.0 }, dw);
+        for (Size i = 0; i < n; i++)
+        {
+            if (std::abs(dw[0].element_at(i) - rev.element_at(i)) > 1e-12)
+            {
+                BOOST_ERROR("\nReverse sweep with workspace mismatch:"
+                    << "\n    sweep:      " << k
+                    << "\n    index:      " << i
+                    << "\n    workspace:  " << dw[0].element_at(i)
+                    << "\n    Reverse:    " << rev.element_at(i));
+                ok = false;
+            }
+        }
+    }
+
+    // Result checking...
+    test.setReverseResults(dw[0]);
+    test.calcAnalytical();
+
+    ok &= test.checkAdjoint<>();
+    return ok;
+}
+
+bool AdjointArrayTest::testLaneParallel()
+{
+    BOOST_TEST_MESSAGE("Testing lane-parallel forward and reverse sweeps...");
+
+    // Initializations...
+    InnerArrayTestData td;
+    Size n = 5;
+    InnerArrayTest test(n, &td.outPerform_);
+    std::vector<cl::tape_object> X = { test.X_[0] };
+
+    // Declare an independent variable.
+    cl::Independent(X);
+
+    // Use only one function call to calculate the whole vector.
+    std::vector<cl::tape_object> Y = { TARGET_FUNCTION(X[0]) };
+
+    // Declare a tape function and stop the tape recording.
+    cl::tape_function<cl::tape_value> f(X, Y);
+
+    // Split lanes in chunks of two between two threads.
+    cl::lane_options options(2, 2);
+
+    // Forward mode calculation.
+    cl::tape_value x(std::valarray<double>(test.input_.data(), n));
+    f.forward_lanes(0, std::vector<cl::tape_value>{ x }, options);
+    cl::tape_value forw = f.forward_lanes(1, std::vector<cl::tape_value>{ 1.0 }, options)[0];
+
+    // Reverse mode calculation.
+    cl::tape_value rev = f.reverse_lanes(std::vector<cl::tape_value>{ 1.0 }, options)[0];
+
+    // Result checking...
+    test.setForwardResults(forw);
+    test.setReverseResults(rev);
+    test.calcAnalytical();
+
+    return test.check();
+}
+
+bool AdjointArrayTest::testFixedLanes()
+{
+    BOOST_TEST_MESSAGE("Testing Adjoint using fixed-width lanes...");
+
+    typedef cl::tape_value4d lanes_type;
+
+    // Vector AAD with std::valarray lanes.
+    std::vector<cl::tape_object> X = { cl::tape_value(1.5), cl::tape_value({ 0.1, 0.2, 0.3, 0.4 }) };
+    cl::Independent(X);
+    std::vector<cl::tape_object> Y = { X[0] * std::exp(X[1] * X[0]) + std::log(X[1]) + std::pow(X[1], X[0]) };
+    cl::tape_function<cl::tape_value> f(X, Y);
+    std::vector<cl::tape_value> rev = f.Reverse(1, std::vector<cl::tape_value>{ 1.0 });
+
+    // The same calculation with fixed-width lanes.
+    std::vector<cl::tape_wrapper<lanes_type>> XL = { lanes_type(1.5), lanes_type({ 0.1, 0.2, 0.3, 0.4 }) };
+    cl::Independent(XL);
+    std::vector<cl::tape_wrapper<lanes_type>> YL = { XL[0] * std::exp(XL[1] * XL[0]) + std::log(XL[1]) + std::pow(XL[1], XL[0]) };
+    cl::tape_function<lanes_type> fl(XL, YL);
+    std::vector<lanes_type> revLanes = fl.Reverse(1, std::vector<lanes_type>{ 1.0 });
+
+    bool ok = std::abs(rev[0].to_scalar() - revLanes[0].to_scalar()) < 1e-12;
+    for (Size i = 0; i < 4; i++)
+    {
+        ok &= std::abs(rev[1].element_at(i) - revLanes[1].element_at(i)) < 1e-12 * std::abs(rev[1].element_at(i));
+    }
+
+    if (!ok)
+    {
+        BOOST_ERROR("\nFixed-width lanes derivatives mismatch:"
+            << "\n    std::valarray:  " << rev[0] << " " << rev[1]
+            << "\n    cl::lanes:      " << revLanes[0] << " " << revLanes[1]);
+    }
+    return ok;
+}
+
+bool AdjointArrayTest::testLaneSelect()
+{
+    BOOST_TEST_MESSAGE("Testing Adjoint for lane-wise payoff selection...");
+
+    // Lanes below, above and at the strike.
+    std::valarray<double> spot = { 90.0, 110.0, 100.0, 120.0 };
+    Real strike = 100.0;
+    Real cash = 5.0;
+
+    std::vector<cl::tape_object> X = { cl::tape_value(spot) };
+    cl::Independent(X);
+
+    PlainVanillaPayoff_T<cl::tape_object> call(Option::Call, cl::tape_object(cl::tape_value(strike)));
+    PlainVanillaPayoff_T<cl::tape_object> put(Option::Put, cl::tape_object(cl::tape_value(strike)));
+    AssetOrNothingPayoff_T<cl::tape_object> asset(Option::Call, cl::tape_object(cl::tape_value(strike)));
+    CashOrNothingPayoff_T<cl::tape_object> digital(Option::Put
+        , cl::tape_object(cl::tape_value(strike)), cl::tape_object(cl::tape_value(cash)));
+
+    std::vector<cl::tape_object> Y = { call(X[0]) + 2.0 * put(X[0]) + 3.0 * asset(X[0]) + digital(X[0]) };
+    cl::tape_function<cl::tape_value> f(X, Y);
+
+    cl::tape_value value = f.Forward(0, std::vector<cl::tape_value>{ cl::tape_value(spot) })[0];
+    cl::tape_value rev = f.Reverse(1, std::vector<cl::tape_value>{ 1.0 })[0];
+
+    // Each lane takes its own branch of every payoff.
+    bool ok = true;
+    for (Size i = 0; i < spot.size(); i++)
+    {
+        Real s = spot[i];
+        Real expected = std::max(s - strike, 0.0) + 2.0 * std::max(strike - s, 0.0)
+            + (s > strike ? 3.0 * s : 0.0) + (s < strike ? cash : 0.0);
+        Real expectedDerivative = (s > strike ? 1.0 + 3.0 : 0.0) + (s < strike ? -2.0 : 0.0);
+
+        ok &= std::abs(value.element_at(i) - expected) < 1e-12;
+        ok &= std::abs(rev.element_at(i) - expectedDerivative) < 1e-12;
+    }
+
+    if (!ok)
+    {
+        BOOST_ERROR("\nLane-wise payoff selection mismatch:"
+            << "\n    value:       " << value
+            << "\n    derivative:  " << rev);
+    }
+    return ok;
+}
+
+bool AdjointArrayTest::testMultiReverse()
+{
+    BOOST_TEST_MESSAGE("Testing reverse mode for several directions at once...");
+
+    // Scalar tape of a function with four results.
+    std::vector<cl::tape_double> X = { 1.5, 0.3, 2.0 };
+    cl::Independent(X);
+    std::vector<cl::tape_double> Y = {
+        X[0] * std::exp(X[1] * X[0]),
+        std::log(X[2]) + X[0] / X[2],
+        std::pow(X[2], X[1]) - X[0],
+        std::max(X[0], X[2]) * X[1]
+    };
+    cl::tape_function<double> f(X, Y);
+    Size n = X.size();
+    Size m = Y.size();
+
+    // Five directions, the last block of four lanes is not full.
+    Size K = 5;
+    std::vector<double> w(m * K);
+    for (Size i = 0; i < w.size(); i++)
+    {
+        w[i] = 0.5 + 0.25 * i;
+    }
+
+    cl::multi_reverse<double> valarrayReverse(f);
+    std::vector<double> dwValarray = valarrayReverse.reverse(w, K);
+    cl::multi_reverse<double, cl::lanes<double, 4>> lanesReverse(f);
+    std::vector<double> dwLanes = lanesReverse.reverse(w, K);
+
+    // Every direction against its own reverse sweep.
+    bool ok = true;
+    for (Size k = 0; k < K; k++)
+    {
+        std::vector<double> wk(w.begin() + k * m, w.begin() + (k + 1) * m);
+        std::vector<double> dw = f.Reverse(1, wk);
+        for (Size j = 0; j < n; j++)
+        {
+            double tol = 1e-12 * std::max(1.0, std::abs(dw[j]));
+            if (std::abs(dwValarray[j * K + k] - dw[j]) > tol
+                || std::abs(dwLanes[j * K + k] - dw[j]) > tol)
+            {
+                BOOST_ERROR("\nSeveral directions reverse mismatch:"
+                    << "\n    direction:      " << k
+                    << "\n    index:          " << j
+                    << "\n    std::valarray:  " << dwValarray[j * K + k]
+                    << "\n    cl::lanes:      " << dwLanes[j * K + k]
+                    << "\n    Reverse:        " << dw[j]);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+bool AdjointArrayTest::testLaneBufferPool()
+{
+    BOOST_TEST_MESSAGE("Testing allocation-free sweeps of array values...");
+
+    typedef cl::tapescript::lane_buffer_pool<cl::tape_array> pool_type;
+
+    // Arithmetic, math functions and comparisons of array and scalar values.
+    Size n = 3;
+    std::vector<cl::tape_object> X = { cl::tape_value(0.5), cl::tape_value(0.7), cl::tape_value(1.1) };
+    cl::Independent(X);
+    cl::tape_object y = X[0] * X[1] - X[2] / (1.0 + X[1]) + std::exp(-0.3 * X[0]) * std::sqrt(X[2])
+        + std::log(1.0 + X[0] * X[2]) - 2.0 / X[1] + std::pow(X[0], X[1]) + std::max(X[0], X[2]);
+    std::vector<cl::tape_object> Y = { y, y * X[0] };
+    cl::tape_function<cl::tape_value> f(X, Y);
+
+    // Two array inputs with eight lanes and a scalar input.
+    std::vector<cl::tape_value> x(n);
+    for (Size j = 0; j < 2; j++)
+    {
+        std::valarray<double> lanes(8);
+        for (Size i = 0; i < lanes.size(); i++)
+        {
+            lanes[i] = 0.5 + 0.2 * j + 0.05 * i;
+        }
+        x[j] = cl::tape_value(lanes);
+    }
+    x[2] = cl::tape_value(1.1);
+    std::vector<cl::tape_value> w = { 1.0, 0.5 };
+
+    std::vector<cl::tape_value> value = f.Forward(0, x);
+    std::vector<cl::tape_value> rev = f.Reverse(1, w);
+
+    // The first sweeps give array storage to the Taylor and Partial rows and
+    // warm the pool up, the next ones take all lane buffers from the pool.
+    cl::tape_context<cl::tape_value> context(f);
+    std::vector<cl::tape_value> yc, dw;
+    context.evaluate(x, w, yc, dw);
+    context.evaluate(x, w, yc, dw);
+    Size allocations = pool_type::allocations();
+    for (Size k = 0; k < 3; k++)
+    {
+        context.evaluate(x, w, yc, dw);
+    }
+
+    bool ok = true;
+    if (pool_type::allocations() != allocations)
+    {
+        BOOST_ERROR("\nLane buffers allocated by warmed up sweeps:"
+            << "\n    after warm up:  " << allocations
+            << "\n    after sweeps:   " << pool_type::allocations());
+        ok = false;
+    }
+
+    for (Size j = 0; j < n; j++)
+    {
+        for (Size i = 0; i < 8; i++)
+        {
+            if (dw[j].element_at(i) != rev[j].element_at(i)
+                || yc[j % 2].element_at(i) != value[j % 2].element_at(i))
+            {
+                BOOST_ERROR("\nSweeps with pooled lane buffers mismatch:"
+                    << "\n    index:     " << j
+                    << "\n    lane:      " << i
+                    << "\n    context:   " << dw[j].element_at(i)
+                    << "\n    Reverse:   " << rev[j].element_at(i));
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
 bool AdjointArrayTest::testMixed()
 {
     BOOST_TEST_MESSAGE("Testing Adjoint using mixed optimization...");
@@ -180,6 +476,12 @@ test_suite* AdjointArrayTest::suite()
 
     suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testNoOpt));
     suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testInnerArray));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testReverseWorkspace));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testLaneParallel));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testFixedLanes));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testLaneSelect));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testMultiReverse));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testLaneBufferPool));
     suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::testMixed));
     suite->add(QUANTLIB_TEST_CASE(&AdjointArrayTest::printAll));
 
@@ -199,6 +501,30 @@ BOOST_AUTO_TEST_CASE(testArrayInnerArray)
 {
     BOOST_CHECK(AdjointArrayTest::testInnerArray());
 }
+BOOST_AUTO_TEST_CASE(testArrayReverseWorkspace)
+{
+    BOOST_CHECK(AdjointArrayTest::testReverseWorkspace());
+}
+BOOST_AUTO_TEST_CASE(testArrayLaneParallel)
+{
+    BOOST_CHECK(AdjointArrayTest::testLaneParallel());
+}
+BOOST_AUTO_TEST_CASE(testArrayFixedLanes)
+{
+    BOOST_CHECK(AdjointArrayTest::testFixedLanes());
+}
+BOOST_AUTO_TEST_CASE(testArrayLaneSelect)
+{
+    BOOST_CHECK(AdjointArrayTest::testLaneSelect());
+}
+BOOST_AUTO_TEST_CASE(testArrayMultiReverse)
+{
+    BOOST_CHECK(AdjointArrayTest::testMultiReverse());
+}
+BOOST_AUTO_TEST_CASE(testArrayLaneBufferPool)
+{
+    BOOST_CHECK(AdjointArrayTest::testLaneBufferPool());
+}
 BOOST_AUTO_TEST_CASE(testArrayMixed)
 {
     BOOST_CHECK(AdjointArrayTest::testMixed());
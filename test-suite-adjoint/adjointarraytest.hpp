@@ -29,6 +29,12 @@ class AdjointArrayTest
 {
 public:
     static bool testInnerArray();
+    static bool testReverseWorkspace();
+    static bool testLaneParallel();
+    static bool testFixedLanes();
+    static bool testLaneSelect();
+    static bool testMultiReverse();
+    static bool testLaneBufferPool();
     static bool testMixed();
     static bool testNoOpt();
     static bool printAll();
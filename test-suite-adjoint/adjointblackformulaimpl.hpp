@@ -30,6 +30,8 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 #include "adjointtestutilities.hpp"
 #include "adjointtestbase.hpp"
 #include <ql/pricingengines/blackformula.hpp>
+#include <ql/math/solvers1d/brent.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
 
 using namespace QuantLib;
 using namespace boost::unit_test_framework;
@@ -87,6 +87,114 @@ bool AdjointBlackFormulaTest::testBachelierImpliedVolStdDev()
     return test.checkAdjoint();
 }
 
+namespace
+{
+    // Error of the yield y of a bullet bond with annual cash flows,
+    // without a derivative method.
+    class YieldError
+    {
+    public:
+        YieldError(std::vector<Real> const& cashFlows, Real price)
+            : cashFlows_(cashFlows)
+            , price_(price)
+        {}
+
+        Real operator()(Real y) const
+        {
+            Real value = 0.0;
+            for (Size i = 0; i < cashFlows_.size(); i++)
+                value += cashFlows_[i] * std::exp(-y * (i + 1.0));
+            return value - price_;
+        }
+
+    private:
+        std::vector<Real> const& cashFlows_;
+        Real price_;
+    };
+}
+
+// 1-D solvers record the function at the root only and the derivatives of the
+// implicit function theorem, for Black implied standard deviations (NewtonSafe
+// with the vega of the helper) and for bond yields (Brent with finite differences).
+bool AdjointBlackFormulaTest::testImpliedStdDevImplicitFunction()
+{
+    BOOST_TEST_MESSAGE("Testing implicit function derivatives of 1-D solvers...");
+
+    bool ok = true;
+
+    Real forward = 105.0, discount = 0.95, stdDev = 0.2;
+    Real strikes[] = { 100.0, 110.0 };
+    Option::Type types[] = { Option::Call, Option::Put };
+    for (Size i = 0; i < 2; i++)
+    {
+        for (Size j = 0; j < 2; j++)
+        {
+            Real price = blackFormula(types[j], strikes[i], forward, stdDev, discount);
+            std::vector<cl::tape_double> X = { strikes[i], forward, price, discount };
+            cl::Independent(X);
+            std::vector<cl::tape_double> Y(1);
+            Y[0] = blackFormulaImpliedStdDev(types[j], X[0], X[1], X[2], X[3]
+                , 0.0, Null<Real>(), 1.0e-6, 100, true);
+            cl::tape_function<double> f(X, Y);
+            std::vector<double> jacobian = f.Jacobian(std::vector<double>(X.begin(), X.end()));
+
+            // d stdDev / d price is the inverse of the vega
+            Real d1 = std::log(forward / strikes[i]) / stdDev + 0.5 * stdDev;
+            Real vega = discount * forward * NormalDistribution()(d1);
+            if (std::abs(jacobian[2] - 1.0 / vega) > 1e-10)
+            {
+                BOOST_ERROR("\nDerivative of implied standard deviation mismatch:"
+                    << "\n    option type: " << types[j]
+                    << "\n    strike:      " << strikes[i]
+                    << "\n    derivative:  " << jacobian[2]
+                    << "\n    expected:    " << 1.0 / vega);
+                ok = false;
+            }
+        }
+    }
+
+    size_t sizeOp[2];
+    Real yield[2];
+    std::vector<double> jacobian[2];
+    for (Size k = 0; k < 2; k++)
+    {
+        std::vector<cl::tape_double> X = { 5.0, 5.0, 5.0, 5.0, 105.0, 98.0 };
+        cl::Independent(X);
+        std::vector<Real> cashFlows(X.begin(), X.begin() + 5);
+        YieldError error(cashFlows, X[5]);
+        Brent solver;
+        solver.setImplicitDifferentiation(k == 1);
+        std::vector<cl::tape_double> Y(1, solver.solve(error, 1e-12, 0.05, 0.01));
+        cl::tape_function<double> f(X, Y);
+        sizeOp[k] = f.size_op();
+        yield[k] = Y[0];
+        jacobian[k] = f.Jacobian(std::vector<double>(X.begin(), X.end()));
+    }
+
+    if (yield[0] != yield[1] || sizeOp[1] >= sizeOp[0])
+    {
+        BOOST_ERROR("\nImplicit root mismatch:"
+            << "\n    yield:               " << yield[0]
+            << "\n    implicit yield:      " << yield[1]
+            << "\n    operations:          " << sizeOp[0]
+            << "\n    implicit operations: " << sizeOp[1]);
+        ok = false;
+    }
+    for (Size j = 0; j < jacobian[0].size(); j++)
+    {
+        if (std::abs(jacobian[1][j] - jacobian[0][j]) > 1e-8)
+        {
+            BOOST_ERROR("\nDerivative of yield mismatch:"
+                << "\n    input:      " << j
+                << "\n    iterations: " << jacobian[0][j]
+                << "\n    implicit:   " << jacobian[1][j]);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
 test_suite* AdjointBlackFormulaTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("Adjoint Bachelier Black formula tests");
@@ -94,6 +202,7 @@ test_suite* AdjointBlackFormulaTest::suite()
     suite->add(QUANTLIB_TEST_CASE(&AdjointBlackFormulaTest::testBachelierImpliedVolMaturityTime));
     suite->add(QUANTLIB_TEST_CASE(&AdjointBlackFormulaTest::testBachelierImpliedVolStdDev));
     suite->add(QUANTLIB_TEST_CASE(&AdjointBlackFormulaTest::testBachelierImpliedVolMoneyness));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointBlackFormulaTest::testImpliedStdDevImplicitFunction));
 
     return suite;
 }
@@ -117,6 +226,11 @@ BOOST_AUTO_TEST_CASE(testBachelierImpliedVolMoneyness)
     BOOST_CHECK(AdjointBlackFormulaTest::testBachelierImpliedVolMoneyness());
 }
 
+BOOST_AUTO_TEST_CASE(testImpliedStdDevImplicitFunction)
+{
+    BOOST_CHECK(AdjointBlackFormulaTest::testImpliedStdDevImplicitFunction());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
\ No newline at end of file
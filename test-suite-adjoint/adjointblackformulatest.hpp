@@ -35,6 +35,7 @@ public:
     static bool testBachelierImpliedVolMoneyness();
     static bool testBachelierImpliedVolMaturityTime();
     static bool testBachelierImpliedVolStdDev();
+    static bool testImpliedStdDevImplicitFunction();
     static boost::unit_test_framework::test_suite* suite();
 };
 
@@ -198,11 +198,15 @@ namespace
 
             Size minPerfIteration() { return iterNumFactor; }
 
+            // Tape is re-recorded for every performance iteration,
+            // the arena keeps the memory of the previous recording.
             void recordTape()
             {
-                cl::Independent(rate_);
+                cl::Independent(rate_, arena_);
                 calculatePortfolioPrice();
-                f_ = std::make_unique<cl::tape_function<double>>(rate_, portfolioPrice_);
+                if (!f_)
+                    f_ = std::make_unique<cl::tape_function<double>>();
+                f_->Dependent(rate_, portfolioPrice_, arena_);
             }
 
             // Calculates price of portfolio and each option.
@@ -229,6 +233,7 @@ namespace
             TestData* data_;
             std::vector<cl::tape_double> rate_;
             std::vector<cl::tape_double> portfolioPrice_;
+            cl::tape_arena<double> arena_;
         };
 
         TestData()
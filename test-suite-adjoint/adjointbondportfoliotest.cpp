@@ -63,10 +63,340 @@ bool AdjointBondPortfolioTest::testBondPortfolio()
     return test.check() && testData.makeOutput();
 }
 
+// The tape is recorded several times with the same arena. After the first recording
+// the tape sizes should not grow and derivatives should match finite differences.
+bool AdjointBondPortfolioTest::testBondPortfolioArena()
+{
+    BOOST_TEST_MESSAGE("Testing re-recording of bond portfolio tape with arena-backed storage...");
+
+    TestData testData;
+
+    size_t n = 100;
+    BondPortfolioTest test(n, &testData);
+
+    bool ok = true;
+    cl::tape_capacity firstRecording;
+    size_t firstHeld = 0;
+    size_t thread = CppAD::thread_alloc::thread_num();
+    for (size_t k = 0; k < 5; k++)
+    {
+        test.recordTape();
+
+        // While the arena is alive memory taken from the system is never
+        // given back, so the bytes in use or available only stay the same
+        // if the recording was served from the blocks of the previous one.
+        size_t held = CppAD::thread_alloc::inuse(thread)
+            + CppAD::thread_alloc::available(thread);
+        if (k == 0)
+        {
+            firstRecording = test.arena_.high_water();
+            firstHeld = held;
+        }
+        else if (!firstRecording.covers(test.arena_.high_water()))
+        {
+            BOOST_ERROR("\nTape size grows on re-recording:"
+                << "\n    recording:          " << k
+                << "\n    operators:          " << test.arena_.high_water().num_op_
+                << "\n    first recording:    " << firstRecording.num_op_);
+            ok = false;
+        }
+        else if (held > firstHeld || test.arena_.memory_available() == 0)
+        {
+            BOOST_ERROR("\nRe-recording allocates memory:"
+                << "\n    recording:          " << k
+                << "\n    bytes held:         " << held
+                << "\n    first recording:    " << firstHeld
+                << "\n    bytes available:    " << test.arena_.memory_available());
+            ok = false;
+        }
+    }
+
+    if (test.arena_.recordings() != 5)
+    {
+        BOOST_ERROR("\nArena recordings count mismatch: " << test.arena_.recordings());
+        ok = false;
+    }
+
+    // Forward mode derivatives calculation.
+    test.forwardResults_.resize(n);
+    std::vector<double> dX(n, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        dX[i] = 1;
+        test.forwardResults_[i] = test.f_->Forward(1, dX)[0];
+        dX[i] = 0;
+    }
+
+    // Reverse mode derivatives calulation.
+    test.reverseResults_ = test.f_->Reverse(1, std::vector<double>(1, 1));
+
+    test.calcAnalytical();
+
+    return test.check() && ok;
+}
+
+bool AdjointBondPortfolioTest::testBondPortfolioReplay()
+{
+    BOOST_TEST_MESSAGE("Testing replay of bond portfolio tape on rate scenarios...");
+
+    TestData testData;
+
+    size_t n = 100;
+    BondPortfolioTest test(n, &testData);
+    test.recordTape();
+
+    bool ok = true;
+    std::vector<double> rates(n), price;
+    for (size_t k = 0; k < 10; k++)
+    {
+        // Parallel shift of the recorded rates.
+        Real expected = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            rates[i] = 0.03 + 0.001 * i + 0.0005 * k;
+            expected += testData.calculatePrice(rates[i]);
+        }
+
+        size_t changes = test.f_->replay(rates, price);
+        if (changes != 0)
+        {
+            BOOST_ERROR("\nComparison outcome changed on replay:"
+                << "\n    scenario:           " << k
+                << "\n    changes:            " << changes);
+            ok = false;
+        }
+        if (std::abs(price[0] - expected) > 1e-10 * std::abs(expected))
+        {
+            BOOST_ERROR("\nReplayed portfolio price mismatch:"
+                << "\n    scenario:           " << k
+                << "\n    replayed price:     " << price[0]
+                << "\n    calculated price:   " << expected);
+            ok = false;
+        }
+    }
+
+    // A branch taken at recording is reported when the replay would take the other one.
+    std::vector<cl::tape_double> X(1, 2.0);
+    cl::Independent(X);
+    std::vector<cl::tape_double> Y(1, X[0] > 1.0 ? X[0] * X[0] : 2.0 * X[0]);
+    cl::tape_function<double> f(X, Y);
+
+    std::vector<double> y;
+    if (f.replay(std::vector<double>(1, 3.0), y) != 0 || std::abs(y[0] - 9.0) > 1e-14)
+    {
+        BOOST_ERROR("\nReplay on the recorded branch reports a change or a wrong value: " << y[0]);
+        ok = false;
+    }
+    if (f.replay(std::vector<double>(1, 0.5), y) != 1)
+    {
+        BOOST_ERROR("\nBranch change is not reported on replay");
+        ok = false;
+    }
+
+    return ok;
+}
+
+bool AdjointBondPortfolioTest::testBondPortfolioFlatTape()
+{
+    BOOST_TEST_MESSAGE("Testing bond portfolio tape loaded from a mapped flat file...");
+
+    TestData testData;
+
+    size_t n = 100;
+    BondPortfolioTest test(n, &testData);
+    test.recordTape();
+
+    std::string path = "AdjointBondPortfolio.flat";
+    cl::save_flat_tape(*test.f_, path);
+
+    bool ok = true;
+    {
+        // Two functions share the pages of one mapping.
+        auto file = std::make_shared<cl::tape_mapped_file const>(path);
+        cl::mapped_tape_function<double> f(file);
+        cl::mapped_tape_function<double> g(file);
+
+        std::vector<double> rates(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            rates[i] = 0.031 + 0.001 * i;
+        }
+        std::vector<double> recorded = test.f_->Forward(0, rates);
+        std::vector<double> mapped = f.Forward(0, rates);
+        if (std::abs(mapped[0] - recorded[0]) > 1e-12 * std::abs(recorded[0]))
+        {
+            BOOST_ERROR("\nMapped tape price mismatch:"
+                << "\n    mapped price:       " << mapped[0]
+                << "\n    recorded price:     " << recorded[0]);
+            ok = false;
+        }
+
+        // Derivatives at the recorded rates.
+        for (size_t i = 0; i < n; i++)
+        {
+            rates[i] = CppAD::Value(test.rate_[i].value());
+        }
+        g.Forward(0, rates);
+
+        // Forward mode derivatives calculation.
+        test.forwardResults_.resize(n);
+        std::vector<double> dX(n, 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            dX[i] = 1;
+            test.forwardResults_[i] = g.Forward(1, dX)[0];
+            dX[i] = 0;
+        }
+
+        // Reverse mode derivatives calulation.
+        test.reverseResults_ = g.Reverse(1, std::vector<double>(1, 1));
+    }
+    std::remove(path.c_str());
+
+    test.calcAnalytical();
+
+    return test.check() && ok;
+}
+
+// Each bond is priced at the average of two neighbouring curve pillars, the Jacobian
+// of the bond prices with respect to the pillars has two non-zero elements per row.
+bool AdjointBondPortfolioTest::testBondPortfolioSparseJacobian()
+{
+    BOOST_TEST_MESSAGE("Testing sparse Jacobian of bond prices to curve pillars...");
+
+    TestData testData;
+
+    size_t n = 100;
+    std::vector<cl::tape_double> pillar(n + 1);
+    std::vector<double> x(n + 1);
+    for (size_t j = 0; j <= n; j++)
+    {
+        x[j] = 0.03 + 0.001 * j;
+        pillar[j] = x[j];
+    }
+
+    // Tape recording.
+    cl::Independent(pillar);
+    std::vector<cl::tape_double> price(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        price[i] = testData.calculatePrice(0.5 * (pillar[i] + pillar[i + 1]));
+    }
+    cl::tape_function<double> f(pillar, price);
+
+    bool ok = true;
+    cl::tape_sparsity pattern = f.jacobian_sparsity();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (pattern[i] != std::set<size_t>{ i, i + 1 })
+        {
+            BOOST_ERROR("\nUnexpected Jacobian sparsity in row " << i);
+            ok = false;
+        }
+    }
+
+    // Neighbouring pillars need different colours, two sweeps are enough.
+    cl::tape_sparse_matrix<double> jac;
+    cl::tape_colouring colouring;
+    size_t sweeps = f.sparse_jacobian(x, jac, colouring);
+    if (jac.nnz() != 2 * n || sweeps != 2)
+    {
+        BOOST_ERROR("\nUnexpected sparse Jacobian size:"
+            << "\n    non-zero elements:  " << jac.nnz()
+            << "\n    sweeps:             " << sweeps);
+        ok = false;
+    }
+
+    // The pattern and the colouring are reused on a shifted curve.
+    for (size_t j = 0; j <= n; j++)
+    {
+        x[j] += 0.0005;
+    }
+    f.sparse_jacobian(x, jac, colouring);
+    std::vector<double> dense = f.Jacobian(x);
+    for (size_t k = 0; k < jac.nnz(); k++)
+    {
+        double expected = dense[jac.row_[k] * (n + 1) + jac.col_[k]];
+        if (std::abs(jac.value_[k] - expected) > 1e-10 * std::abs(expected))
+        {
+            BOOST_ERROR("\nSparse Jacobian element mismatch:"
+                << "\n    row:                " << jac.row_[k]
+                << "\n    column:             " << jac.col_[k]
+                << "\n    sparse Jacobian:    " << jac.value_[k]
+                << "\n    dense Jacobian:     " << expected);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// Day counters evaluate their year fractions in passive scopes, which record nothing.
+// A passive scope drops the dependence of the values computed inside it on the
+// recorded rates, here of one of the two discount factors.
+bool AdjointBondPortfolioTest::testBondPortfolioPassive()
+{
+    BOOST_TEST_MESSAGE("Testing passive scopes in recording of discount factors...");
+
+    TestData testData;
+    bool ok = true;
+
+    Date today = testData.today_;
+    Date maturity = today + 2 * Years;
+    Time t = testData.bondDayCount_.yearFraction(today, maturity);
+
+    size_t sizeOp[2];
+    std::vector<double> gradient[2];
+    for (size_t k = 0; k < 2; k++)
+    {
+        std::vector<cl::tape_double> rate(1, 0.03);
+        cl::Independent(rate);
+        cl::tape_double period;
+        {
+            std::unique_ptr<cl::tape_passive_scope> passive(k ? new cl::tape_passive_scope() : 0);
+            period = std::exp(-rate[0] * testData.bondDayCount_.yearFraction(today, maturity)) * t;
+        }
+        std::vector<cl::tape_double> discount(1, std::exp(-rate[0] * t) * period);
+        cl::tape_function<double> g(rate, discount);
+        sizeOp[k] = g.size_op();
+        gradient[k] = g.Reverse(1, std::vector<double>(1, 1));
+    }
+
+    if (cl::tape_passive_scope::active() || sizeOp[1] >= sizeOp[0])
+    {
+        BOOST_ERROR("\nPassive scope does not reduce the tape:"
+            << "\n    operations:         " << sizeOp[0]
+            << "\n    passive operations: " << sizeOp[1]);
+        ok = false;
+    }
+
+    // Only the discount factor outside of the scope depends on the rate.
+    Real period = std::exp(-0.03 * t) * t;
+    Real expected[2] = { -2 * t * std::exp(-0.03 * t) * period, -t * std::exp(-0.03 * t) * period };
+    for (size_t k = 0; k < 2; k++)
+    {
+        if (std::abs(gradient[k][0] - expected[k]) > 1e-12)
+        {
+            BOOST_ERROR("\nDerivative of discount factor mismatch:"
+                << "\n    passive:            " << k
+                << "\n    derivative:         " << gradient[k][0]
+                << "\n    expected:           " << expected[k]);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
 test_suite*  AdjointBondPortfolioTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("AD Bond Portfolio  test");
     suite->add(QUANTLIB_TEST_CASE(&AdjointBondPortfolioTest::testBondPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointBondPortfolioTest::testBondPortfolioArena));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointBondPortfolioTest::testBondPortfolioReplay));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointBondPortfolioTest::testBondPortfolioFlatTape));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointBondPortfolioTest::testBondPortfolioSparseJacobian));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointBondPortfolioTest::testBondPortfolioPassive));
     return suite;
 }
 
@@ -79,6 +409,31 @@ BOOST_AUTO_TEST_CASE(testBondPortfolio)
     BOOST_CHECK(AdjointBondPortfolioTest::testBondPortfolio());
 }
 
+BOOST_AUTO_TEST_CASE(testBondPortfolioArena)
+{
+    BOOST_CHECK(AdjointBondPortfolioTest::testBondPortfolioArena());
+}
+
+BOOST_AUTO_TEST_CASE(testBondPortfolioReplay)
+{
+    BOOST_CHECK(AdjointBondPortfolioTest::testBondPortfolioReplay());
+}
+
+BOOST_AUTO_TEST_CASE(testBondPortfolioFlatTape)
+{
+    BOOST_CHECK(AdjointBondPortfolioTest::testBondPortfolioFlatTape());
+}
+
+BOOST_AUTO_TEST_CASE(testBondPortfolioSparseJacobian)
+{
+    BOOST_CHECK(AdjointBondPortfolioTest::testBondPortfolioSparseJacobian());
+}
+
+BOOST_AUTO_TEST_CASE(testBondPortfolioPassive)
+{
+    BOOST_CHECK(AdjointBondPortfolioTest::testBondPortfolioPassive());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
\ No newline at end of file
@@ -26,6 +26,11 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 class AdjointBondPortfolioTest{
 public:
     static bool testBondPortfolio();
+    static bool testBondPortfolioArena();
+    static bool testBondPortfolioReplay();
+    static bool testBondPortfolioFlatTape();
+    static bool testBondPortfolioSparseJacobian();
+    static bool testBondPortfolioPassive();
     static boost::unit_test_framework::test_suite* suite();
 };
 
@@ -653,6 +653,25 @@ namespace
             }
         }
 
+        // Records the price of the portfolio with the stock prices and then the
+        // volatilities of all options as independent variables, x receives their values.
+        std::unique_ptr<cl::tape_function<double>> recordMarketTape(std::vector<double>& x)
+        {
+            std::vector<cl::tape_double> X(data_[stock]);
+            X.insert(X.end(), data_[sigma].begin(), data_[sigma].end());
+            x.resize(X.size());
+            for (size_t j = 0; j < X.size(); j++)
+            {
+                x[j] = CppAD::Value(X[j].value());
+            }
+
+            cl::Independent(X);
+            std::copy(X.begin(), X.begin() + size_, data_[stock].begin());
+            std::copy(X.begin() + size_, X.end(), data_[sigma].begin());
+            calculatePrices();
+            return std::unique_ptr<cl::tape_function<double>>(new cl::tape_function<double>(X, totalPrice_));
+        }
+
         // Calculates Greeks using analytical method.
         std::vector<Real> analytical()
         {
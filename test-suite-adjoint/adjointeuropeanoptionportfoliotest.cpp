@@ -19,6 +19,7 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 
 
 #include "adjointeuropeanoptionportfolioimpl.hpp"
+#include <thread>
 
 
 bool AdjointEuropeanOptionPortfolioTest::testDeltaCallPortfolio()
@@ -242,6 +243,423 @@ bool AdjointEuropeanOptionPortfolioTest::testColorCallPortfolio()
 }
 
 
+bool AdjointEuropeanOptionPortfolioTest::testHessianCallPortfolio()
+{
+    BOOST_TEST_MESSAGE("Testing Hessian calculations for Europeam Option Portfolio...");
+
+    size_t n = testPortfolioSize;
+    GreekTestData test;
+    test.setPseudorandomData(n);
+
+    // Stock prices and volatilities of all options are independent variables.
+    std::vector<double> x;
+    std::unique_ptr<cl::tape_function<double>> tape = test.recordMarketTape(x);
+    cl::tape_function<double>& f = *tape;
+
+    // Options do not depend on each other, the colouring needs a few sweeps only.
+    std::vector<double> w(1, 1);
+    cl::tape_sparse_matrix<double> hes;
+    CppAD::sparse_hessian_work work;
+    size_t sweeps = f.sparse_hessian(x, w, hes, work);
+
+    bool ok = true;
+    if (hes.nnz() != 4 * n || sweeps >= 2 * n)
+    {
+        BOOST_ERROR("\nUnexpected Hessian sparsity:"
+            << "\n    non-zero elements:  " << hes.nnz()
+            << "\n    sweeps:             " << sweeps);
+        ok = false;
+    }
+
+    FdCheckingModel gammaModel(&delta, stock, 1e-6, 1e-4);
+    FdCheckingModel vommaModel(&vega, sigma, 3e-7, 1e-4);
+    FdCheckingModel vannaModel(&delta, sigma, 3e-7, 1e-4, 1e-10);
+    for (size_t k = 0; k < hes.nnz(); k++)
+    {
+        size_t i = hes.row_[k] % n;
+        std::vector<Real> optionData = test.optionData(i);
+        Real expected;
+        double tol;
+        if (hes.row_[k] < n && hes.col_[k] < n)
+        {
+            expected = gammaModel(optionData);
+            tol = gammaModel.relativeTol_ * std::abs(expected) + gammaModel.absTol_;
+        }
+        else if (hes.row_[k] >= n && hes.col_[k] >= n)
+        {
+            expected = vommaModel(optionData);
+            tol = vommaModel.relativeTol_ * std::abs(expected) + vommaModel.absTol_;
+        }
+        else
+        {
+            expected = vannaModel(optionData);
+            tol = vannaModel.relativeTol_ * std::abs(expected) + vannaModel.absTol_;
+        }
+
+        if (hes.row_[k] % n != hes.col_[k] % n || std::abs(hes.value_[k] - expected) > tol)
+        {
+            BOOST_ERROR("\nHessian element mismatch:"
+                << "\n    row:       " << hes.row_[k]
+                << "\n    column:    " << hes.col_[k]
+                << "\n    tape:      " << hes.value_[k]
+                << "\n    expected:  " << expected);
+            ok = false;
+        }
+    }
+
+    // Hessian-vector product in the direction of a parallel shift of all inputs.
+    std::vector<double> v(2 * n, 1);
+    std::vector<double> hv = f.hessian_times(w, v);
+    std::vector<double> rowSum(2 * n, 0);
+    for (size_t k = 0; k < hes.nnz(); k++)
+    {
+        rowSum[hes.row_[k]] += hes.value_[k];
+    }
+    for (size_t j = 0; j < 2 * n; j++)
+    {
+        if (std::abs(hv[j] - rowSum[j]) > 1e-10 * std::max(1.0, std::abs(rowSum[j])))
+        {
+            BOOST_ERROR("\nHessian-vector product mismatch:"
+                << "\n    index:           " << j
+                << "\n    hessian_times:   " << hv[j]
+                << "\n    sparse_hessian:  " << rowSum[j]);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+
+bool AdjointEuropeanOptionPortfolioTest::testCompiledCallPortfolio()
+{
+    BOOST_TEST_MESSAGE("Testing European Option Portfolio tape compiled to native code...");
+
+    // The compiler is taken from CL_TAPE_CODEGEN_COMMAND or the platform default.
+    cl::tape_codegen_options options;
+    if (!options.available())
+    {
+        BOOST_TEST_MESSAGE("Skipped, the compiler of the command is not found: " << options.command_);
+        return true;
+    }
+
+    size_t n = testPortfolioSize;
+    GreekTestData test;
+    test.setPseudorandomData(n);
+
+    // Stock prices and volatilities of all options are independent variables.
+    std::vector<double> x;
+    std::unique_ptr<cl::tape_function<double>> tape = test.recordMarketTape(x);
+    cl::tape_function<double>& f = *tape;
+
+    std::string path = "AdjointEuropeanOptionPortfolioCompiled";
+    std::unique_ptr<cl::compiled_tape_function> g = cl::compile_tape(f, path, options);
+
+    // Prices and sensitivities at shifted inputs, away from the recorded ones.
+    for (size_t j = 0; j < 2 * n; j++)
+    {
+        x[j] *= 1.01;
+    }
+    std::vector<double> w(1, 1);
+    std::vector<double> price = f.Forward(0, x);
+    std::vector<double> sensitivities = f.Reverse(1, w);
+    std::vector<double> compiledPrice = g->forward(x);
+    std::vector<double> compiledSensitivities = g->reverse(x, w);
+
+    bool ok = true;
+    if (std::abs(compiledPrice[0] - price[0]) > 1e-12 * std::abs(price[0]))
+    {
+        BOOST_ERROR("\nCompiled tape price mismatch:"
+            << "\n    compiled price:  " << compiledPrice[0]
+            << "\n    tape price:      " << price[0]);
+        ok = false;
+    }
+    for (size_t j = 0; j < 2 * n; j++)
+    {
+        if (std::abs(compiledSensitivities[j] - sensitivities[j]) > 1e-10 * std::max(1.0, std::abs(sensitivities[j])))
+        {
+            BOOST_ERROR("\nCompiled tape sensitivity mismatch:"
+                << "\n    index:     " << j
+                << "\n    compiled:  " << compiledSensitivities[j]
+                << "\n    tape:      " << sensitivities[j]);
+            ok = false;
+        }
+    }
+
+    g.reset();
+    std::remove((path + ".c").c_str());
+    std::remove((path + cl::tape_codegen_options::library_suffix()).c_str());
+    return ok;
+}
+
+
+bool AdjointEuropeanOptionPortfolioTest::testConcurrentCallPortfolio()
+{
+    BOOST_TEST_MESSAGE("Testing concurrent sweeps of one European Option Portfolio tape...");
+
+    size_t n = testPortfolioSize;
+    GreekTestData test;
+    test.setPseudorandomData(n);
+
+    // Stock prices and volatilities of all options are independent variables.
+    std::vector<double> x;
+    std::unique_ptr<cl::tape_function<double>> tape = test.recordMarketTape(x);
+    cl::tape_function<double>& f = *tape;
+
+    // Every thread sweeps the same tape for its own market scenarios.
+    size_t numThreads = 4;
+    size_t numScenarios = 3;
+    std::vector<std::vector<double> > scenarios(numThreads * numScenarios, x);
+    for (size_t k = 0; k < scenarios.size(); k++)
+    {
+        for (size_t j = 0; j < 2 * n; j++)
+        {
+            scenarios[k][j] *= 1.0 + 0.01 * k;
+        }
+    }
+
+    std::vector<std::unique_ptr<cl::tape_context<double> > > contexts;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        contexts.push_back(std::unique_ptr<cl::tape_context<double> >(new cl::tape_context<double>(f)));
+    }
+
+    std::vector<double> w(1, 1);
+    std::vector<std::vector<double> > prices(scenarios.size());
+    std::vector<std::vector<double> > sensitivities(scenarios.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            for (size_t s = 0; s < numScenarios; s++)
+            {
+                size_t k = t * numScenarios + s;
+                cl::evaluate(*contexts[t], scenarios[k], w, prices[k], sensitivities[k]);
+            }
+        }));
+    }
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads[t].join();
+    }
+
+    // Serial sweeps of the function itself.
+    bool ok = true;
+    for (size_t k = 0; k < scenarios.size(); k++)
+    {
+        std::vector<double> price = f.Forward(0, scenarios[k]);
+        std::vector<double> sensitivity = f.Reverse(1, w);
+
+        if (std::abs(prices[k][0] - price[0]) > 1e-12 * std::abs(price[0]))
+        {
+            BOOST_ERROR("\nConcurrent sweep price mismatch:"
+                << "\n    scenario:         " << k
+                << "\n    context price:    " << prices[k][0]
+                << "\n    function price:   " << price[0]);
+            ok = false;
+        }
+        for (size_t j = 0; j < 2 * n; j++)
+        {
+            if (std::abs(sensitivities[k][j] - sensitivity[j]) > 1e-10 * std::max(1.0, std::abs(sensitivity[j])))
+            {
+                BOOST_ERROR("\nConcurrent sweep sensitivity mismatch:"
+                    << "\n    scenario:   " << k
+                    << "\n    index:      " << j
+                    << "\n    context:    " << sensitivities[k][j]
+                    << "\n    function:   " << sensitivity[j]);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+
+bool AdjointEuropeanOptionPortfolioTest::testParallelCallPortfolio()
+{
+    BOOST_TEST_MESSAGE("Testing European Option Portfolio recorded in parallel shards...");
+
+    size_t n = testPortfolioSize;
+    GreekTestData test;
+    test.setPseudorandomData(n);
+
+    // Stock prices and volatilities of all options are the market inputs.
+    std::vector<double> x(2 * n);
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = CppAD::Value(test.data_[stock][i].value());
+        x[n + i] = CppAD::Value(test.data_[sigma][i].value());
+    }
+
+    // Every shard of options is recorded on its own tape by one of the threads.
+    auto pricer = [&test, n](std::vector<cl::tape_double> const& X, size_t i)
+    {
+        std::vector<Real> optionData = test.optionData(i);
+        optionData[stock] = X[i];
+        optionData[sigma] = X[n + i];
+        return getBC(optionData).value();
+    };
+    cl::portfolio_risk<double> risk = cl::parallel_portfolio_risk(x, n, pricer
+        , cl::parallel_options(std::max<size_t>(n / 8, 1), 4));
+
+    // Serial recording of the whole portfolio on one tape.
+    std::unique_ptr<cl::tape_function<double>> tape = test.recordMarketTape(x);
+    cl::tape_function<double>& f = *tape;
+
+    std::vector<double> price = f.Forward(0, x);
+    std::vector<double> sensitivities = f.Reverse(1, std::vector<double>(1, 1));
+
+    bool ok = true;
+    if (std::abs(risk.value_ - price[0]) > 1e-12 * std::abs(price[0]))
+    {
+        BOOST_ERROR("\nParallel recording price mismatch:"
+            << "\n    parallel price:  " << risk.value_
+            << "\n    serial price:    " << price[0]);
+        ok = false;
+    }
+    for (size_t j = 0; j < 2 * n; j++)
+    {
+        if (std::abs(risk.gradient_[j] - sensitivities[j]) > 1e-10 * std::max(1.0, std::abs(sensitivities[j])))
+        {
+            BOOST_ERROR("\nParallel recording sensitivity mismatch:"
+                << "\n    index:     " << j
+                << "\n    parallel:  " << risk.gradient_[j]
+                << "\n    serial:    " << sensitivities[j]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+
+bool AdjointEuropeanOptionPortfolioTest::testStatisticsCallPortfolio()
+{
+    BOOST_TEST_MESSAGE("Testing operation counts and tags of European Option Portfolio tape...");
+
+    size_t n = testPortfolioSize;
+    GreekTestData test;
+    test.setPseudorandomData(n);
+
+    // Tape recording with tags, every BlackCalculator marks its operations.
+    cl::tape_tag::enable(true);
+    cl::Independent(test.data_[stock]);
+    test.calculatePrices();
+    cl::tape_function<double> f(test.data_[stock], test.totalPrice_);
+    cl::tape_tag::enable(false);
+
+    cl::tape_statistics stats = f.statistics();
+
+    bool ok = true;
+    size_t totalOps = 0;
+    for (size_t op = 0; op < stats.op_count_.size(); op++)
+    {
+        totalOps += stats.op_count_[op];
+    }
+    if (totalOps != stats.num_op_ || stats.num_op_ != f.size_op())
+    {
+        BOOST_ERROR("\nOperation counts do not add up:"
+            << "\n    sum of counts:  " << totalOps
+            << "\n    operations:     " << stats.num_op_
+            << "\n    tape size:      " << f.size_op());
+        ok = false;
+    }
+
+    // Tag marks are PriOp operations, everything else is attributed to a tag.
+    size_t attributedOps = 0;
+    for (auto const& tag : stats.tags_)
+    {
+        attributedOps += tag.second.num_op_;
+    }
+    if (attributedOps + stats.op_count_[CppAD::PriOp] != stats.num_op_)
+    {
+        BOOST_ERROR("\nTag attribution does not cover the tape:"
+            << "\n    attributed:  " << attributedOps
+            << "\n    marks:       " << stats.op_count_[CppAD::PriOp]
+            << "\n    operations:  " << stats.num_op_);
+        ok = false;
+    }
+
+    std::map<std::string, cl::tape_tag_stats>::const_iterator bc = stats.tags_.find("BlackCalculator");
+    if (bc == stats.tags_.end() || bc->second.scopes_ != n || bc->second.num_op_ == 0)
+    {
+        BOOST_ERROR("\nBlackCalculator tag is missing or has wrong number of scopes:"
+            << "\n    scopes:    " << (bc == stats.tags_.end() ? 0 : bc->second.scopes_)
+            << "\n    expected:  " << n);
+        ok = false;
+    }
+
+    if (stats.memory_.op_arg_ == 0 || stats.memory_.taylor_ == 0 || stats.memory_.text_ == 0)
+    {
+        BOOST_ERROR("\nMemory breakdown of the tape is empty:"
+            << "\n    op_arg:  " << stats.memory_.op_arg_
+            << "\n    taylor:  " << stats.memory_.taylor_
+            << "\n    text:    " << stats.memory_.text_);
+        ok = false;
+    }
+    return ok;
+}
+
+
+bool AdjointEuropeanOptionPortfolioTest::testFusedCallPortfolio()
+{
+    BOOST_TEST_MESSAGE("Testing European Option Portfolio tape with fused operations...");
+
+    size_t n = testPortfolioSize;
+    GreekTestData test;
+    test.setPseudorandomData(n);
+
+    // Stock prices and volatilities of all options are independent variables.
+    std::vector<double> x;
+    std::unique_ptr<cl::tape_function<double>> tape = test.recordMarketTape(x);
+    cl::tape_function<double>& f = *tape;
+
+    cl::fused_tape_function<double> g(f);
+
+    bool ok = true;
+    if (g.size_node() >= f.size_op() || g.size_value() >= f.size_var())
+    {
+        BOOST_ERROR("\nFused tape is not smaller than the recorded one:"
+            << "\n    fused nodes:       " << g.size_node()
+            << "\n    tape operations:   " << f.size_op()
+            << "\n    fused values:      " << g.size_value()
+            << "\n    tape variables:    " << f.size_var());
+        ok = false;
+    }
+
+    // Prices and sensitivities at shifted inputs, away from the recorded ones.
+    for (size_t j = 0; j < 2 * n; j++)
+    {
+        x[j] *= 1.01;
+    }
+    std::vector<double> w(1, 1);
+    std::vector<double> price = f.Forward(0, x);
+    std::vector<double> sensitivities = f.Reverse(1, w);
+    std::vector<double> fusedPrice = g.forward(x);
+    std::vector<double> fusedSensitivities = g.reverse(x, w);
+
+    if (std::abs(fusedPrice[0] - price[0]) > 1e-12 * std::abs(price[0]))
+    {
+        BOOST_ERROR("\nFused tape price mismatch:"
+            << "\n    fused price:     " << fusedPrice[0]
+            << "\n    tape price:      " << price[0]);
+        ok = false;
+    }
+    for (size_t j = 0; j < 2 * n; j++)
+    {
+        if (std::abs(fusedSensitivities[j] - sensitivities[j]) > 1e-10 * std::max(1.0, std::abs(sensitivities[j])))
+        {
+            BOOST_ERROR("\nFused tape sensitivity mismatch:"
+                << "\n    index:     " << j
+                << "\n    fused:     " << fusedSensitivities[j]
+                << "\n    tape:      " << sensitivities[j]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+
 test_suite* AdjointEuropeanOptionPortfolioTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("Adjoint with European option portfolio tests");
@@ -259,6 +677,12 @@ test_suite* AdjointEuropeanOptionPortfolioTest::suite()
     suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testUltimaCallPortfolio));
     suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testZommaCallPortfolio));
     suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testColorCallPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testHessianCallPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testCompiledCallPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testConcurrentCallPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testParallelCallPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testStatisticsCallPortfolio));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointEuropeanOptionPortfolioTest::testFusedCallPortfolio));
     return suite;
 }
 
@@ -322,6 +746,35 @@ BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioColor)
 {
     BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testColorCallPortfolio());
 }
+BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioHessian)
+{
+    BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testHessianCallPortfolio());
+}
+
+BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioCompiled)
+{
+    BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testCompiledCallPortfolio());
+}
+
+BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioConcurrent)
+{
+    BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testConcurrentCallPortfolio());
+}
+
+BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioParallel)
+{
+    BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testParallelCallPortfolio());
+}
+
+BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioStatistics)
+{
+    BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testStatisticsCallPortfolio());
+}
+
+BOOST_AUTO_TEST_CASE(testEuropeanOptionPortfolioFused)
+{
+    BOOST_CHECK(AdjointEuropeanOptionPortfolioTest::testFusedCallPortfolio());
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
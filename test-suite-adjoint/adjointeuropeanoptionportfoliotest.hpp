@@ -39,6 +39,12 @@ public:
     static bool testUltimaCallPortfolio();
     static bool testZommaCallPortfolio();
     static bool testColorCallPortfolio();
+    static bool testHessianCallPortfolio();
+    static bool testCompiledCallPortfolio();
+    static bool testConcurrentCallPortfolio();
+    static bool testParallelCallPortfolio();
+    static bool testStatisticsCallPortfolio();
+    static bool testFusedCallPortfolio();
     static boost::unit_test_framework::test_suite* suite();
 };
 
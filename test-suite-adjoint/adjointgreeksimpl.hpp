@@ -26,6 +26,7 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 
 #include <ql/quantlib.hpp>
 #include <cl/tape/impl/ql/blackcalculator_t.hpp>
+#include <cl/tape/dual.hpp>
 
 #include "adjointgreekstest.hpp"
 #include "utilities.hpp"
@@ -54,11 +54,45 @@ bool AdjointGreeksTest::test()
 }
 
 
+bool AdjointGreeksTest::testDual()
+{
+    BOOST_TEST_MESSAGE("Testing Greeks calculation with forward mode dual numbers...");
+
+    size_t n = 3;
+    GreeksTestData td;
+    GreeksTest test(n, &td.outPerform_);
+
+    // One tangent direction per option parameter but the strike.
+    typedef cl::dual<double, 4> dual_type;
+
+    test.adjointResults_.resize(4 * n);
+    for (size_t i = 0; i < n; i++)
+    {
+        std::vector<dual_type> data(5);
+        data[Strike] = test.input_[i + n * Strike];
+        for (size_t k = 0; k < 4; k++)
+        {
+            data[k + 1] = dual_type(test.input_[i + n * (k + 1)], k);
+        }
+
+        // All four derivatives of the price come from one evaluation, no tape is recorded.
+        dual_type price = black_scholes_price(data);
+        for (size_t k = 0; k < 4; k++)
+        {
+            test.adjointResults_[i + n * k] = price.derivative(k);
+        }
+    }
+
+    test.calcAnalytical();
+    return test.checkAdjoint<GreeksTest::other>();
+}
+
 test_suite* AdjointGreeksTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("Adjoint greeks test (with tape compression).");
 
     suite->add(QUANTLIB_TEST_CASE(&AdjointGreeksTest::test));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointGreeksTest::testDual));
 
     return suite;
 }
@@ -73,6 +107,11 @@ BOOST_AUTO_TEST_CASE(testGreeks)
     BOOST_CHECK(AdjointGreeksTest::test());
 }
 
+BOOST_AUTO_TEST_CASE(testGreeksDual)
+{
+    BOOST_CHECK(AdjointGreeksTest::testDual());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
@@ -29,6 +29,7 @@ class AdjointGreeksTest
 {
 public:
     static bool test();
+    static bool testDual();
     static boost::unit_test_framework::test_suite* suite();
 };
 
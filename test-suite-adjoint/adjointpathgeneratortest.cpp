@@ -159,12 +159,149 @@ bool AdjointPathGeneratorTest::testSquareRootPathGenerator()
     return test.check() && testData.makeOutput();
 }
 
+namespace
+{
+    // Time step of the checkpointed path test.
+    const double checkpointDt = 1.0 / 365;
+
+    // One Euler step of the log spot, x = { spot, sigma, dw }.
+    void logEulerStep(std::vector<cl::tape_double> const& x, std::vector<cl::tape_double>& y)
+    {
+        y.resize(1);
+        y[0] = x[0] * std::exp((0.05 - 0.5 * x[1] * x[1]) * checkpointDt + x[1] * x[2]);
+    }
+}
+
+// Test path recorded with checkpointed time steps.
+bool AdjointPathGeneratorTest::testCheckpointedPath()
+{
+    BOOST_TEST_MESSAGE("Testing path generation with checkpointed steps...");
+
+    Size steps = 10000;
+    std::vector<double> dw(steps);
+    for (Size k = 0; k < steps; k++)
+        dw[k] = 0.5 * std::sin(double(k)) * std::sqrt(checkpointDt);
+
+    std::vector<double> x0 = { 100.0, 0.2 };
+
+    // Every step is recorded to the tape.
+    std::vector<cl::tape_double> X(x0.begin(), x0.end());
+    cl::Independent(X);
+    std::vector<cl::tape_double> spot = { X[0] }, next;
+    for (Size k = 0; k < steps; k++)
+    {
+        logEulerStep({ spot[0], X[1], dw[k] }, next);
+        spot.swap(next);
+    }
+    cl::tape_function<double> f(X, spot);
+    std::vector<double> dy = f.Reverse(1, std::vector<double>(1, 1.0));
+
+    // Every step is a single operation on the tape.
+    cl::tape_checkpoint<double> step("logEulerStep", logEulerStep, { x0[0], x0[1], dw[0] });
+    std::vector<cl::tape_double> XC(x0.begin(), x0.end());
+    cl::Independent(XC);
+    spot = { XC[0] };
+    for (Size k = 0; k < steps; k++)
+    {
+        step({ spot[0], XC[1], dw[k] }, next);
+        spot.swap(next);
+    }
+    cl::tape_function<double> fc(XC, spot);
+    std::vector<double> dyc = fc.Reverse(1, std::vector<double>(1, 1.0));
+
+    bool ok = true;
+    for (Size j = 0; j < x0.size(); j++)
+        ok &= std::abs(dy[j] - dyc[j]) <= 1e-10 * std::abs(dy[j]);
+
+    if (!ok)
+    {
+        BOOST_ERROR("\nCheckpointed path derivatives mismatch:"
+            << "\n    recorded steps:     " << dy[0] << " " << dy[1]
+            << "\n    checkpointed steps: " << dyc[0] << " " << dyc[1]);
+    }
+
+    if (fc.size_var() >= f.size_var())
+    {
+        BOOST_ERROR("\nCheckpointed path tape is not smaller:"
+            << "\n    recorded steps:     " << f.size_var()
+            << "\n    checkpointed steps: " << fc.size_var());
+        ok = false;
+    }
+    return ok;
+}
+
+// Test path recorded in segments spilled to disk.
+bool AdjointPathGeneratorTest::testSpilledPath()
+{
+    BOOST_TEST_MESSAGE("Testing path generation with tape segments spilled to disk...");
+
+    Size steps = 10000;
+    Size segmentSteps = 100;
+    std::vector<double> dw(steps);
+    for (Size k = 0; k < steps; k++)
+        dw[k] = 0.5 * std::sin(double(k)) * std::sqrt(checkpointDt);
+
+    std::vector<double> x0 = { 100.0, 0.2 };
+
+    // Every step is recorded to the tape.
+    std::vector<cl::tape_double> X(x0.begin(), x0.end());
+    cl::Independent(X);
+    std::vector<cl::tape_double> spot = { X[0] }, next;
+    for (Size k = 0; k < steps; k++)
+    {
+        logEulerStep({ spot[0], X[1], dw[k] }, next);
+        spot.swap(next);
+    }
+    cl::tape_function<double> f(X, spot);
+    std::vector<double> dy = f.Reverse(1, std::vector<double>(1, 1.0));
+
+    // Segments of steps, the budget holds a few of them in memory.
+    cl::tape_spill<double> tape(cl::tape_spill_options(".", 64 * 1024, 2));
+    std::vector<cl::tape_double> state(x0.begin(), x0.end());
+    for (Size k = 0; k < steps; k += segmentSteps)
+    {
+        tape.begin(state);
+        spot = { state[0] };
+        for (Size i = k; i < k + segmentSteps; i++)
+        {
+            logEulerStep({ spot[0], state[1], dw[i] }, next);
+            spot.swap(next);
+        }
+        std::vector<cl::tape_double> result = { spot[0], state[1] };
+        tape.end(state, result);
+        state.swap(result);
+    }
+    std::vector<double> dys = tape.reverse({ 1.0, 0.0 });
+
+    bool ok = true;
+    for (Size j = 0; j < x0.size(); j++)
+        ok &= std::abs(dy[j] - dys[j]) <= 1e-10 * std::abs(dy[j]);
+
+    if (!ok)
+    {
+        BOOST_ERROR("\nSpilled path derivatives mismatch:"
+            << "\n    recorded steps:     " << dy[0] << " " << dy[1]
+            << "\n    spilled segments:   " << dys[0] << " " << dys[1]);
+    }
+
+    if (tape.spilled() == 0 || tape.resident_bytes() > 64 * 1024)
+    {
+        BOOST_ERROR("\nSegments are not spilled within the memory budget:"
+            << "\n    spilled segments:   " << tape.spilled() << " of " << tape.size()
+            << "\n    resident bytes:     " << tape.resident_bytes());
+        ok = false;
+    }
+    return ok;
+}
+
 test_suite* AdjointPathGeneratorTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("Path generation tests");
     suite->add(QUANTLIB_TEST_CASE(&AdjointPathGeneratorTest::testBlackSholesPathGenerator));
     suite->add(QUANTLIB_TEST_CASE(&AdjointPathGeneratorTest::testOrnsteinUhlenbeckPathGenerator));
     suite->add(QUANTLIB_TEST_CASE(&AdjointPathGeneratorTest::testSquareRootPathGenerator));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointPathGeneratorTest::testCheckpointedPath));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointPathGeneratorTest::testSpilledPath));
     return suite;
 }
 #ifdef CL_ENABLE_BOOST_TEST_ADAPTER
@@ -183,6 +320,14 @@ BOOST_AUTO_TEST_CASE(testSquareRootPathGenerator)
 {
     BOOST_CHECK(AdjointPathGeneratorTest::testSquareRootPathGenerator());
 }
+BOOST_AUTO_TEST_CASE(testCheckpointedPath)
+{
+    BOOST_CHECK(AdjointPathGeneratorTest::testCheckpointedPath());
+}
+BOOST_AUTO_TEST_CASE(testSpilledPath)
+{
+    BOOST_CHECK(AdjointPathGeneratorTest::testSpilledPath());
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
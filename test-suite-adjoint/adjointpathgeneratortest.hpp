@@ -30,6 +30,8 @@ public:
     static bool testBlackSholesPathGenerator();
     static bool testOrnsteinUhlenbeckPathGenerator();
     static bool testSquareRootPathGenerator();
+    static bool testCheckpointedPath();
+    static bool testSpilledPath();
     static boost::unit_test_framework::test_suite* suite();
 };
 #endif
\ No newline at end of file
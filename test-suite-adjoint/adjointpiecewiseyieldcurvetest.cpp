@@ -59,11 +59,84 @@ bool AdjointPiecewiseYieldCurveTest::testJpyLibor()
     return test.check() && testData.makeOutput();
 }
 
+// By default the bootstrap records one evaluation of each pillar error at the
+// converged node, the implicit function theorem links the nodes to the quotes.
+// Compares with the recording of every solver iteration.
+bool AdjointPiecewiseYieldCurveTest::testImplicitBootstrap()
+{
+    BOOST_TEST_MESSAGE("Testing implicit function derivatives of bootstrapped curve...");
+
+    typedef PiecewiseYieldCurve<Discount, LogLinear> Curve;
+
+    SwapData data;
+    Size n = 10;
+    bool ok = true;
+
+    std::vector<double> quotes(n);
+    for (Size i = 0; i < n; i++)
+        quotes[i] = double(data.swapData_[i].rate_);
+
+    size_t sizeOp[2];
+    std::vector<double> discounts[2], gradient[2];
+    for (Size k = 0; k < 2; k++)
+    {
+        std::vector<cl::tape_double> rates(quotes.begin(), quotes.end());
+        cl::Independent(rates);
+
+        boost::shared_ptr<IborIndex> index = boost::make_shared<JPYLibor>(6 * Months);
+        std::vector<boost::shared_ptr<RateHelper> > instruments(n);
+        for (Size i = 0; i < n; i++)
+        {
+            instruments[i] = boost::make_shared<SwapRateHelper>(
+                Handle<Quote>(boost::make_shared<SimpleQuote>(rates[i])),
+                data.swapData_[i].n_ * data.swapData_[i].units_,
+                data.calendar_, data.fixedLegFrequency_, data.fixedLegConvention_,
+                data.fixedLegDayCounter_, index);
+        }
+        Curve curve(data.settlement_, instruments, Actual360(), 1.0e-12,
+                    LogLinear(), IterativeBootstrap<Curve>(k == 1));
+
+        std::vector<cl::tape_double> discount(n);
+        for (Size i = 0; i < n; i++)
+            discount[i] = curve.discount(data.settlement_ + Period(12 * i + 9, Months));
+        cl::tape_function<double> f(rates, discount);
+
+        sizeOp[k] = f.size_op();
+        discounts[k] = f.Forward(0, quotes);
+        gradient[k] = f.Reverse(1, std::vector<double>(n, 1.0));
+    }
+
+    if (sizeOp[1] >= sizeOp[0])
+    {
+        BOOST_ERROR("\nImplicit bootstrap does not reduce the tape:"
+            << "\n    operations:          " << sizeOp[0]
+            << "\n    implicit operations: " << sizeOp[1]);
+        ok = false;
+    }
+    for (Size i = 0; i < n; i++)
+    {
+        if (std::abs(discounts[1][i] - discounts[0][i]) > 1e-12
+            || std::abs(gradient[1][i] - gradient[0][i]) > 1e-6)
+        {
+            BOOST_ERROR("\nImplicit bootstrap mismatch:"
+                << "\n    pillar:              " << i
+                << "\n    discount:            " << discounts[0][i]
+                << "\n    implicit discount:   " << discounts[1][i]
+                << "\n    derivative:          " << gradient[0][i]
+                << "\n    implicit derivative: " << gradient[1][i]);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
 
 test_suite* AdjointPiecewiseYieldCurveTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("Piecewise yield curve tests");
     suite->add(QUANTLIB_TEST_CASE(&AdjointPiecewiseYieldCurveTest::testJpyLibor));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointPiecewiseYieldCurveTest::testImplicitBootstrap));
     return suite;
 }
 
@@ -76,6 +149,11 @@ BOOST_AUTO_TEST_CASE(testJpyLiborSwapNpvs)
     BOOST_CHECK(AdjointPiecewiseYieldCurveTest::testJpyLibor());
 }
 
+BOOST_AUTO_TEST_CASE(testImplicitBootstrap)
+{
+    BOOST_CHECK(AdjointPiecewiseYieldCurveTest::testImplicitBootstrap());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
\ No newline at end of file
@@ -32,6 +32,7 @@ class AdjointPiecewiseYieldCurveTest
 {
 public:
     static bool testJpyLibor();
+    static bool testImplicitBootstrap();
     static boost::unit_test_framework::test_suite* suite();
 };
 
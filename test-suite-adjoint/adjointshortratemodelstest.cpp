@@ -149,12 +149,156 @@ bool AdjointShortRateModelsTest::testFuturesConvexityBias()
     return test.check();
 }
 
+// The Hull-White calibration of testCachedHullWhite is run with the
+// Jacobian of the calibration errors supplied to Levenberg-Marquardt,
+// once by finite differences and once recorded on a tape; both must
+// converge to the same parameters.
+bool AdjointShortRateModelsTest::testTapeJacobianCalibration()
+{
+    BOOST_MESSAGE("Testing Hull-White calibration with the Jacobian recorded on a tape...");
+
+    bool ok = true;
+    std::vector<Real> params[2];
+    Real errors[2];
+    for (Size k = 0; k < 2; k++)
+    {
+        ModelData data;
+        std::vector<boost::shared_ptr<CalibrationHelper> > swaptions;
+        for (Size i = 0; i < 12; i++)
+        {
+            boost::shared_ptr<Quote> vol(new SimpleQuote(0.1148 - 0.004*i));
+            boost::shared_ptr<CalibrationHelper> helper(
+                new SwaptionHelper(Period(i + 1, Years),
+                                   Period(12 - i, Years),
+                                   Handle<Quote>(vol),
+                                   data.index_,
+                                   Period(1, Years), Thirty360(),
+                                   Actual360(), data.termStructure_));
+            helper->setPricingEngine(data.engine_);
+            swaptions.push_back(helper);
+        }
+
+        LevenbergMarquardt optimizationMethod(1.0e-8, 1.0e-8, 1.0e-8, true);
+        EndCriteria endCriteria(1000, 100, 1e-6, 1e-8, 1e-8);
+        data.model_->calibrate(swaptions, optimizationMethod, endCriteria,
+                               Constraint(), std::vector<Real>(),
+                               std::vector<bool>(), k == 1);
+
+        Array p = data.model_->params();
+        params[k].assign(p.begin(), p.end());
+        errors[k] = data.model_->value(p, swaptions);
+    }
+
+    for (Size i = 0; i < params[0].size(); i++)
+    {
+        if (std::fabs(params[1][i] - params[0][i]) > 1e-5 * std::fabs(params[0][i]))
+        {
+            ok = false;
+            BOOST_ERROR("\nCalibrated parameter " << i << " differs:"
+                        << "\n    finite differences: " << double(params[0][i])
+                        << "\n    tape Jacobian:      " << double(params[1][i]));
+        }
+    }
+    if (std::fabs(errors[1] - errors[0]) > 1e-8)
+    {
+        ok = false;
+        BOOST_ERROR("\nCalibration errors differ:"
+                    << "\n    finite differences: " << double(errors[0])
+                    << "\n    tape Jacobian:      " << double(errors[1]));
+    }
+
+    Settings::instance().resetEvaluationDate();
+
+    return ok;
+}
+
+// The Hull-White model is calibrated to the swaptions of testCachedHullWhite
+// and a swaption outside of the calibration set is priced with it. Its
+// sensitivities to the calibration vols through the calibrated parameters,
+// from the optimality conditions of the calibration, are compared with
+// finite differences which recalibrate the model for each bumped vol.
+bool AdjointShortRateModelsTest::testCalibrationAdjoint()
+{
+    BOOST_MESSAGE("Testing Hull-White calibration adjoint against recalibration...");
+
+    bool ok = true;
+    ModelData data;
+    Size n = 12;
+    std::vector<boost::shared_ptr<SimpleQuote> > vols;
+    std::vector<boost::shared_ptr<CalibrationHelper> > swaptions;
+    for (Size i = 0; i < n; i++)
+    {
+        vols.push_back(boost::shared_ptr<SimpleQuote>(
+            new SimpleQuote(0.1148 - 0.004*i + 0.002*(i % 3))));
+        boost::shared_ptr<CalibrationHelper> helper(
+            new SwaptionHelper(Period(i + 1, Years),
+                               Period(n - i, Years),
+                               Handle<Quote>(vols.back()),
+                               data.index_,
+                               Period(1, Years), Thirty360(),
+                               Actual360(), data.termStructure_));
+        helper->setPricingEngine(data.engine_);
+        swaptions.push_back(helper);
+    }
+
+    SwaptionHelper exotic(Period(3, Years), Period(7, Years),
+                          Handle<Quote>(boost::shared_ptr<Quote>(new SimpleQuote(0.1))),
+                          data.index_, Period(1, Years), Thirty360(),
+                          Actual360(), data.termStructure_);
+    exotic.setPricingEngine(data.engine_);
+
+    LevenbergMarquardt optimizationMethod(1.0e-12, 1.0e-12, 1.0e-12, true);
+    EndCriteria endCriteria(10000, 1000, 1e-12, 1e-12, 1e-12);
+    data.model_->calibrate(swaptions, optimizationMethod, endCriteria,
+                           Constraint(), std::vector<Real>(),
+                           std::vector<bool>(), true);
+
+    CalibrationAdjoint adjoint(data.model_, swaptions);
+    Array vega = adjoint.quoteSensitivities(*exotic.swaption());
+
+    // The recalibrations use the tape Jacobian too and converge to about 1e-7
+    // in the parameters. At this bump the noise of the recalibrations and the
+    // truncation error of the central differences are each below 1e-3 of the
+    // vega, smaller bumps amplify the noise and larger ones the truncation.
+    double h = 1.0e-3;
+    for (Size i = 0; i < n; i++)
+    {
+        Real vol = vols[i]->value();
+        vols[i]->setValue(vol + h);
+        data.model_->calibrate(swaptions, optimizationMethod, endCriteria,
+                               Constraint(), std::vector<Real>(),
+                               std::vector<bool>(), true);
+        Real up = exotic.swaption()->NPV();
+        vols[i]->setValue(vol - h);
+        data.model_->calibrate(swaptions, optimizationMethod, endCriteria,
+                               Constraint(), std::vector<Real>(),
+                               std::vector<bool>(), true);
+        Real down = exotic.swaption()->NPV();
+        vols[i]->setValue(vol);
+
+        Real fd = (up - down) / (2 * h);
+        if (std::fabs(vega[i] - fd) > 3e-3 * std::fabs(fd) + 1e-6)
+        {
+            ok = false;
+            BOOST_ERROR("\nVega to calibration swaption " << i << " differs:"
+                        << "\n    calibration adjoint: " << double(vega[i])
+                        << "\n    recalibration:       " << double(fd));
+        }
+    }
+
+    Settings::instance().resetEvaluationDate();
+
+    return ok;
+}
+
 test_suite*  AdjointShortRateModelsTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("CppAD Hull-White model calibration  tests");
     suite->add(QUANTLIB_TEST_CASE(&AdjointShortRateModelsTest::testCachedHullWhite));
     suite->add(QUANTLIB_TEST_CASE(&AdjointShortRateModelsTest::testCachedHullWhiteFixedReversion));
     suite->add(QUANTLIB_TEST_CASE(&AdjointShortRateModelsTest::testFuturesConvexityBias));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointShortRateModelsTest::testTapeJacobianCalibration));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointShortRateModelsTest::testCalibrationAdjoint));
     return suite;
 }
 
@@ -177,6 +321,16 @@ BOOST_AUTO_TEST_CASE(testFuturesConvexityBias)
     BOOST_CHECK(AdjointShortRateModelsTest::testFuturesConvexityBias());
 }
 
+BOOST_AUTO_TEST_CASE(testTapeJacobianCalibration)
+{
+    BOOST_CHECK(AdjointShortRateModelsTest::testTapeJacobianCalibration());
+}
+
+BOOST_AUTO_TEST_CASE(testCalibrationAdjoint)
+{
+    BOOST_CHECK(AdjointShortRateModelsTest::testCalibrationAdjoint());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
\ No newline at end of file
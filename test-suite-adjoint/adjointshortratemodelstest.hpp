@@ -32,6 +32,8 @@ public:
     static bool testCachedHullWhite();
     static bool testCachedHullWhiteFixedReversion();
     static bool testFuturesConvexityBias();
+    static bool testTapeJacobianCalibration();
+    static bool testCalibrationAdjoint();
     static boost::unit_test_framework::test_suite* suite();
 };
 
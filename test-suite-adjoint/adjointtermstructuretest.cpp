@@ -143,12 +143,62 @@ bool AdjointTermStructureTest::testImplied()
     return test.checkAdjoint() && testData.makeOutput();
 }
 
+// Method testOptimize()
+// Testing optimization of the zero-spreaded term structure tape.
+// The tape recorded in testZSpreaded() is optimized, derivatives computed
+// on the optimized tape must coincide with the ones computed before.
+// Method returns true if the optimized tape is not larger than the recorded one
+// and derivatives are unchanged; otherwise, it returns false.
+bool AdjointTermStructureTest::testOptimize()
+{
+    BOOST_TEST_MESSAGE("Testing optimization of zero-spreaded term structure tape...");
+
+    ZSpreadedTestData testData;
+    size_t n = 30;
+    ZSpreadedTest test(n, &testData);
+
+    // Tape recording.
+    cl::Independent(test.rate_);
+    test.calculateZeroValue();
+    cl::tape_function<double> f(test.rate_, test.zeroValue_);
+
+    std::vector<double> dw(1, 1);
+    std::vector<double> recorded = f.Reverse(1, dw);
+
+    // Tape optimization.
+    cl::tape_optimize_stats stats = f.optimize();
+    BOOST_TEST_MESSAGE("    " << stats);
+
+    bool ok = true;
+    if (stats.after_.num_op_ > stats.before_.num_op_)
+    {
+        ok = false;
+        BOOST_ERROR("\nOptimized tape is larger than recorded one: " << stats);
+    }
+
+    std::vector<double> optimized = f.Reverse(1, dw);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (std::abs(optimized[i] - recorded[i]) > 1e-10)
+        {
+            ok = false;
+            BOOST_ERROR("\nDerivative changed by optimization:"
+                << "\n    rate index: " << i
+                << "\n    recorded:   " << recorded[i]
+                << "\n    optimized:  " << optimized[i]);
+        }
+    }
+
+    return ok;
+}
+
 test_suite* AdjointTermStructureTest::suite()
 {
     test_suite* suite = BOOST_TEST_SUITE("Term structure tests");
     suite->add(QUANTLIB_TEST_CASE(&AdjointTermStructureTest::testZSpreaded));
     suite->add(QUANTLIB_TEST_CASE(&AdjointTermStructureTest::testFSpreaded));
     suite->add(QUANTLIB_TEST_CASE(&AdjointTermStructureTest::testImplied));
+    suite->add(QUANTLIB_TEST_CASE(&AdjointTermStructureTest::testOptimize));
 
     return suite;
 }
@@ -171,6 +221,11 @@ BOOST_AUTO_TEST_CASE(testConsistencyYieldTermStructure)
 {
     BOOST_CHECK(AdjointTermStructureTest::testImplied());
 }
+
+BOOST_AUTO_TEST_CASE(testOptimizedYieldTermStructureTape)
+{
+    BOOST_CHECK(AdjointTermStructureTest::testOptimize());
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
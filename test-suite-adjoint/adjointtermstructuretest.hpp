@@ -30,6 +30,7 @@ public:
     static bool testImplied();
     static bool testFSpreaded();
     static bool testZSpreaded();
+    static bool testOptimize();
 
     static boost::unit_test_framework::test_suite* suite();
 };